@@ -16,6 +16,7 @@
 #include "AclProcess.h"
 #include <sys/time.h>
 #include <thread>
+#include "Statistic/Statistic.h"
 
 /*
  * @description: Constructor
@@ -162,19 +163,15 @@ APP_ERROR AclProcess::Preprocess(std::string imageFile)
  */
 APP_ERROR AclProcess::Process(std::string imageFile)
 {
-    struct timeval begin = {0};
-    struct timeval end = {0};
-    gettimeofday(&begin, nullptr);
+    uint64_t beginTicks = ProbeClock::Now();
     // deal with image
     APP_ERROR ret = Preprocess(imageFile);
     if (ret != APP_ERR_OK) {
         LogError << "Failed to preprocess, ret = " << ret;
         return ret;
     }
-    gettimeofday(&end, nullptr);
     // Calculate the time cost of preprocess
-    const double costMs = SEC2MS * (end.tv_sec - begin.tv_sec) + \
-        (end.tv_usec - begin.tv_usec) / SEC2MS;
+    const double costMs = ProbeClock::ToMs(ProbeClock::Now() - beginTicks);
     const double fps = 1 * SEC2MS / costMs;
     LogInfo << "[dvpp Delay] cost: " << costMs << "ms\tfps: " << fps;
     // Get output of resize module
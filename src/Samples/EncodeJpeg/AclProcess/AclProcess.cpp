@@ -14,7 +14,7 @@
  */
 
 #include "AclProcess.h"
-#include <sys/time.h>
+#include "Statistic/Statistic.h"
 
 /*
  * @description: Implementation of constructor for class AclProcess with parameter list
@@ -93,9 +93,7 @@ APP_ERROR AclProcess::InitResource()
  */
 APP_ERROR AclProcess::Process(std::string imageFile, int width, int height, acldvppPixelFormat format)
 {
-    struct timeval begin = {0};
-    struct timeval end = {0};
-    gettimeofday(&begin, nullptr);
+    uint64_t beginTicks = ProbeClock::Now();
 
     bool withSynchronize = true;
     RawData imageInfo;
@@ -137,9 +135,8 @@ APP_ERROR AclProcess::Process(std::string imageFile, int width, int height, acld
         return ret;
     }
 
-    gettimeofday(&end, nullptr);
     // Calculate the time cost of encode jpeg
-    const double costMs = SEC2MS * (end.tv_sec - begin.tv_sec) + (end.tv_usec - begin.tv_usec) / SEC2MS;
+    const double costMs = ProbeClock::ToMs(ProbeClock::Now() - beginTicks);
     const double fps = 1 * SEC2MS / costMs;
     LogInfo << "[dvpp Delay] cost: " << costMs << "ms\tfps: " << fps;
     return APP_ERR_OK;
@@ -0,0 +1,285 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include "CommandParser/CommandParser.h"
+#include "ConfigParser/ConfigParser.h"
+#include "Log/Log.h"
+#include "ModuleManager/ModuleManager.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const int MODE_WIDTH = 12;
+const int VALUE_WIDTH = 16;
+const int WAIT_INTERVAL_MS = 10;
+const std::string BENCH_CONFIG = "./executor_bench.config";
+
+std::atomic<uint64_t> g_receivedFrames(0);
+std::atomic<uint64_t> g_reorderedFrames(0);
+
+struct BenchFrame {
+    uint32_t channelId;
+    uint32_t frameId;
+};
+
+// burn the cpu like a stage doing real work
+void BusyWork(uint32_t workUs)
+{
+    auto endTime = Clock::now() + std::chrono::microseconds(workUs);
+    while (Clock::now() < endTime) {
+    }
+}
+}
+
+// stand-in of StreamPuller, one instance per channel sends frameNum frames as fast as the pipeline accepts them
+class BenchSource : public ascendBaseModule::ModuleBase {
+public:
+    APP_ERROR Init(ConfigParser &configParser, ascendBaseModule::ModuleInitArgs &initArgs)
+    {
+        AssignInitArgs(initArgs);
+        withoutInputQueue_ = true;
+        return configParser.GetUnsignedIntValue("BenchSource.frameNum", frameNum_);
+    }
+
+    APP_ERROR DeInit(void)
+    {
+        return APP_ERR_OK;
+    }
+
+protected:
+    APP_ERROR Process(std::shared_ptr<void> inputData);
+
+private:
+    uint32_t frameNum_ = 0;
+};
+
+// stand-in of the stages of InferOfflineVideo, every frame costs workUs of cpu
+class BenchStage : public ascendBaseModule::ModuleBase {
+public:
+    APP_ERROR Init(ConfigParser &configParser, ascendBaseModule::ModuleInitArgs &initArgs)
+    {
+        AssignInitArgs(initArgs);
+        configParser.GetStringValue(moduleName_ + ".next", nextModule_);
+        return configParser.GetUnsignedIntValue("BenchStage.workUs", workUs_);
+    }
+
+    APP_ERROR DeInit(void)
+    {
+        return APP_ERR_OK;
+    }
+
+protected:
+    APP_ERROR Process(std::shared_ptr<void> inputData)
+    {
+        BusyWork(workUs_);
+        // every instance must see the frames of its channel in the order they were sent
+        std::shared_ptr<BenchFrame> frame = std::static_pointer_cast<BenchFrame>(inputData);
+        if (frame->frameId != nextFrameId_) {
+            g_reorderedFrames++;
+        }
+        nextFrameId_ = frame->frameId + 1;
+        if (nextModule_.empty()) {
+            g_receivedFrames++;
+            return APP_ERR_OK;
+        }
+        uint32_t channelId = frame->channelId;
+        SendToNextModule(nextModule_, std::move(inputData), channelId);
+        return APP_ERR_OK;
+    }
+
+private:
+    uint32_t workUs_ = 0;
+    uint32_t nextFrameId_ = 0;
+    std::string nextModule_ = "";
+};
+
+class BenchDecoder : public BenchStage {};
+class BenchInfer : public BenchStage {};
+class BenchPost : public BenchStage {};
+
+MODULE_REGIST(BenchSource)
+MODULE_REGIST(BenchDecoder)
+MODULE_REGIST(BenchInfer)
+MODULE_REGIST(BenchPost)
+
+APP_ERROR BenchSource::Process(std::shared_ptr<void> /* inputData */)
+{
+    for (uint32_t i = 0; i < frameNum_ && !isStop_; i++) {
+        std::shared_ptr<BenchFrame> frame = std::make_shared<BenchFrame>();
+        frame->channelId = instanceId_;
+        frame->frameId = i;
+        SendToNextModule(ascendBaseModule::MT_BenchDecoder, std::move(frame), instanceId_);
+    }
+    return APP_ERR_OK;
+}
+
+namespace {
+using namespace ascendBaseModule;
+
+const int MODULE_TYPE_COUNT = 4;
+const int MODULE_CONNECT_COUNT = 3;
+
+ModuleDesc g_moduleDesc[MODULE_TYPE_COUNT] = {
+    {MT_BenchSource, -1},
+    {MT_BenchDecoder, -1},
+    {MT_BenchInfer, -1},
+    {MT_BenchPost, -1},
+};
+
+ModuleConnectDesc g_connectDesc[MODULE_CONNECT_COUNT] = {
+    {MT_BenchSource, MT_BenchDecoder, MODULE_CONNECT_CHANNEL, MODULE_QUEUE_SPSC, MODULE_OVERLOAD_BLOCK, 0,
+        QUEUE_WAIT_DEFAULT, false},
+    {MT_BenchDecoder, MT_BenchInfer, MODULE_CONNECT_CHANNEL, MODULE_QUEUE_SPSC, MODULE_OVERLOAD_BLOCK, 0,
+        QUEUE_WAIT_DEFAULT, false},
+    {MT_BenchInfer, MT_BenchPost, MODULE_CONNECT_CHANNEL, MODULE_QUEUE_SPSC, MODULE_OVERLOAD_BLOCK, 0,
+        QUEUE_WAIT_DEFAULT, false},
+};
+
+struct BenchResult {
+    double fps;
+    long voluntarySwitches;
+    long involuntarySwitches;
+    int threadNum;
+    uint64_t reorderedFrames;
+};
+
+int GetThreadNum()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, strlen("Threads:"), "Threads:") == 0) {
+            return std::stoi(line.substr(strlen("Threads:")));
+        }
+    }
+    return 0;
+}
+
+void WriteConfig(uint32_t channelCount, bool executorMode, uint32_t threadNum, uint32_t frameNum, uint32_t workUs)
+{
+    // NewConfig appends to an existing file
+    std::remove(BENCH_CONFIG.c_str());
+    ConfigParser config;
+    config.NewConfig(BENCH_CONFIG);
+    config.WriteUint32("SystemConfig.channelCount", channelCount);
+    config.WriteString("SystemConfig.executorMode", executorMode ? "true" : "false");
+    config.WriteUint32("SystemConfig.executorThreadNum", threadNum);
+    config.WriteUint32("BenchSource.frameNum", frameNum);
+    config.WriteUint32("BenchStage.workUs", workUs);
+    config.WriteString("BenchDecoder.next", MT_BenchInfer);
+    config.WriteString("BenchInfer.next", MT_BenchPost);
+    config.SaveConfig();
+}
+
+APP_ERROR RunPipeline(uint32_t channelCount, uint32_t frameNum, BenchResult &result)
+{
+    std::string configPath = BENCH_CONFIG;
+    std::string aclConfigPath = "";
+    ModuleManager moduleManager;
+    APP_ERROR ret = moduleManager.Init(configPath, aclConfigPath);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    ret = moduleManager.RegisterModules(PIPELINE_DEFAULT, g_moduleDesc, MODULE_TYPE_COUNT, channelCount);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    ret = moduleManager.RegisterModuleConnects(PIPELINE_DEFAULT, g_connectDesc, MODULE_CONNECT_COUNT);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+
+    g_receivedFrames = 0;
+    g_reorderedFrames = 0;
+    uint64_t totalFrames = static_cast<uint64_t>(channelCount) * frameNum;
+    struct rusage startUsage = {};
+    getrusage(RUSAGE_SELF, &startUsage);
+    auto startTime = Clock::now();
+    ret = moduleManager.RunPipeline();
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    result.threadNum = GetThreadNum();
+    while (g_receivedFrames < totalFrames) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_INTERVAL_MS));
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    struct rusage endUsage = {};
+    getrusage(RUSAGE_SELF, &endUsage);
+
+    result.fps = totalFrames / seconds;
+    result.voluntarySwitches = endUsage.ru_nvcsw - startUsage.ru_nvcsw;
+    result.involuntarySwitches = endUsage.ru_nivcsw - startUsage.ru_nivcsw;
+    result.reorderedFrames = g_reorderedFrames;
+    return moduleManager.DeInit();
+}
+}
+
+int main(int argc, const char *argv[])
+{
+    CommandParser option;
+    option.AddOption("-channels", "8,32,64", "channel counts to run, separated by commas");
+    option.AddOption("-frames", "2000", "number of frames sent by every channel");
+    option.AddOption("-work_us", "50", "cpu time spent by every stage on one frame");
+    option.AddOption("-threads", "0", "number of executor workers, 0 means one per core");
+    option.ParseArgs(argc, argv);
+
+    uint32_t frameNum = option.GetUint32Option("-frames");
+    uint32_t workUs = option.GetUint32Option("-work_us");
+    uint32_t threadNum = option.GetUint32Option("-threads");
+    std::vector<uint32_t> channelCounts;
+    std::stringstream channels(option.GetStringOption("-channels"));
+    std::string item;
+    while (std::getline(channels, item, ',')) {
+        channelCounts.push_back(std::stoul(item));
+    }
+
+    AtlasAscendLog::Log::LogErrorOn();
+    std::cout << std::left << std::setw(VALUE_WIDTH) << "channels" << std::setw(MODE_WIDTH) << "mode"
+              << std::setw(VALUE_WIDTH) << "threads" << std::setw(VALUE_WIDTH) << "fps" << std::setw(VALUE_WIDTH)
+              << "voluntary cs" << std::setw(VALUE_WIDTH) << "involuntary cs" << std::setw(VALUE_WIDTH)
+              << "reordered" << std::endl;
+    for (auto channelCount : channelCounts) {
+        for (int executorMode = 0; executorMode <= 1; executorMode++) {
+            WriteConfig(channelCount, executorMode == 1, threadNum, frameNum, workUs);
+            BenchResult result = {};
+            APP_ERROR ret = RunPipeline(channelCount, frameNum, result);
+            if (ret != APP_ERR_OK) {
+                std::cout << "Fail to run the pipeline, ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ")."
+                          << std::endl;
+                return ret;
+            }
+            std::cout << std::left << std::setw(VALUE_WIDTH) << channelCount << std::setw(MODE_WIDTH)
+                      << (executorMode == 1 ? "executor" : "thread") << std::setw(VALUE_WIDTH) << result.threadNum
+                      << std::setw(VALUE_WIDTH) << static_cast<uint64_t>(result.fps) << std::setw(VALUE_WIDTH)
+                      << result.voluntarySwitches << std::setw(VALUE_WIDTH) << result.involuntarySwitches
+                      << std::setw(VALUE_WIDTH) << result.reorderedFrames << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,280 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CommandParser/CommandParser.h"
+#include "ConfigParser/ConfigParser.h"
+#include "Log/Log.h"
+#include "ModuleManager/ModuleManager.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const int NAME_WIDTH = 28;
+const int VALUE_WIDTH = 16;
+const int WAIT_INTERVAL_MS = 10;
+const double MS_PER_SECOND = 1000.0;
+const std::string BENCH_CONFIG = "./fanout_bench.config";
+
+std::atomic<uint64_t> g_receivedFrames(0);
+std::atomic<uint64_t> g_reorderedFrames(0);
+std::atomic<uint64_t> g_totalLatencyUs(0);
+
+struct FanoutFrame {
+    uint32_t channelId;
+    uint32_t frameId;
+    Clock::time_point sendTime;
+};
+}
+
+// stand-in of VideoDecoder, sends the frames of all the channels one after another as fast as they are accepted
+class FanoutSource : public ascendBaseModule::ModuleBase {
+public:
+    APP_ERROR Init(ConfigParser &configParser, ascendBaseModule::ModuleInitArgs &initArgs)
+    {
+        AssignInitArgs(initArgs);
+        withoutInputQueue_ = true;
+        configParser.GetUnsignedIntValue("FanoutSource.channelCount", channelCount_);
+        return configParser.GetUnsignedIntValue("FanoutSource.frameNum", frameNum_);
+    }
+
+    APP_ERROR DeInit(void)
+    {
+        return APP_ERR_OK;
+    }
+
+protected:
+    APP_ERROR Process(std::shared_ptr<void> inputData);
+
+private:
+    uint32_t frameNum_ = 0;
+    uint32_t channelCount_ = 1;
+};
+
+// stand-in of ModelInfer waiting for the device, instance 0 is slowFactor times slower than the others
+class FanoutWorker : public ascendBaseModule::ModuleBase {
+public:
+    APP_ERROR Init(ConfigParser &configParser, ascendBaseModule::ModuleInitArgs &initArgs)
+    {
+        AssignInitArgs(initArgs);
+        uint32_t slowFactor = 1;
+        configParser.GetUnsignedIntValue("FanoutWorker.slowFactor", slowFactor);
+        APP_ERROR ret = configParser.GetUnsignedIntValue("FanoutWorker.workUs", workUs_);
+        if (instanceId_ == 0) {
+            workUs_ *= slowFactor;
+        }
+        return ret;
+    }
+
+    APP_ERROR DeInit(void)
+    {
+        return APP_ERR_OK;
+    }
+
+protected:
+    APP_ERROR Process(std::shared_ptr<void> inputData);
+
+private:
+    uint32_t workUs_ = 0;
+};
+
+// stand-in of PostProcess, checks the order of every channel
+class FanoutSink : public ascendBaseModule::ModuleBase {
+public:
+    APP_ERROR Init(ConfigParser &/* configParser */, ascendBaseModule::ModuleInitArgs &initArgs)
+    {
+        AssignInitArgs(initArgs);
+        return APP_ERR_OK;
+    }
+
+    APP_ERROR DeInit(void)
+    {
+        return APP_ERR_OK;
+    }
+
+protected:
+    APP_ERROR Process(std::shared_ptr<void> inputData)
+    {
+        std::shared_ptr<FanoutFrame> frame = std::static_pointer_cast<FanoutFrame>(inputData);
+        uint32_t &nextFrameId = nextFrameIds_[frame->channelId];
+        if (frame->frameId != nextFrameId) {
+            g_reorderedFrames++;
+        }
+        nextFrameId = frame->frameId + 1;
+        g_totalLatencyUs +=
+            std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - frame->sendTime).count();
+        g_receivedFrames++;
+        return APP_ERR_OK;
+    }
+
+private:
+    std::map<uint32_t, uint32_t> nextFrameIds_ = {};
+};
+
+MODULE_REGIST(FanoutSource)
+MODULE_REGIST(FanoutWorker)
+MODULE_REGIST(FanoutSink)
+
+APP_ERROR FanoutSource::Process(std::shared_ptr<void> /* inputData */)
+{
+    for (uint32_t i = 0; i < frameNum_ && !isStop_; i++) {
+        std::shared_ptr<FanoutFrame> frame = std::make_shared<FanoutFrame>();
+        frame->channelId = i % channelCount_;
+        frame->frameId = i / channelCount_;
+        frame->sendTime = Clock::now();
+        uint32_t channelId = frame->channelId;
+        SendToNextModule(ascendBaseModule::MT_FanoutWorker, std::move(frame), channelId);
+    }
+    return APP_ERR_OK;
+}
+
+APP_ERROR FanoutWorker::Process(std::shared_ptr<void> inputData)
+{
+    std::this_thread::sleep_for(std::chrono::microseconds(workUs_));
+    uint32_t channelId = std::static_pointer_cast<FanoutFrame>(inputData)->channelId;
+    SendToNextModule(ascendBaseModule::MT_FanoutSink, std::move(inputData), channelId);
+    return APP_ERR_OK;
+}
+
+namespace {
+using namespace ascendBaseModule;
+
+const int MODULE_TYPE_COUNT = 3;
+const int MODULE_CONNECT_COUNT = 2;
+
+struct FanoutCase {
+    std::string name;
+    ModuleConnectType connectType;
+};
+
+const std::vector<FanoutCase> FANOUT_CASES = {
+    {"RANDOM (round-robin)", MODULE_CONNECT_RANDOM},
+    {"LEAST_LOADED", MODULE_CONNECT_LEAST_LOADED},
+    {"POWER_OF_TWO", MODULE_CONNECT_POWER_OF_TWO},
+    {"LEAST_LOADED_ORDERED", MODULE_CONNECT_LEAST_LOADED_ORDERED},
+};
+
+struct BenchResult {
+    double fps;
+    double latencyMs;
+    uint64_t reorderedFrames;
+};
+
+void WriteConfig(uint32_t channelCount, uint32_t frameNum, uint32_t workUs, uint32_t slowFactor)
+{
+    // NewConfig appends to an existing file
+    std::remove(BENCH_CONFIG.c_str());
+    ConfigParser config;
+    config.NewConfig(BENCH_CONFIG);
+    config.WriteUint32("FanoutSource.channelCount", channelCount);
+    config.WriteUint32("FanoutSource.frameNum", frameNum);
+    config.WriteUint32("FanoutWorker.workUs", workUs);
+    config.WriteUint32("FanoutWorker.slowFactor", slowFactor);
+    config.SaveConfig();
+}
+
+APP_ERROR RunPipeline(ModuleConnectType connectType, uint32_t workerNum, uint32_t capacity, uint32_t frameNum,
+    BenchResult &result)
+{
+    std::string configPath = BENCH_CONFIG;
+    std::string aclConfigPath = "";
+    ModuleManager moduleManager;
+    APP_ERROR ret = moduleManager.Init(configPath, aclConfigPath);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    ModuleDesc moduleDesc[MODULE_TYPE_COUNT] = {
+        {MT_FanoutSource, 1},
+        {MT_FanoutWorker, static_cast<int>(workerNum)},
+        {MT_FanoutSink, 1},
+    };
+    ModuleConnectDesc connectDesc[MODULE_CONNECT_COUNT] = {
+        {MT_FanoutSource, MT_FanoutWorker, connectType, MODULE_QUEUE_SPSC, MODULE_OVERLOAD_BLOCK, capacity,
+            QUEUE_WAIT_DEFAULT, false},
+        {MT_FanoutWorker, MT_FanoutSink, MODULE_CONNECT_ONE, MODULE_QUEUE_MPMC, MODULE_OVERLOAD_BLOCK, 0,
+            QUEUE_WAIT_DEFAULT, false},
+    };
+    ret = moduleManager.RegisterModules(PIPELINE_DEFAULT, moduleDesc, MODULE_TYPE_COUNT, 1);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    ret = moduleManager.RegisterModuleConnects(PIPELINE_DEFAULT, connectDesc, MODULE_CONNECT_COUNT);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+
+    g_receivedFrames = 0;
+    g_reorderedFrames = 0;
+    g_totalLatencyUs = 0;
+    auto startTime = Clock::now();
+    ret = moduleManager.RunPipeline();
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    while (g_receivedFrames < frameNum) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_INTERVAL_MS));
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+
+    result.fps = frameNum / seconds;
+    result.latencyMs = g_totalLatencyUs / MS_PER_SECOND / frameNum;
+    result.reorderedFrames = g_reorderedFrames;
+    return moduleManager.DeInit();
+}
+}
+
+int main(int argc, const char *argv[])
+{
+    CommandParser option;
+    option.AddOption("-frames", "4000", "number of frames sent by the source");
+    option.AddOption("-channels", "8", "number of channels the frames belong to");
+    option.AddOption("-workers", "4", "number of receiver instances");
+    option.AddOption("-work_us", "500", "time spent by a receiver instance on one frame");
+    option.AddOption("-slow_factor", "8", "receiver instance 0 spends slow_factor times work_us on one frame");
+    option.AddOption("-capacity", "0", "capacity of the input queues of the receivers, 0 means MODULE_QUEUE_SIZE");
+    option.ParseArgs(argc, argv);
+
+    uint32_t frameNum = option.GetUint32Option("-frames");
+    uint32_t channelCount = std::max(option.GetUint32Option("-channels"), 1u);
+    uint32_t workerNum = std::max(option.GetUint32Option("-workers"), 1u);
+    uint32_t capacity = option.GetUint32Option("-capacity");
+    WriteConfig(channelCount, frameNum, option.GetUint32Option("-work_us"), option.GetUint32Option("-slow_factor"));
+
+    AtlasAscendLog::Log::LogErrorOn();
+    std::cout << std::left << std::setw(NAME_WIDTH) << "connect type" << std::setw(VALUE_WIDTH) << "fps"
+              << std::setw(VALUE_WIDTH) << "latency(ms)" << std::setw(VALUE_WIDTH) << "reordered" << std::endl;
+    for (auto &fanoutCase : FANOUT_CASES) {
+        BenchResult result = {};
+        APP_ERROR ret = RunPipeline(fanoutCase.connectType, workerNum, capacity, frameNum, result);
+        if (ret != APP_ERR_OK) {
+            std::cout << "Fail to run the pipeline, ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ")." << std::endl;
+            return ret;
+        }
+        std::cout << std::fixed << std::setprecision(2) << std::setw(NAME_WIDTH) << fanoutCase.name
+                  << std::setw(VALUE_WIDTH) << result.fps << std::setw(VALUE_WIDTH) << result.latencyMs
+                  << std::setw(VALUE_WIDTH) << result.reorderedFrames << std::endl;
+    }
+    return 0;
+}
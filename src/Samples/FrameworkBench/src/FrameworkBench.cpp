@@ -0,0 +1,320 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CommandParser/CommandParser.h"
+#include "ConfigParser/ConfigParser.h"
+#include "Log/Log.h"
+#include "Metrics/Metrics.h"
+#include "ModuleManager/ModuleManager.h"
+#include "SyntheticModules/SyntheticModules.h"
+
+namespace {
+using namespace ascendBaseModule;
+using Clock = std::chrono::steady_clock;
+
+const int VALUE_WIDTH = 14;
+const int WAIT_INTERVAL_MS = 10;
+const double QUANTILE_P50 = 0.5;
+const double QUANTILE_P99 = 0.99;
+const double QUANTILE_P999 = 0.999;
+const int QUANTILE_COUNT = 3;
+const double NS_PER_US = 1000.0;
+const std::string BENCH_CONFIG = "./framework_bench.config";
+const std::string STAGE_NAME = "SyntheticStage";
+const std::vector<std::string> RECORD_COLUMNS = { "msgs_per_s", "hop_p50_us", "hop_p99_us", "hop_p999_us",
+    "e2e_p50_us", "e2e_p99_us", "e2e_p999_us" };
+
+struct BenchOptions {
+    uint32_t messageNum;
+    uint32_t rate;
+    uint32_t payloadSize;
+    uint32_t workUs;
+    ModuleQueueType queueType;
+    std::string sinkName;
+    bool executorMode;
+};
+
+struct BenchResult {
+    double messagesPerSecond;
+    uint64_t hopLatency[QUANTILE_COUNT];      // p50, p99 and p999 of the slowest hop
+    uint64_t pipelineLatency[QUANTILE_COUNT]; // p50, p99 and p999 from the source to the sink, LatencySink only
+};
+
+std::vector<uint32_t> ParseList(const std::string &value)
+{
+    std::vector<uint32_t> items;
+    std::stringstream stream(value);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        items.push_back(std::stoul(item));
+    }
+    return items;
+}
+
+// every stage of the pipeline is a module type of its own, named SyntheticStage1 to SyntheticStage<stageNum>
+std::vector<std::string> GetStageNames(uint32_t stageNum)
+{
+    std::vector<std::string> stageNames;
+    for (uint32_t i = 1; i <= stageNum; i++) {
+        std::string stageName = STAGE_NAME + std::to_string(i);
+        ModuleFactory::RegisterModule(stageName, []() -> void * { return new SyntheticStage; });
+        stageNames.push_back(stageName);
+    }
+    return stageNames;
+}
+
+void WriteConfig(uint32_t channelCount, const std::vector<std::string> &stageNames, const BenchOptions &options)
+{
+    // NewConfig appends to an existing file
+    std::remove(BENCH_CONFIG.c_str());
+    ConfigParser config;
+    config.NewConfig(BENCH_CONFIG);
+    config.WriteUint32("SystemConfig.channelCount", channelCount);
+    config.WriteString("SystemConfig.executorMode", options.executorMode ? "true" : "false");
+    config.WriteUint32(MT_SyntheticSource + ".rate", options.rate);
+    config.WriteUint32(MT_SyntheticSource + ".payloadSize", options.payloadSize);
+    config.WriteUint32(MT_SyntheticSource + ".messageCount", options.messageNum);
+    std::string sender = MT_SyntheticSource;
+    for (auto &stageName : stageNames) {
+        config.WriteString(sender + ".next", stageName);
+        config.WriteUint32(stageName + ".workUs", options.workUs);
+        sender = stageName;
+    }
+    config.WriteString(sender + ".next", options.sinkName);
+    config.SaveConfig();
+}
+
+void GetQuantiles(const MetricHistogram &histogram, uint64_t quantiles[])
+{
+    quantiles[0] = histogram.GetQuantile(QUANTILE_P50);
+    quantiles[1] = histogram.GetQuantile(QUANTILE_P99);
+    quantiles[2] = histogram.GetQuantile(QUANTILE_P999);
+}
+
+// run on an initialized moduleManager, RunPipeline deinitializes it whatever the result
+APP_ERROR RunModules(ModuleManager &moduleManager, const std::string &pipelineName, uint32_t channelCount,
+    const std::vector<std::string> &stageNames, const BenchOptions &options, BenchResult &result)
+{
+    std::vector<ModuleDesc> moduleDesc = {{MT_SyntheticSource, -1}};
+    std::vector<ModuleConnectDesc> connectDesc = {};
+    std::string sender = MT_SyntheticSource;
+    for (auto &stageName : stageNames) {
+        moduleDesc.push_back({stageName, -1});
+        connectDesc.push_back({sender, stageName, MODULE_CONNECT_CHANNEL, options.queueType, MODULE_OVERLOAD_BLOCK, 0,
+            QUEUE_WAIT_DEFAULT, false});
+        sender = stageName;
+    }
+    moduleDesc.push_back({options.sinkName, -1});
+    connectDesc.push_back({sender, options.sinkName, MODULE_CONNECT_CHANNEL, options.queueType, MODULE_OVERLOAD_BLOCK,
+        0, QUEUE_WAIT_DEFAULT, false});
+
+    APP_ERROR ret = moduleManager.RegisterModules(pipelineName, moduleDesc.data(), moduleDesc.size(), channelCount);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    ret = moduleManager.RegisterModuleConnects(pipelineName, connectDesc.data(), connectDesc.size());
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+
+    // the pipeline name keeps the metrics of every run apart
+    std::shared_ptr<MetricsRegistry> registry = MetricsRegistry::GetInstance();
+    MetricLabels sinkLabels = {{"pipeline", pipelineName}, {"module", options.sinkName}};
+    std::shared_ptr<MetricCounter> received = registry->GetCounter("ascend_synthetic_received_total", "", sinkLabels);
+    uint64_t totalMessages = static_cast<uint64_t>(channelCount) * options.messageNum;
+    auto startTime = Clock::now();
+    ret = moduleManager.RunPipeline();
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    while (received->Get() < totalMessages) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(WAIT_INTERVAL_MS));
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    result.messagesPerSecond = totalMessages / seconds;
+
+    // a hop is the time from SendToPort in the sender to Process in the receiver
+    std::vector<std::string> receiverNames = stageNames;
+    if (options.sinkName == MT_LatencySink) {
+        receiverNames.push_back(options.sinkName);
+        GetQuantiles(*registry->GetHistogram("ascend_synthetic_latency_ns", "", sinkLabels), result.pipelineLatency);
+    }
+    for (auto &receiverName : receiverNames) {
+        uint64_t hopLatency[QUANTILE_COUNT] = {};
+        GetQuantiles(*registry->GetHistogram("ascend_synthetic_hop_latency_ns", "",
+            {{"pipeline", pipelineName}, {"module", receiverName}}), hopLatency);
+        for (int i = 0; i < QUANTILE_COUNT; i++) {
+            result.hopLatency[i] = std::max(result.hopLatency[i], hopLatency[i]);
+        }
+    }
+    return APP_ERR_OK;
+}
+
+APP_ERROR RunPipeline(const std::string &pipelineName, uint32_t channelCount,
+    const std::vector<std::string> &stageNames, const BenchOptions &options, BenchResult &result)
+{
+    std::string configPath = BENCH_CONFIG;
+    std::string aclConfigPath = "";
+    ModuleManager moduleManager;
+    APP_ERROR ret = moduleManager.Init(configPath, aclConfigPath);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    ret = RunModules(moduleManager, pipelineName, channelCount, stageNames, options, result);
+    APP_ERROR deInitRet = moduleManager.DeInit();
+    return (ret != APP_ERR_OK) ? ret : deInitRet;
+}
+
+APP_ERROR ParseOptions(CommandParser &option, BenchOptions &options)
+{
+    options.messageNum = option.GetUint32Option("-messages");
+    options.rate = option.GetUint32Option("-rate");
+    options.payloadSize = option.GetUint32Option("-payload");
+    options.workUs = option.GetUint32Option("-work_us");
+    options.executorMode = option.GetBoolOption("-executor");
+    std::string queueType = option.GetStringOption("-queue");
+    if (queueType == "blocking") {
+        options.queueType = MODULE_QUEUE_BLOCKING;
+    } else if (queueType == "spsc") {
+        options.queueType = MODULE_QUEUE_SPSC;
+    } else if (queueType == "mpmc") {
+        options.queueType = MODULE_QUEUE_MPMC;
+    } else {
+        std::cout << "Unknown queue type " << queueType << "." << std::endl;
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    std::string sink = option.GetStringOption("-sink");
+    if (sink == "latency") {
+        options.sinkName = MT_LatencySink;
+    } else if (sink == "null") {
+        options.sinkName = MT_NullSink;
+    } else {
+        std::cout << "Unknown sink " << sink << "." << std::endl;
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    if (options.messageNum == 0) {
+        std::cout << "-messages must be greater than 0." << std::endl;
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    return APP_ERR_OK;
+}
+
+// a row per run for statcompare, the options of the bench are the run metadata
+MetricsRecord GetRecord(uint32_t stageCount, uint32_t channelCount, const BenchResult &result, bool hasE2e)
+{
+    MetricsRecord record = { "framework_bench", "pipeline",
+        "stages=" + std::to_string(stageCount) + ",channels=" + std::to_string(channelCount),
+        { result.messagesPerSecond } };
+    for (int i = 0; i < QUANTILE_COUNT; i++) {
+        record.values.push_back(result.hopLatency[i] / NS_PER_US);
+    }
+    for (int i = 0; i < QUANTILE_COUNT; i++) {
+        record.values.push_back(hasE2e ? result.pipelineLatency[i] / NS_PER_US : NAN);
+    }
+    return record;
+}
+
+void SetRecordMetadata(CommandParser &option)
+{
+    const std::vector<std::string> names = { "-messages", "-rate", "-payload", "-work_us", "-queue", "-sink",
+        "-executor" };
+    for (auto &name : names) {
+        MetricsRecordFile::SetRunMetadata("bench_" + name.substr(1), option.GetStringOption(name));
+    }
+}
+
+void PrintQuantiles(const uint64_t quantiles[], bool isValid)
+{
+    for (int i = 0; i < QUANTILE_COUNT; i++) {
+        if (isValid) {
+            std::cout << std::setw(VALUE_WIDTH) << quantiles[i] / NS_PER_US;
+        } else {
+            std::cout << std::setw(VALUE_WIDTH) << "-";
+        }
+    }
+}
+}
+
+int main(int argc, const char *argv[])
+{
+    CommandParser option;
+    option.AddOption("-stages", "1,2,4,8", "numbers of stages between the source and the sink, separated by commas");
+    option.AddOption("-channels", "1,4", "channel counts to run, separated by commas");
+    option.AddOption("-messages", "20000", "number of messages sent by every channel");
+    option.AddOption("-rate", "0", "messages per second of every channel, 0 means as fast as possible");
+    option.AddOption("-payload", "0", "payload size of every message in bytes");
+    option.AddOption("-work_us", "0", "cpu time spent by every stage on one message");
+    option.AddOption("-queue", "spsc", "input queues of the connections: blocking, spsc or mpmc");
+    option.AddOption("-sink", "latency", "sink of the pipeline: latency or null");
+    option.AddOption("-executor", "false", "run the instances on the executor instead of one thread each");
+    option.AddOption("-record", "", "file the results are appended to as JSON Lines (.jsonl) or CSV, see statcompare");
+    option.ParseArgs(argc, argv);
+
+    BenchOptions options = {};
+    APP_ERROR ret = ParseOptions(option, options);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    std::vector<uint32_t> stageCounts = ParseList(option.GetStringOption("-stages"));
+    std::vector<uint32_t> channelCounts = ParseList(option.GetStringOption("-channels"));
+    std::string recordFileName = option.GetStringOption("-record");
+    std::shared_ptr<MetricsRecordFile> recordFile = nullptr;
+    if (!recordFileName.empty()) {
+        SetRecordMetadata(option);
+        recordFile = std::make_shared<MetricsRecordFile>(recordFileName, RECORD_COLUMNS);
+    }
+
+    AtlasAscendLog::Log::LogErrorOn();
+    std::cout << std::left << std::setw(VALUE_WIDTH) << "stages" << std::setw(VALUE_WIDTH) << "channels"
+              << std::setw(VALUE_WIDTH) << "msgs/s" << std::setw(VALUE_WIDTH) << "hop p50(us)"
+              << std::setw(VALUE_WIDTH) << "hop p99(us)" << std::setw(VALUE_WIDTH) << "hop p999(us)"
+              << std::setw(VALUE_WIDTH) << "e2e p50(us)" << std::setw(VALUE_WIDTH) << "e2e p99(us)"
+              << std::setw(VALUE_WIDTH) << "e2e p999(us)" << std::endl;
+    int runId = 0;
+    for (auto stageCount : stageCounts) {
+        std::vector<std::string> stageNames = GetStageNames(stageCount);
+        for (auto channelCount : channelCounts) {
+            WriteConfig(channelCount, stageNames, options);
+            BenchResult result = {};
+            std::string pipelineName = "FrameworkBench" + std::to_string(runId++);
+            ret = RunPipeline(pipelineName, channelCount, stageNames, options, result);
+            if (ret != APP_ERR_OK) {
+                std::cout << "Fail to run the pipeline, ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ")."
+                          << std::endl;
+                return ret;
+            }
+            std::cout << std::left << std::setw(VALUE_WIDTH) << stageCount << std::setw(VALUE_WIDTH) << channelCount
+                      << std::setw(VALUE_WIDTH) << static_cast<uint64_t>(result.messagesPerSecond);
+            PrintQuantiles(result.hopLatency, true);
+            PrintQuantiles(result.pipelineLatency, options.sinkName == MT_LatencySink);
+            std::cout << std::endl;
+            if (recordFile != nullptr) {
+                recordFile->Write({ GetRecord(stageCount, channelCount, result, options.sinkName == MT_LatencySink) });
+            }
+        }
+    }
+    return 0;
+}
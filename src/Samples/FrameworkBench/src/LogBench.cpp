@@ -0,0 +1,243 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CommandParser/CommandParser.h"
+#include "Log/BinaryLog.h"
+#include "Log/Log.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+using namespace AtlasAscendLog;
+
+const int MODE_WIDTH = 14;
+const int VALUE_WIDTH = 16;
+const int FRAME_WIDTH = 416;
+const int FRAME_HEIGHT = 416;
+
+// the logger prints every line to the screen as well, the benchmark throws that copy away
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c)
+    {
+        return c;
+    }
+};
+
+enum BenchWriter {
+    BENCH_WRITER_SYNC = 0, // the logging thread writes its lines
+    BENCH_WRITER_ASYNC,    // Log::StartAsync
+    BENCH_WRITER_BINARY    // BinaryLog::Start and LogBinInfo
+};
+
+struct BenchMode {
+    std::string name;
+    BenchWriter writer;
+    LogOverflowPolicy overflowPolicy;
+};
+
+const std::vector<BenchMode> MODES = {
+    { "sync", BENCH_WRITER_SYNC, LOG_OVERFLOW_BLOCK },
+    { "async_block", BENCH_WRITER_ASYNC, LOG_OVERFLOW_BLOCK },
+    { "async_drop", BENCH_WRITER_ASYNC, LOG_OVERFLOW_DROP },
+    { "binary_block", BENCH_WRITER_BINARY, LOG_OVERFLOW_BLOCK },
+    { "binary_drop", BENCH_WRITER_BINARY, LOG_OVERFLOW_DROP },
+};
+
+std::atomic<uint64_t> g_evaluatedNum(0);
+
+// an operand of the disabled statements, counts how many times it is evaluated
+__attribute__((noinline)) uint32_t CountedValue(uint32_t value)
+{
+    g_evaluatedNum++;
+    return value;
+}
+
+struct BenchResult {
+    double callNs;      // mean time spent in one LogInfo statement by the logging thread
+    double linesPerSec; // lines logged by all the threads over the time until they are all written
+};
+
+struct BenchBuffer {
+    uint32_t lineNum;    // lines queued to the async writer
+    uint32_t binarySize; // bytes of the ring of every thread of the binary log
+};
+
+void LogLines(BenchWriter writer, uint32_t channel, uint32_t lineNum)
+{
+    if (writer == BENCH_WRITER_BINARY) {
+        for (uint32_t j = 0; j < lineNum; j++) {
+            LogBinInfo("channel {} frame {} decoded, width {} height {}", channel, j, FRAME_WIDTH, FRAME_HEIGHT);
+        }
+        return;
+    }
+    for (uint32_t j = 0; j < lineNum; j++) {
+        LogInfo << "channel " << channel << " frame " << j << " decoded, width " << FRAME_WIDTH << " height "
+                << FRAME_HEIGHT;
+    }
+}
+
+APP_ERROR RunCase(const BenchMode &mode, uint32_t threadNum, uint32_t lineNum, const BenchBuffer &buffer,
+    BenchResult &result)
+{
+    APP_ERROR ret = APP_ERR_OK;
+    if (mode.writer == BENCH_WRITER_ASYNC) {
+        ret = Log::StartAsync(buffer.lineNum, mode.overflowPolicy);
+    } else if (mode.writer == BENCH_WRITER_BINARY) {
+        ret = BinaryLog::Start(buffer.binarySize, mode.overflowPolicy);
+    }
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    std::vector<double> callNs(threadNum);
+    std::vector<std::thread> threads;
+    auto startTime = Clock::now();
+    for (uint32_t i = 0; i < threadNum; i++) {
+        threads.emplace_back([i, lineNum, &mode, &callNs]() {
+            auto threadStart = Clock::now();
+            LogLines(mode.writer, i, lineNum);
+            callNs[i] = std::chrono::duration<double, std::nano>(Clock::now() - threadStart).count() / lineNum;
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    Log::StopAsync();
+    BinaryLog::Stop();
+    double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    result.callNs = 0;
+    for (auto ns : callNs) {
+        result.callNs += ns / threadNum;
+    }
+    result.linesPerSec = static_cast<double>(threadNum) * lineNum / seconds;
+    return APP_ERR_OK;
+}
+// what LogDebug expanded to before it checked the level: a Log holding copies of the file and function names and
+// every operand evaluated, then thrown away by Stream and ~Log
+__attribute__((noinline)) void DisabledByLog(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        std::string file = __FILE__;
+        std::string function = __FUNCTION__;
+        Log(file.c_str(), function.c_str(), __LINE__, LOG_LEVEL_DEBUG).Stream() << "frame " << CountedValue(i);
+    }
+}
+
+__attribute__((noinline)) void DisabledAtRuntime(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        LogDebug << "frame " << CountedValue(i);
+    }
+}
+
+// the statements of this function are built as if with -DASCEND_LOG_MIN_LEVEL=1
+#pragma push_macro("ASCEND_LOG_MIN_LEVEL")
+#undef ASCEND_LOG_MIN_LEVEL
+#define ASCEND_LOG_MIN_LEVEL 1
+__attribute__((noinline)) void DisabledAtCompileTime(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        LogDebug << "frame " << CountedValue(i);
+    }
+}
+#pragma pop_macro("ASCEND_LOG_MIN_LEVEL")
+
+// an enabled statement over its rate limit, only the first one is written
+__attribute__((noinline)) void SuppressedByRateLimit(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        LogInfoLimited(1) << "frame " << CountedValue(i);
+    }
+}
+
+void RunDisabledCases(uint32_t count, NullBuffer &nullBuffer)
+{
+    struct DisabledCase {
+        std::string name;
+        void (*run)(uint32_t);
+    };
+    const std::vector<DisabledCase> cases = {
+        { "log_object", DisabledByLog },
+        { "runtime", DisabledAtRuntime },
+        { "compile_time", DisabledAtCompileTime },
+        { "rate_limited", SuppressedByRateLimit },
+    };
+    std::cout << std::left << std::setw(VALUE_WIDTH) << "disabled" << std::setw(VALUE_WIDTH) << "ns/statement"
+              << std::setw(VALUE_WIDTH) << "evaluated" << std::endl;
+    for (auto &disabledCase : cases) {
+        g_evaluatedNum = 0;
+        std::streambuf *screen = std::cout.rdbuf(&nullBuffer);
+        auto startTime = Clock::now();
+        disabledCase.run(count);
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - startTime).count() / count;
+        std::cout.rdbuf(screen);
+        std::cout << std::left << std::setw(VALUE_WIDTH) << disabledCase.name << std::fixed << std::setprecision(2)
+                  << std::setw(VALUE_WIDTH) << ns << std::setw(VALUE_WIDTH) << g_evaluatedNum << std::endl;
+    }
+}
+}
+
+int main(int argc, const char *argv[])
+{
+    CommandParser option;
+    option.AddOption("-lines", "100000", "number of lines logged by every thread");
+    option.AddOption("-threads", "1,4", "numbers of logging threads, separated by commas");
+    option.AddOption("-buffer", "8192", "lines queued to the writer thread of the async modes");
+    option.AddOption("-binary_buffer", "1048576", "bytes of the ring of every logging thread of the binary modes");
+    option.AddOption("-disabled", "10000000", "number of disabled LogDebug statements run by every disabled case");
+    option.ParseArgs(argc, argv);
+
+    uint32_t lineNum = option.GetUint32Option("-lines");
+    BenchBuffer buffer = { option.GetUint32Option("-buffer"), option.GetUint32Option("-binary_buffer") };
+    uint32_t disabledNum = option.GetUint32Option("-disabled");
+    std::vector<uint32_t> threadCounts;
+    std::stringstream threads(option.GetStringOption("-threads"));
+    std::string item;
+    while (std::getline(threads, item, ',')) {
+        threadCounts.push_back(std::stoul(item));
+    }
+
+    Log::LogInfoOn();
+    NullBuffer nullBuffer;
+    RunDisabledCases(disabledNum, nullBuffer);
+    std::cout << std::endl;
+    std::cout << std::left << std::setw(VALUE_WIDTH) << "threads" << std::setw(MODE_WIDTH) << "mode"
+              << std::setw(VALUE_WIDTH) << "ns/call" << std::setw(VALUE_WIDTH) << "lines/s" << std::endl;
+    for (auto threadNum : threadCounts) {
+        for (auto &mode : MODES) {
+            BenchResult result = {};
+            std::streambuf *screen = std::cout.rdbuf(&nullBuffer);
+            APP_ERROR ret = RunCase(mode, threadNum, lineNum, buffer, result);
+            std::cout.rdbuf(screen);
+            if (ret != APP_ERR_OK) {
+                std::cout << "Fail to run the case, ret=" << ret << "." << std::endl;
+                return ret;
+            }
+            std::cout << std::left << std::setw(VALUE_WIDTH) << threadNum << std::setw(MODE_WIDTH) << mode.name
+                      << std::setw(VALUE_WIDTH) << static_cast<uint64_t>(result.callNs) << std::setw(VALUE_WIDTH)
+                      << static_cast<uint64_t>(result.linesPerSec) << std::endl;
+        }
+    }
+    return 0;
+}
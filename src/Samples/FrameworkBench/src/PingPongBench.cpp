@@ -0,0 +1,156 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+#include "BlockingQueue/BlockingQueue.h"
+#include "CommandParser/CommandParser.h"
+#include "RingQueue/RingQueue.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+using MessageQueue = QueueBase<std::shared_ptr<void>>;
+
+const int NAME_WIDTH = 20;
+const int STRATEGY_WIDTH = 14;
+const int VALUE_WIDTH = 14;
+const uint32_t QUEUE_CAPACITY = 200;
+const double PERCENT_50 = 0.5;
+const double PERCENT_99 = 0.99;
+
+struct BenchParams {
+    uint32_t count;
+    uint32_t spinUs;
+    uint32_t thinkUs;
+};
+
+struct BenchResult {
+    std::vector<double> oneWayUs; // half of every round trip, sorted
+    double cpuSeconds;            // user and system time of the process
+};
+
+struct StrategyName {
+    QueueWaitStrategy strategy;
+    std::string name;
+};
+
+const std::vector<StrategyName> STRATEGIES = {
+    { QUEUE_WAIT_BLOCK, "block" },
+    { QUEUE_WAIT_SPIN, "spin" },
+    { QUEUE_WAIT_SPIN_YIELD, "spin_yield" },
+    { QUEUE_WAIT_ADAPTIVE, "adaptive" },
+};
+
+std::shared_ptr<MessageQueue> CreateQueue(const std::string &queueName)
+{
+    if (queueName == "RingQueue(SPSC)") {
+        return std::make_shared<RingQueue<std::shared_ptr<void>, RING_QUEUE_SPSC>>(QUEUE_CAPACITY);
+    }
+    return std::make_shared<BlockingQueue<std::shared_ptr<void>>>(QUEUE_CAPACITY);
+}
+
+double GetCpuSeconds()
+{
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+// the ping thread sends one message and waits for it to come back before the next one, so that every hand-off
+// finds the other thread waiting on an empty queue
+BenchResult RunPingPong(const std::string &queueName, QueueWaitStrategy strategy, const BenchParams &params)
+{
+    std::shared_ptr<MessageQueue> pingQueue = CreateQueue(queueName);
+    std::shared_ptr<MessageQueue> pongQueue = CreateQueue(queueName);
+    pingQueue->SetWaitStrategy(strategy, params.spinUs);
+    pongQueue->SetWaitStrategy(strategy, params.spinUs);
+
+    BenchResult result;
+    result.oneWayUs.reserve(params.count);
+    double startCpuSeconds = GetCpuSeconds();
+    std::thread pong([&pingQueue, &pongQueue]() {
+        std::shared_ptr<void> item;
+        while (pingQueue->Pop(item) == APP_ERR_OK) {
+            pongQueue->Push(std::move(item), true);
+        }
+    });
+
+    std::shared_ptr<void> message = std::make_shared<int>(0);
+    for (uint32_t i = 0; i < params.count; i++) {
+        auto thinkEndTime = Clock::now() + std::chrono::microseconds(params.thinkUs);
+        while (Clock::now() < thinkEndTime) {
+        }
+        auto sendTime = Clock::now();
+        pingQueue->Push(std::move(message), true);
+        if (pongQueue->Pop(message) != APP_ERR_OK) {
+            break;
+        }
+        result.oneWayUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sendTime).count() / 2);
+    }
+    pingQueue->Stop();
+    pong.join();
+    result.cpuSeconds = GetCpuSeconds() - startCpuSeconds;
+    std::sort(result.oneWayUs.begin(), result.oneWayUs.end());
+    return result;
+}
+
+double Percentile(const std::vector<double> &sorted, double percent)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(percent * (sorted.size() - 1));
+    return sorted[index];
+}
+}
+
+int main(int argc, const char *argv[])
+{
+    CommandParser option;
+    option.AddOption("-count", "100000", "number of round trips of every case");
+    option.AddOption("-spin_us", "50", "spin budget of the spinning wait strategies");
+    option.AddOption("-think_us", "0", "time the ping thread works between two round trips");
+    option.ParseArgs(argc, argv);
+
+    BenchParams params;
+    params.count = std::max(option.GetUint32Option("-count"), 1u);
+    params.spinUs = option.GetUint32Option("-spin_us");
+    params.thinkUs = option.GetUint32Option("-think_us");
+
+    const std::vector<std::string> queueNames = { "BlockingQueue", "RingQueue(SPSC)" };
+    std::cout << std::left << std::setw(NAME_WIDTH) << "queue" << std::setw(STRATEGY_WIDTH) << "strategy"
+              << std::setw(VALUE_WIDTH) << "p50(us)" << std::setw(VALUE_WIDTH) << "p99(us)" << std::setw(VALUE_WIDTH)
+              << "max(us)" << std::setw(VALUE_WIDTH) << "cpu(s)" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (auto &queueName : queueNames) {
+        for (auto &strategy : STRATEGIES) {
+            BenchResult result = RunPingPong(queueName, strategy.strategy, params);
+            std::cout << std::setw(NAME_WIDTH) << queueName << std::setw(STRATEGY_WIDTH) << strategy.name
+                      << std::setw(VALUE_WIDTH) << Percentile(result.oneWayUs, PERCENT_50) << std::setw(VALUE_WIDTH)
+                      << Percentile(result.oneWayUs, PERCENT_99) << std::setw(VALUE_WIDTH)
+                      << (result.oneWayUs.empty() ? 0.0 : result.oneWayUs.back()) << std::setw(VALUE_WIDTH)
+                      << result.cpuSeconds << std::endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BlockingQueue/BlockingQueue.h"
+#include "CommandParser/CommandParser.h"
+#include "RingQueue/RingQueue.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+using MessageQueue = QueueBase<std::shared_ptr<void>>;
+
+const int NAME_WIDTH = 20;
+const int VALUE_WIDTH = 16;
+const uint32_t LATENCY_COUNT_MAX = 100000;
+const double PERCENT_50 = 0.5;
+const double PERCENT_99 = 0.99;
+
+struct BenchParams {
+    uint32_t count;
+    uint32_t capacity;
+    int producers;
+    int consumers;
+    uint32_t intervalUs;
+    uint32_t batch;
+};
+
+struct BenchMessage {
+    Clock::time_point sendTime;
+};
+
+std::shared_ptr<MessageQueue> CreateQueue(const std::string &queueName, uint32_t capacity)
+{
+    if (queueName == "RingQueue(SPSC)") {
+        return std::make_shared<RingQueue<std::shared_ptr<void>, RING_QUEUE_SPSC>>(capacity);
+    } else if (queueName == "RingQueue(MPMC)") {
+        return std::make_shared<RingQueue<std::shared_ptr<void>, RING_QUEUE_MPMC>>(capacity);
+    }
+    return std::make_shared<BlockingQueue<std::shared_ptr<void>>>(capacity);
+}
+
+// every producer pushes count / producers messages, consumers pop until all of them are received,
+// one by one or batch messages at once with PopBatch
+double RunThroughput(MessageQueue &queue, const BenchParams &params, int producers, int consumers, uint32_t batch = 1)
+{
+    uint64_t perProducer = params.count / producers;
+    uint64_t total = perProducer * producers;
+    std::atomic<uint64_t> received(0);
+    std::shared_ptr<void> message = std::make_shared<BenchMessage>();
+
+    auto startTime = Clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < consumers; i++) {
+        threads.emplace_back([&queue, &received, total, batch]() {
+            std::shared_ptr<void> item;
+            std::vector<std::shared_ptr<void>> items;
+            while (true) {
+                uint64_t count = 1;
+                if (batch > 1) {
+                    if (queue.PopBatch(items, batch, 0) != APP_ERR_OK) {
+                        break;
+                    }
+                    count = items.size();
+                } else if (queue.Pop(item) != APP_ERR_OK) {
+                    break;
+                }
+                if (received.fetch_add(count) + count == total) {
+                    queue.Stop();
+                }
+            }
+        });
+    }
+    for (int i = 0; i < producers; i++) {
+        threads.emplace_back([&queue, &message, perProducer]() {
+            for (uint64_t j = 0; j < perProducer; j++) {
+                queue.Push(message, true);
+            }
+        });
+    }
+    for (auto &t : threads) {
+        t.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    return total / seconds;
+}
+
+// one producer sends a message every intervalUs, the consumer measures the hand-off latency
+std::vector<double> RunLatency(MessageQueue &queue, const BenchParams &params)
+{
+    std::vector<double> latencyUs;
+    latencyUs.reserve(params.count);
+    std::thread consumer([&queue, &latencyUs, &params]() {
+        std::shared_ptr<void> item;
+        for (uint32_t i = 0; i < params.count; i++) {
+            if (queue.Pop(item) != APP_ERR_OK) {
+                break;
+            }
+            auto now = Clock::now();
+            auto message = std::static_pointer_cast<BenchMessage>(item);
+            latencyUs.push_back(std::chrono::duration<double, std::micro>(now - message->sendTime).count());
+        }
+    });
+
+    auto interval = std::chrono::microseconds(params.intervalUs);
+    auto nextTime = Clock::now();
+    for (uint32_t i = 0; i < params.count; i++) {
+        while (Clock::now() < nextTime) {
+        }
+        std::shared_ptr<BenchMessage> message = std::make_shared<BenchMessage>();
+        message->sendTime = Clock::now();
+        queue.Push(std::move(message), true);
+        nextTime += interval;
+    }
+    consumer.join();
+    std::sort(latencyUs.begin(), latencyUs.end());
+    return latencyUs;
+}
+
+double Percentile(const std::vector<double> &sorted, double percent)
+{
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(percent * (sorted.size() - 1));
+    return sorted[index];
+}
+}
+
+int main(int argc, const char *argv[])
+{
+    CommandParser option;
+    option.AddOption("-count", "1000000", "number of messages sent in every throughput case");
+    option.AddOption("-capacity", "200", "capacity of the queue, MODULE_QUEUE_SIZE by default");
+    option.AddOption("-producers", "4", "number of producer threads of the MPMC case");
+    option.AddOption("-consumers", "4", "number of consumer threads of the MPMC case");
+    option.AddOption("-interval_us", "20", "interval between two messages of the latency case");
+    option.AddOption("-batch", "16", "max number of messages popped at once in the batch case");
+    option.ParseArgs(argc, argv);
+
+    BenchParams params;
+    params.count = option.GetUint32Option("-count");
+    params.capacity = option.GetUint32Option("-capacity");
+    params.producers = std::max(option.GetIntOption("-producers"), 1);
+    params.consumers = std::max(option.GetIntOption("-consumers"), 1);
+    params.intervalUs = option.GetUint32Option("-interval_us");
+    params.batch = std::max(option.GetUint32Option("-batch"), 1u);
+
+    const std::vector<std::string> queueNames = { "BlockingQueue", "RingQueue(SPSC)", "RingQueue(MPMC)" };
+    std::string multiName = std::to_string(params.producers) + "P" + std::to_string(params.consumers) + "C";
+
+    std::string batchName = "1P1C/" + std::to_string(params.batch) + "(msg/s)";
+
+    std::cout << std::left << std::setw(NAME_WIDTH) << "queue" << std::setw(VALUE_WIDTH) << "1P1C(msg/s)"
+              << std::setw(VALUE_WIDTH) << batchName << std::setw(VALUE_WIDTH) << (multiName + "(msg/s)")
+              << std::setw(VALUE_WIDTH) << "p50(us)" << std::setw(VALUE_WIDTH) << "p99(us)" << std::setw(VALUE_WIDTH)
+              << "max(us)" << std::endl;
+    for (auto &queueName : queueNames) {
+        auto queue = CreateQueue(queueName, params.capacity);
+        double single = RunThroughput(*queue, params, 1, 1);
+        queue = CreateQueue(queueName, params.capacity);
+        double batched = RunThroughput(*queue, params, 1, 1, params.batch);
+
+        std::string multi = "-";
+        if (queueName != "RingQueue(SPSC)") {
+            queue = CreateQueue(queueName, params.capacity);
+            multi = std::to_string(static_cast<uint64_t>(
+                RunThroughput(*queue, params, params.producers, params.consumers)));
+        }
+
+        BenchParams latencyParams = params;
+        latencyParams.count = std::min(params.count, LATENCY_COUNT_MAX);
+        queue = CreateQueue(queueName, params.capacity);
+        std::vector<double> latencyUs = RunLatency(*queue, latencyParams);
+
+        std::cout << std::left << std::setw(NAME_WIDTH) << queueName << std::setw(VALUE_WIDTH)
+                  << static_cast<uint64_t>(single) << std::setw(VALUE_WIDTH) << static_cast<uint64_t>(batched)
+                  << std::setw(VALUE_WIDTH) << multi << std::fixed
+                  << std::setprecision(2) << std::setw(VALUE_WIDTH) << Percentile(latencyUs, PERCENT_50)
+                  << std::setw(VALUE_WIDTH) << Percentile(latencyUs, PERCENT_99) << std::setw(VALUE_WIDTH)
+                  << (latencyUs.empty() ? 0.0 : latencyUs.back()) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "CommandParser/CommandParser.h"
+#include "Log/Log.h"
+#include "ModuleManager/ModuleBase.h"
+
+using namespace ascendBaseModule;
+
+namespace {
+using Clock = std::chrono::steady_clock;
+using MessageQueue = QueueBase<std::shared_ptr<void>>;
+
+const int NAME_WIDTH = 28;
+const int VALUE_WIDTH = 16;
+const double NS_PER_SECOND = 1e9;
+const std::vector<std::string> RECEIVER_NAMES = { "VideoDecoder", "ModelInfer", "PostProcess", "ResultSender" };
+
+// accepts everything, so that only the routing cost is measured
+class DropQueue : public MessageQueue {
+public:
+    APP_ERROR Pop(std::shared_ptr<void> &item)
+    {
+        return APP_ERR_QUEUE_EMPTY;
+    }
+    APP_ERROR Pop(std::shared_ptr<void> &item, unsigned int timeOutMs)
+    {
+        return APP_ERR_QUEUE_EMPTY;
+    }
+    APP_ERROR Push(const std::shared_ptr<void> &item, bool isWait = false)
+    {
+        pushCount_++;
+        return APP_ERR_OK;
+    }
+    APP_ERROR Push(std::shared_ptr<void> &&item, bool isWait = false)
+    {
+        pushCount_++;
+        return APP_ERR_OK;
+    }
+    APP_ERROR PopBatch(std::vector<std::shared_ptr<void>> &items, uint32_t maxCount, unsigned int timeOutMs)
+    {
+        return APP_ERR_QUEUE_EMPTY;
+    }
+    APP_ERROR PushBatch(const std::vector<std::shared_ptr<void>> &items, bool isWait = false)
+    {
+        pushCount_ += items.size();
+        return APP_ERR_OK;
+    }
+    void Stop() {}
+    void Restart() {}
+    std::list<std::shared_ptr<void>> GetRemainItems()
+    {
+        return {};
+    }
+    APP_ERROR IsFull()
+    {
+        return false;
+    }
+    int GetSize()
+    {
+        return 0;
+    }
+    APP_ERROR IsEmpty()
+    {
+        return true;
+    }
+
+private:
+    uint64_t pushCount_ = 0;
+};
+
+class RouteModule : public ModuleBase {
+public:
+    APP_ERROR Init(ConfigParser &configParser, ModuleInitArgs &initArgs)
+    {
+        return APP_ERR_OK;
+    }
+    APP_ERROR DeInit(void)
+    {
+        return APP_ERR_OK;
+    }
+
+protected:
+    APP_ERROR Process(std::shared_ptr<void> inputData)
+    {
+        return APP_ERR_OK;
+    }
+};
+
+// the send path of ModuleBase before the output ports: two lookups by name and a copy of the output info
+class LegacyRouter {
+public:
+    void SetOutputInfo(const std::string &moduleName, const ModuleOutputInfo &outputInfo)
+    {
+        outputQueMap_[moduleName] = outputInfo;
+    }
+
+    void SendToNextModule(std::string moduleName, std::shared_ptr<void> outputData, int channelId = 0)
+    {
+        if (outputQueMap_.find(moduleName) == outputQueMap_.end()) {
+            return;
+        }
+        auto itr = outputQueMap_.find(moduleName);
+        if (itr == outputQueMap_.end()) {
+            return;
+        }
+        ModuleOutputInfo outputInfo = itr->second;
+        uint32_t ch = channelId % outputInfo.outputQueVecSize;
+        outputInfo.outputQueVec[ch]->Push(outputData, true);
+    }
+
+private:
+    std::map<std::string, ModuleOutputInfo> outputQueMap_ = {};
+};
+
+template<typename Send> double MeasureNsPerHop(uint32_t count, uint32_t channelCount, Send send)
+{
+    auto startTime = Clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        send(RECEIVER_NAMES[i % RECEIVER_NAMES.size()], i % RECEIVER_NAMES.size(), i % channelCount);
+    }
+    return std::chrono::duration<double>(Clock::now() - startTime).count() * NS_PER_SECOND / count;
+}
+}
+
+int main(int argc, const char *argv[])
+{
+    CommandParser option;
+    option.AddOption("-count", "10000000", "number of messages sent by every case");
+    option.AddOption("-channels", "8", "number of receiver instances of every connection");
+    option.ParseArgs(argc, argv);
+    uint32_t count = option.GetUint32Option("-count");
+    uint32_t channelCount = std::max(option.GetUint32Option("-channels"), 1u);
+    AtlasAscendLog::Log::LogErrorOn();
+
+    RouteModule module;
+    LegacyRouter legacyRouter;
+    for (auto &receiverName : RECEIVER_NAMES) {
+        std::vector<std::shared_ptr<MessageQueue>> outputQueVec;
+        for (uint32_t i = 0; i < channelCount; i++) {
+            outputQueVec.push_back(std::make_shared<DropQueue>());
+        }
+        module.SetOutputInfo(receiverName, MODULE_CONNECT_CHANNEL, outputQueVec);
+        ModuleOutputInfo outputInfo;
+        outputInfo.moduleName = receiverName;
+        outputInfo.connectType = MODULE_CONNECT_CHANNEL;
+        outputInfo.outputQueVec = outputQueVec;
+        outputInfo.outputQueVecSize = outputQueVec.size();
+        legacyRouter.SetOutputInfo(receiverName, outputInfo);
+    }
+    std::vector<PortId> ports;
+    for (auto &receiverName : RECEIVER_NAMES) {
+        ports.push_back(module.GetOutputPort(receiverName));
+    }
+    std::shared_ptr<void> message = std::make_shared<int>(0);
+
+    double legacyNs = MeasureNsPerHop(count, channelCount,
+        [&](const std::string &name, size_t index, int channelId) {
+            legacyRouter.SendToNextModule(name, message, channelId);
+        });
+    double nameNs = MeasureNsPerHop(count, channelCount,
+        [&](const std::string &name, size_t index, int channelId) {
+            module.SendToNextModule(name, message, channelId);
+        });
+    double portNs = MeasureNsPerHop(count, channelCount,
+        [&](const std::string &name, size_t index, int channelId) {
+            module.SendToPort(ports[index], message, channelId);
+        });
+
+    std::cout << std::left << std::setw(NAME_WIDTH) << "send path" << std::setw(VALUE_WIDTH) << "ns/hop" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::setw(NAME_WIDTH) << "SendToNextModule (before)" << std::setw(VALUE_WIDTH) << legacyNs
+              << std::endl;
+    std::cout << std::setw(NAME_WIDTH) << "SendToNextModule" << std::setw(VALUE_WIDTH) << nameNs << std::endl;
+    std::cout << std::setw(NAME_WIDTH) << "SendToPort" << std::setw(VALUE_WIDTH) << portNs << std::endl;
+    return 0;
+}
@@ -0,0 +1,174 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CommandParser/CommandParser.h"
+#include "Metrics/Metrics.h"
+#include "Statistic/Statistic.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+const int CASE_WIDTH = 14;
+const int VALUE_WIDTH = 16;
+const uint64_t DURATION_MASK = 0xfff; // spreads the recorded durations over a few hundred buckets
+
+struct BenchCase {
+    std::string name;
+    void (*run)(uint32_t, uint32_t); // thread index, records
+};
+
+std::shared_ptr<StatisticProbe> g_probe = nullptr;
+uint32_t g_reservoirSize = STATISTIC_RESERVOIR_SIZE;
+MetricHistogram *g_sharedHistogram = nullptr;
+std::atomic<uint64_t> g_sharedItemCount(0);
+
+// the probe sharded by thread
+void RecordProbe(uint32_t, uint32_t recordNum)
+{
+    for (uint32_t i = 0; i < recordNum; i++) {
+        g_probe->Record(i & DURATION_MASK);
+    }
+}
+
+// one histogram and one item counter written by every thread, what the probe costs without its shards
+void RecordShared(uint32_t, uint32_t recordNum)
+{
+    for (uint32_t i = 0; i < recordNum; i++) {
+        g_sharedHistogram->Record(i & DURATION_MASK);
+        g_sharedItemCount.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// RunTimeStatisticStart/Stop of a Statistic per thread on the same model name, clock reads included
+void RecordWrapper(uint32_t threadIndex, uint32_t recordNum)
+{
+    Statistic statistic;
+    for (uint32_t i = 0; i < recordNum; i++) {
+        statistic.RunTimeStatisticStart("StatisticBenchWrapper", threadIndex, false);
+        statistic.RunTimeStatisticStop();
+    }
+}
+
+// PROBE around an empty scope, the two ProbeClock reads included
+void RecordScoped(uint32_t, uint32_t recordNum)
+{
+    for (uint32_t i = 0; i < recordNum; i++) {
+        PROBE("StatisticBenchScoped");
+    }
+}
+
+const std::vector<BenchCase> CASES = {
+    { "probe", RecordProbe },
+    { "shared", RecordShared },
+    { "wrapper", RecordWrapper },
+    { "scoped", RecordScoped },
+};
+
+// calls of a probe of Statistic
+uint64_t GetCallCount(const std::string &name)
+{
+    for (auto &result : Statistic::GetResults()) {
+        if (result.name == name) {
+            return result.callCount;
+        }
+    }
+    return 0;
+}
+
+// return the number of records counted at the end
+uint64_t RunCase(const BenchCase &benchCase, uint32_t threadNum, uint32_t recordNum, double &seconds)
+{
+    g_probe = std::make_shared<StatisticProbe>("StatisticBench", g_reservoirSize);
+    MetricHistogram sharedHistogram;
+    g_sharedHistogram = &sharedHistogram;
+    g_sharedItemCount = 0;
+    std::vector<std::thread> threads;
+    auto startTime = Clock::now();
+    for (uint32_t i = 0; i < threadNum; i++) {
+        threads.emplace_back(benchCase.run, i, recordNum);
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    if (benchCase.run == RecordShared) {
+        return sharedHistogram.GetCount();
+    }
+    if (benchCase.run == RecordWrapper) {
+        return GetCallCount("StatisticBenchWrapper");
+    }
+    if (benchCase.run == RecordScoped) {
+        return GetCallCount("StatisticBenchScoped");
+    }
+    return g_probe->GetResult().callCount;
+}
+}
+
+int main(int argc, const char *argv[])
+{
+    CommandParser option;
+    option.AddOption("-records", "1000000", "number of records of every thread");
+    option.AddOption("-threads", "1,4,8", "numbers of recording threads, separated by commas");
+    option.AddOption("-reservoir", std::to_string(STATISTIC_RESERVOIR_SIZE),
+        "raw samples kept by every shard, 0 for none");
+    option.ParseArgs(argc, argv);
+
+    uint32_t recordNum = option.GetUint32Option("-records");
+    std::vector<uint32_t> threadCounts;
+    std::stringstream threads(option.GetStringOption("-threads"));
+    std::string item;
+    while (std::getline(threads, item, ',')) {
+        threadCounts.push_back(std::stoul(item));
+    }
+
+    g_reservoirSize = option.GetUint32Option("-reservoir");
+    Statistic::SetReservoirSize(g_reservoirSize);
+    Statistic::SetStatisticEnable(true);
+    std::cout << std::left << std::setw(VALUE_WIDTH) << "threads" << std::setw(CASE_WIDTH) << "case"
+              << std::setw(VALUE_WIDTH) << "ns/record" << std::setw(VALUE_WIDTH) << "records/s"
+              << std::setw(VALUE_WIDTH) << "lost" << std::endl;
+    uint64_t wrapperCount = 0;
+    uint64_t scopedCount = 0;
+    for (auto threadNum : threadCounts) {
+        for (auto &benchCase : CASES) {
+            double seconds = 0;
+            uint64_t counted = RunCase(benchCase, threadNum, recordNum, seconds);
+            uint64_t expected = static_cast<uint64_t>(threadNum) * recordNum;
+            // the probes of the wrapper and of PROBE keep the records of the previous thread counts
+            if (benchCase.run == RecordWrapper) {
+                counted -= wrapperCount;
+                wrapperCount += counted;
+            } else if (benchCase.run == RecordScoped) {
+                counted -= scopedCount;
+                scopedCount += counted;
+            }
+            std::cout << std::left << std::setw(VALUE_WIDTH) << threadNum << std::setw(CASE_WIDTH) << benchCase.name
+                      << std::fixed << std::setprecision(2) << std::setw(VALUE_WIDTH)
+                      << seconds * 1e9 / recordNum << std::setw(VALUE_WIDTH)
+                      << static_cast<uint64_t>(expected / seconds) << std::setw(VALUE_WIDTH) << expected - counted
+                      << std::endl;
+        }
+    }
+    return 0;
+}
@@ -16,6 +16,7 @@
 #include "AclProcess.h"
 #include <sys/time.h>
 #include <thread>
+#include "Statistic/Statistic.h"
 
 // resnet class num
 const int CLASS_TYPE_NUM = 1000;
@@ -431,9 +432,7 @@ APP_ERROR AclProcess::ArgMaxOpInfer()
 APP_ERROR AclProcess::Process(const std::string& imageFile)
 {
     // The following code provides a method to calculate the time cost of preprocess module
-    struct timeval begin = {0};
-    struct timeval end = {0};
-    gettimeofday(&begin, nullptr);
+    uint64_t beginTicks = ProbeClock::Now();
     APP_ERROR ret = Preprocess(imageFile);
     if (ret != APP_ERR_OK) {
         return ret;
@@ -462,9 +461,8 @@ APP_ERROR AclProcess::Process(const std::string& imageFile)
         return ret;
     }
 
-    gettimeofday(&end, nullptr);
     // Calculate the time cost of preprocess
-    const double costMs = SEC2MS * (end.tv_sec - begin.tv_sec) + (end.tv_usec - begin.tv_usec) / SEC2MS;
+    const double costMs = ProbeClock::ToMs(ProbeClock::Now() - beginTicks);
     LogInfo << "[Process Delay] cost: " << costMs << "ms.";
     return APP_ERR_OK;
 }
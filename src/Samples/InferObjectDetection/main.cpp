@@ -13,7 +13,6 @@
  * limitations under the License.
  */
 
-#include <sys/time.h>
 #include "AclProcess.h"
 #include "ResourceManager/ResourceManager.h"
 #include "CommonDataType/CommonDataType.h"
@@ -21,6 +20,7 @@
 #include "ErrorCode/ErrorCode.h"
 #include "CommandParser/CommandParser.h"
 #include "ConfigParser/ConfigParser.h"
+#include "Statistic/Statistic.h"
 
 /*
  * @description: Parse input parameters of command line and check the validity of them
@@ -156,17 +156,14 @@ APP_ERROR Process(ResourceInfo &resourceInfo, const std::string &file, const int
         aclProcess.Release();
         return ret;
     }
-    struct timeval begin = {0};
-    struct timeval end = {0};
-    gettimeofday(&begin, nullptr);
+    uint64_t beginTicks = ProbeClock::Now();
     ret = aclProcess.Process(file, modelType);
     if (ret != APP_ERR_OK) {
         aclProcess.Release();
         return ret;
     }
-    gettimeofday(&end, nullptr);
     // Calculate the time cost of the whole process
-    double costMs = SEC2MS * (end.tv_sec - begin.tv_sec) + (end.tv_usec - begin.tv_usec) / SEC2MS;
+    double costMs = ProbeClock::ToMs(ProbeClock::Now() - beginTicks);
     double fps = SEC2MS / costMs;
     LogInfo << "[Process Delay] cost: " << costMs << "ms\tfps: " << fps;
     aclProcess.Release();
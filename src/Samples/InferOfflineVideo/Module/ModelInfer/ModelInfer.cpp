@@ -15,6 +15,8 @@
 #include "ModelInfer/ModelInfer.h"
 #include "PostProcess/PostProcess.h"
 #include "Singleton.h"
+#include "Tracer/Tracer.h"
+#include "Log/BinaryLog.h"
 
 using namespace ascendBaseModule;
 
@@ -101,19 +103,24 @@ APP_ERROR ModelInfer::Init(ConfigParser &configParser, ModuleInitArgs &initArgs)
 
     aclmdlDesc *modelDesc = modelProcess_->GetModelDesc();
     size_t outputSize = aclmdlGetNumOutputs(modelDesc);
-    ModelBufferSize::outputSize_ = outputSize;
+    outputSizes_.clear();
     for (size_t i = 0; i < outputSize; i++) {
         size_t bufferSize = aclmdlGetOutputSizeByIndex(modelDesc, i);
-        ModelBufferSize::bufferSize_.push_back(bufferSize);
+        outputSizes_.push_back(bufferSize);
+    }
+    // read by PostProcess, only the first instance sets it, before the threads start
+    if (ModelBufferSize::bufferSize_.empty()) {
+        ModelBufferSize::outputSize_ = outputSize;
+        ModelBufferSize::bufferSize_ = outputSizes_;
     }
 
     for (size_t i = 0; i < BUFFER_SZIE; ++i) {
         std::vector<void *> temp;
         for (size_t j = 0; j < outputSize; ++j) {
             void *outputBuffer = nullptr;
-            APP_ERROR ret = aclrtMalloc(&outputBuffer, ModelBufferSize::bufferSize_[j], ACL_MEM_MALLOC_NORMAL_ONLY);
+            APP_ERROR ret = aclrtMalloc(&outputBuffer, outputSizes_[j], ACL_MEM_MALLOC_NORMAL_ONLY);
             if (ret != APP_ERR_OK) {
-                LogError << "Failed to malloc buffer, size is " << ModelBufferSize::bufferSize_[j];
+                LogError << "Failed to malloc buffer, size is " << outputSizes_[j];
                 return ret;
             }
             temp.push_back(outputBuffer);
@@ -123,14 +130,20 @@ APP_ERROR ModelInfer::Init(ConfigParser &configParser, ModuleInitArgs &initArgs)
     return APP_ERR_OK;
 }
 
+void ModelInfer::BindOutputPorts()
+{
+    postProcessPort_ = GetOutputPort(MT_PostProcess);
+}
+
 APP_ERROR ModelInfer::Process(std::shared_ptr<void> inputData)
 {
     std::shared_ptr<DvppDataInfoT> vpcData = std::static_pointer_cast<DvppDataInfoT>(inputData);
+    Tracer::SetFrame(vpcData->channelId, vpcData->frameId);
     if (vpcData->eof) {
         std::shared_ptr<CommonData> data = std::make_shared<CommonData>();
         data->channelId = vpcData->channelId;
         data->eof = true;
-        SendToNextModule(MT_PostProcess, data, data->channelId);
+        SendToPort(postProcessPort_, std::move(data), vpcData->channelId);
         return APP_ERR_OK;
     }
     srcImageWidth_ = vpcData->srcImageWidth;
@@ -144,7 +157,7 @@ APP_ERROR ModelInfer::Process(std::shared_ptr<void> inputData)
         dataToSend, vpcData->dvppData, outBuf, outSizes, modelOutput);
     if (ret != APP_ERR_OK) {
         acldvppFree(vpcData->dvppData->data);
-        LogError << "Failed to YoloProcess, ret=" << ret;
+        LogBinError("Failed to YoloProcess, ret={}", ret);
         return ret;
     }
     acldvppFree(vpcData->dvppData->data);
@@ -159,7 +172,8 @@ APP_ERROR ModelInfer::Process(std::shared_ptr<void> inputData)
     data->modelType = modelType_;
     data->channelId = vpcData->channelId;
     data->frameId = vpcData->frameId;
-    SendToNextModule(MT_PostProcess, data, data->channelId);
+    SendToPort(postProcessPort_, std::move(data), vpcData->channelId);
+    LogBinDebug("ModelInfer [{}]: channel {} frame {} inferred", instanceId_, vpcData->channelId, vpcData->frameId);
     return APP_ERR_OK;
 }
 
@@ -201,20 +215,20 @@ APP_ERROR ModelInfer::YoloProcess(uint32_t channelId, uint32_t frameId, std::sha
 
     APP_ERROR ret = InputBuffMalloc(vpcData, inputDataBuffers, buffersSize, yoloInfo);
     if (ret != APP_ERR_OK) {
-        LogError << "Failed to execute InputBuffMalloc, ret = " << ret;
+        LogBinError("Failed to execute InputBuffMalloc, ret = {}", ret);
         return ret;
     }
 
     outBuf = buffers_.front();
     buffers_.pop();
     buffers_.push(outBuf);
-    outSizes = ModelBufferSize::bufferSize_;
+    outSizes = outputSizes_;
 
     dataToSend->channelId = channelId;
     dataToSend->framId = frameId;
     ret = modelProcess_->ModelInference(inputDataBuffers, buffersSize, outBuf, outSizes);
     if (ret != APP_ERR_OK) {
-        LogError << "Failed to execute ModelInference, ret = " << ret;
+        LogBinError("Failed to execute ModelInference, ret = {}", ret);
         return ret;
     }
     for (size_t i = 0; i < outBuf.size(); i++) {
@@ -249,13 +263,13 @@ APP_ERROR ModelInfer::InputBuffMalloc(std::shared_ptr<DvppDataInfo> &vpcData, st
         uint32_t imgInfoInputSize = sizeof(float) * IMAGE_INFO_ARRAY_SIZE;
         APP_ERROR ret = acldvppMalloc(&yoloImgInfo, imgInfoInputSize);
         if (ret != APP_ERR_OK) {
-            LogError << "Failed to malloc buffer, size is " << imgInfoInputSize << ", ret = " << ret;
+            LogBinError("Failed to malloc buffer, size is {}, ret = {}", imgInfoInputSize, ret);
             return ret;
         }
         yoloInfo.reset(yoloImgInfo, acldvppFree);
         ret = aclrtMemcpy((uint8_t *) yoloImgInfo, imgInfoInputSize, imgInfo, imgInfoInputSize, ACL_MEMCPY_HOST_TO_DEVICE);
         if (ret != APP_ERR_OK) {
-            LogError << "Failed to execute aclrtMemcpy, ret = " << ret;
+            LogBinError("Failed to execute aclrtMemcpy, ret = {}", ret);
             return ret;
         }
         inputDataBuffers.push_back(yoloImgInfo);
@@ -49,6 +49,7 @@ public:
 
 protected:
     APP_ERROR Process(std::shared_ptr<void> inputData);
+    void BindOutputPorts();
 
 private:
     APP_ERROR InputBuffMalloc(std::shared_ptr<DvppDataInfo> &vpcData, std::vector<void *> &inputDataBuffers,
@@ -71,6 +72,9 @@ private:
     ModelProcess* modelProcess_ = nullptr;
 
     std::queue<std::vector<void *>> buffers_;
+    // size of every output of the model, Init runs again on the autoscaler thread when ModelInfer is scaled
+    std::vector<size_t> outputSizes_ = {};
+    ascendBaseModule::PortId postProcessPort_ = ascendBaseModule::INVALID_PORT_ID;
 };
 
 MODULE_REGIST(ModelInfer)
@@ -20,6 +20,7 @@
 #include <sys/time.h>
 #include "Singleton.h"
 #include "FileManager/FileManager.h"
+#include "Tracer/Tracer.h"
 
 
 using namespace ascendBaseModule;
@@ -42,6 +43,7 @@ APP_ERROR PostProcess::Init(ConfigParser &configParser, ModuleInitArgs &initArgs
     LogDebug << "Begin to init instance " << initArgs.instanceId;
 
     AssignInitArgs(initArgs);
+    ParseThresholds(configParser);
 
     for (int i = 0; i < BUFFER_SIZE; ++i) {
         std::vector<void *> temp;
@@ -57,9 +59,28 @@ APP_ERROR PostProcess::Init(ConfigParser &configParser, ModuleInitArgs &initArgs
         buffers_.push(temp);
     }
 
+    // registered once Init cannot fail, the callback uses this
+    WatchConfig({moduleName_ + ".scoreThresh", moduleName_ + ".iouThresh"},
+        [this](const ConfigParser &config) { ParseThresholds(config); });
     return APP_ERR_OK;
 }
 
+// optional, a value out of (0, 1) is ignored
+void PostProcess::ParseThresholds(const ConfigParser &configParser)
+{
+    float scoreThresh = SCORE_THRESH;
+    float iouThresh = IOU_THRESH;
+    configParser.GetFloatValue(moduleName_ + ".scoreThresh", scoreThresh);
+    configParser.GetFloatValue(moduleName_ + ".iouThresh", iouThresh);
+    if (scoreThresh <= 0 || scoreThresh >= 1 || iouThresh <= 0 || iouThresh >= 1) {
+        LogWarn << "PostProcess[" << instanceId_ << "]: invalid scoreThresh " << scoreThresh << " or iouThresh "
+                << iouThresh << ", " << scoreThresh_ << " and " << iouThresh_ << " are kept.";
+        return;
+    }
+    scoreThresh_ = scoreThresh;
+    iouThresh_ = iouThresh;
+}
+
 void PostProcess::ConstructData(std::vector<ObjDetectInfo> &objInfos, std::shared_ptr<DeviceStreamData> &dataToSend)
 {
     for (int k = 0; k < objInfos.size(); ++k) {
@@ -165,7 +186,8 @@ APP_ERROR PostProcess::GetObjectInfoCaffe(std::vector<RawData> &modelOutput,
         APP_ERROR ret = (APP_ERROR)aclrtMemcpy(hostPtrBuffer, modelOutput[j].lenOfByte, modelOutput[j].data.get(),
             modelOutput[j].lenOfByte, ACL_MEMCPY_DEVICE_TO_HOST);
         if (ret != APP_ERR_OK) {
-            LogError << "Failed to copy output buffer of model from device to host, ret = " << ret;
+            LogErrorLimited(AtlasAscendLog::LOG_FRAME_RATE_LIMIT)
+                << "Failed to copy output buffer of model from device to host, ret = " << ret;
             return ret;
         }
         hostPtr.push_back(hostPtrBufferManager);
@@ -182,6 +204,7 @@ APP_ERROR PostProcess::GetObjectInfoCaffe(std::vector<RawData> &modelOutput,
         objInfo.classId = ((float *)hostPtr[0].get())[objNum * (pos++) + k];
         objInfos.push_back(objInfo);
     }
+    FilterObjInfos(objInfos, scoreThresh_.load(std::memory_order_relaxed), iouThresh_.load(std::memory_order_relaxed));
     return APP_ERR_OK;
 }
 
@@ -198,18 +221,21 @@ APP_ERROR PostProcess::GetObjectInfoTensorflow(std::vector<RawData> &modelOutput
         APP_ERROR ret = (APP_ERROR)aclrtMemcpy(hostPtrBuffer, modelOutput[j].lenOfByte, modelOutput[j].data.get(),
             modelOutput[j].lenOfByte, ACL_MEMCPY_DEVICE_TO_HOST);
         if (ret != APP_ERR_OK) {
-            LogError << "Failed to copy output buffer of model from device to host, ret = " << ret;
+            LogErrorLimited(AtlasAscendLog::LOG_FRAME_RATE_LIMIT)
+                << "Failed to copy output buffer of model from device to host, ret = " << ret;
             return ret;
         }
         hostPtr.push_back(hostPtrBufferManager);
     }
-    Yolov3DetectionOutput(hostPtr, objInfos, yoloImageInfo_);
+    Yolov3DetectionOutput(hostPtr, objInfos, yoloImageInfo_, scoreThresh_.load(std::memory_order_relaxed),
+        iouThresh_.load(std::memory_order_relaxed));
     return APP_ERR_OK;
 }
 
 APP_ERROR PostProcess::Process(std::shared_ptr<void> inputData)
 {
     std::shared_ptr<CommonData> data = std::static_pointer_cast<CommonData>(inputData);
+    Tracer::SetFrame(data->channelId, data->frameId);
     if (data->eof) {
         Singleton::GetInstance().GetStopedStreamNum()++;
         if (Singleton::GetInstance().GetStopedStreamNum() == Singleton::GetInstance().GetStreamPullerNum()) {
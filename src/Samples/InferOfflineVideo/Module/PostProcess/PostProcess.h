@@ -39,11 +39,15 @@ private:
     APP_ERROR GetObjectInfoCaffe(std::vector<RawData> &modelOutput, std::vector<ObjDetectInfo> &objInfos);
     APP_ERROR GetObjectInfoTensorflow(std::vector<RawData> &modelOutput, std::vector<ObjDetectInfo> &objInfos);
     void ConstructData(std::vector<ObjDetectInfo> &objInfos, std::shared_ptr<DeviceStreamData> &dataToSend);
+    void ParseThresholds(const ConfigParser &configParser);
     APP_ERROR WebProcess(std::shared_ptr<DeviceStreamData>& inputData);
     APP_ERROR WriteResult(const std::vector<ObjDetectInfo> &objInfos, uint32_t channelId, uint32_t frameId);
 
     uint32_t modelType_ = 0;
     YoloImageInfo yoloImageInfo_;
+    // <moduleName>.scoreThresh and iouThresh, changed by the config watcher while the frames are processed
+    std::atomic<float> scoreThresh_ = {SCORE_THRESH};
+    std::atomic<float> iouThresh_ = {IOU_THRESH};
     std::queue<std::vector<void *>> buffers_;
 };
 
@@ -17,6 +17,7 @@
 #include <vector>
 #include "Yolov3Post.h"
 #include "FastMath.h"
+#include "Statistic/Statistic.h"
 
 /*
  * @description: Initialize the Yolo layer
@@ -72,14 +73,15 @@ float BoxIou(DetectBox a, DetectBox b)
                  erase the one with smaller confidence
  * @param dets  DetectBox vector where all DetectBoxes's confidences are greater than threshold
  * @param sortBoxes  DetectBox vector after filtering
+ * @param iouThresh  Non-Maximum Suppression threshold
  */
-void FilterByIou(std::vector<DetectBox> dets, std::vector<DetectBox>& sortBoxes)
+void FilterByIou(std::vector<DetectBox> dets, std::vector<DetectBox>& sortBoxes, float iouThresh)
 {
     for (unsigned int m = 0; m < dets.size(); ++m) {
         auto& item = dets[m];
         sortBoxes.push_back(item);
         for (unsigned int n = m + 1; n < dets.size(); ++n) {
-            if (BoxIou(item, dets[n]) > IOU_THRESH) {
+            if (BoxIou(item, dets[n]) > iouThresh) {
                 dets.erase(dets.begin() + n);
                 --n;
             }
@@ -90,8 +92,9 @@ void FilterByIou(std::vector<DetectBox> dets, std::vector<DetectBox>& sortBoxes)
 /*
  * @description: Sort the DetectBox for each class and filter out the DetectBox with same object using IOU
  * @param detBoxes  DetectBox vector where all DetectBoxes's confidences are greater than threshold
+ * @param iouThresh  Non-Maximum Suppression threshold
  */
-void NmsSort(std::vector<DetectBox>& detBoxes)
+void NmsSort(std::vector<DetectBox>& detBoxes, float iouThresh)
 {
     std::vector<DetectBox> sortBoxes;
     std::vector<std::vector<DetectBox>> resClass;
@@ -107,7 +110,7 @@ void NmsSort(std::vector<DetectBox>& detBoxes)
         std::sort(dets.begin(), dets.end(), [=](const DetectBox& a, const DetectBox& b) {
             return a.prob > b.prob;
         });
-        FilterByIou(dets, sortBoxes);
+        FilterByIou(dets, sortBoxes, iouThresh);
     }
     detBoxes = std::move(sortBoxes);
 }
@@ -158,9 +161,12 @@ void CompareProb(int& classID, float& maxProb, float classProb, int classNum)
  * @param detBoxes  DetectBox vector where all DetectBoxes's confidences are greater than threshold
  * @param stride  Stride of output feature data
  * @param layer  Yolo output layer
+ * @param scoreThresh  Threshold of confidence
  */
-void SelectClass(std::shared_ptr<void> netout, NetInfo info, std::vector<DetectBox>& detBoxes, int stride, OutputLayer layer)
+void SelectClass(std::shared_ptr<void> netout, NetInfo info, std::vector<DetectBox>& detBoxes, int stride,
+                 OutputLayer layer, float scoreThresh)
 {
+    PROBE("Yolov3Post.SelectClass");
     const int offsetY = 1;
     const int offsetWidth = 2;
     const int offsetHeight = 3;
@@ -178,7 +184,7 @@ void SelectClass(std::shared_ptr<void> netout, NetInfo info, std::vector<DetectB
                 continue;
             }
             int classID = -1;
-            float maxProb = SCORE_THRESH;
+            float maxProb = scoreThresh;
             float classProb;
             // Compare the confidence of the 3 anchors, select the largest one
             for (int c = 0; c < info.classNum; ++c) {
@@ -210,13 +216,15 @@ void SelectClass(std::shared_ptr<void> netout, NetInfo info, std::vector<DetectB
  * @param info  Yolo layer info which contains anchors dim, bbox dim, class number, net width, net height and
                 3 outputlayer(13*13, 26*26, 52*52)
  * @param detBoxes  DetectBox vector where all DetectBoxes's confidences are greater than threshold
+ * @param scoreThresh  Threshold of confidence
  */
-void GenerateBbox(std::vector<std::shared_ptr<void>> featLayerData, NetInfo info, std::vector<DetectBox>& detBoxes)
+void GenerateBbox(std::vector<std::shared_ptr<void>> featLayerData, NetInfo info, std::vector<DetectBox>& detBoxes,
+                  float scoreThresh)
 {
     for (const auto& layer : info.outputLayers) {
         int stride = layer.width * layer.height; // 13*13 26*26 52*52
         std::shared_ptr<void> netout = featLayerData[layer.layerIdx];
-        SelectClass(netout, info, detBoxes, stride, layer);
+        SelectClass(netout, info, detBoxes, stride, layer, scoreThresh);
     }
 }
 
@@ -226,11 +234,13 @@ void GenerateBbox(std::vector<std::shared_ptr<void>> featLayerData, NetInfo info
  * @param objInfos  DetectBox vector after transformation
  * @param originWidth  Real image width
  * @param originHeight  Real image height
+ * @param scoreThresh  Threshold of confidence
  */
-void GetObjInfos(const std::vector<DetectBox>& detBoxes, std::vector<ObjDetectInfo>& objInfos, int originWidth, int originHeight)
+void GetObjInfos(const std::vector<DetectBox>& detBoxes, std::vector<ObjDetectInfo>& objInfos, int originWidth,
+                 int originHeight, float scoreThresh)
 {
     for (int k = 0; k < detBoxes.size(); k++) {
-        if ((detBoxes[k].prob <= SCORE_THRESH) || (detBoxes[k].classID < 0)) {
+        if ((detBoxes[k].prob <= scoreThresh) || (detBoxes[k].classID < 0)) {
             continue;
         }
         ObjDetectInfo objInfo;
@@ -256,18 +266,64 @@ void GetObjInfos(const std::vector<DetectBox>& detBoxes, std::vector<ObjDetectIn
  * @param netHeight  Model input height
  * @param imgWidth  Real image width
  * @param imgHeight  Real image height
+ * @param scoreThresh  Threshold of confidence
+ * @param iouThresh  Non-Maximum Suppression threshold
  */
 void Yolov3DetectionOutput(std::vector<std::shared_ptr<void>> featLayerData,
                            std::vector<ObjDetectInfo>& objInfos,
-                           YoloImageInfo imgInfo)
+                           YoloImageInfo imgInfo, float scoreThresh, float iouThresh)
 {
     static NetInfo netInfo;
     if (netInfo.outputLayers.empty()) {
         InitNetInfo(netInfo, imgInfo.modelWidth, imgInfo.modelHeight);
     }
     std::vector<DetectBox> detBoxes;
-    GenerateBbox(featLayerData, netInfo, detBoxes);
+    GenerateBbox(featLayerData, netInfo, detBoxes, scoreThresh);
     CorrectBbox(detBoxes, imgInfo.modelWidth, imgInfo.modelHeight, imgInfo.imgWidth, imgInfo.imgHeight);
-    NmsSort(detBoxes);
-    GetObjInfos(detBoxes, objInfos, imgInfo.imgWidth, imgInfo.imgHeight);
+    NmsSort(detBoxes, iouThresh);
+    GetObjInfos(detBoxes, objInfos, imgInfo.imgWidth, imgInfo.imgHeight, scoreThresh);
+}
+
+/*
+ * @description: Filter the boxes of a model with its own detection output operator again on the host, the ones under
+                 scoreThresh are dropped and Non-Maximum Suppression is run at iouThresh; the thresholds the model
+                 was converted with still apply, the filter can only raise the first and lower the second
+ * @param objInfos  Boxes read from the model output, filtered in place
+ * @param scoreThresh  Threshold of confidence
+ * @param iouThresh  Non-Maximum Suppression threshold
+ */
+void FilterObjInfos(std::vector<ObjDetectInfo>& objInfos, float scoreThresh, float iouThresh)
+{
+    std::vector<DetectBox> detBoxes;
+    std::vector<ObjDetectInfo> unknownClasses; // out of the classes of NmsSort, kept as they are
+    for (const auto& objInfo : objInfos) {
+        int classID = static_cast<int>(objInfo.classId);
+        if (objInfo.confidence <= scoreThresh) {
+            continue;
+        }
+        if (classID < 0 || classID >= CLASS_NUM) {
+            unknownClasses.push_back(objInfo);
+            continue;
+        }
+        DetectBox det = {};
+        det.prob = objInfo.confidence;
+        det.classID = classID;
+        det.width = objInfo.rightBotX - objInfo.leftTopX;
+        det.height = objInfo.rightBotY - objInfo.leftTopY;
+        det.x = objInfo.leftTopX + det.width / COORDINATE_PARAM;
+        det.y = objInfo.leftTopY + det.height / COORDINATE_PARAM;
+        detBoxes.push_back(det);
+    }
+    NmsSort(detBoxes, iouThresh);
+    objInfos = std::move(unknownClasses);
+    for (const auto& det : detBoxes) {
+        ObjDetectInfo objInfo;
+        objInfo.classId = det.classID;
+        objInfo.confidence = det.prob;
+        objInfo.leftTopX = det.x - det.width / COORDINATE_PARAM;
+        objInfo.leftTopY = det.y - det.height / COORDINATE_PARAM;
+        objInfo.rightBotX = det.x + det.width / COORDINATE_PARAM;
+        objInfo.rightBotY = det.y + det.height / COORDINATE_PARAM;
+        objInfos.push_back(objInfo);
+    }
 }
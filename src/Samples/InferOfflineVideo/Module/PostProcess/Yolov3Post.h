@@ -25,9 +25,9 @@ const int CLASS_NUM = 80;
 const int DEPTH = 255; // (4(box: x, y, h, w) + 1(confidence) + 80(classNum)) * 3(anchorNum)
 const int BIASES_NUM = 18; // Yolov3 anchors, generate from train data, coco dataset
 const float BIASES[BIASES_NUM] = {10, 13, 16, 30, 33, 23, 30, 61, 62, 45, 59, 119, 116, 90, 156, 198, 373, 326};
-const float SCORE_THRESH = 0.3; // Threshold of confidence
+const float SCORE_THRESH = 0.3; // Threshold of confidence, PostProcess.scoreThresh
 const float OBJECTNESS_THRESH = 0.3; // Threshold of objectness value
-const float IOU_THRESH = 0.45; // Non-Maximum Suppression threshold
+const float IOU_THRESH = 0.45; // Non-Maximum Suppression threshold, PostProcess.iouThresh
 const float COORDINATE_PARAM = 2.0;
 const int YOLO_TYPE = 3;
 const int ANCHOR_DIM = 3;
@@ -72,6 +72,9 @@ struct ObjDetectInfo {
 // Realize the Yolo layer to get detiction object info
 void Yolov3DetectionOutput(std::vector<std::shared_ptr<void>> featLayerData,
                            std::vector<ObjDetectInfo> &objInfos,
-                           YoloImageInfo imgInfo);
+                           YoloImageInfo imgInfo, float scoreThresh = SCORE_THRESH, float iouThresh = IOU_THRESH);
+
+// Filter again the boxes of a model which has its own detection output operator (YoloV3 Caffe)
+void FilterObjInfos(std::vector<ObjDetectInfo> &objInfos, float scoreThresh, float iouThresh);
 
 #endif
@@ -20,6 +20,7 @@
 #include <iostream>
 #include <atomic>
 #include "Log/Log.h"
+#include "Log/BinaryLog.h"
 #include <unistd.h>
 #include "VideoDecoder/VideoDecoder.h"
 #include "Singleton.h"
@@ -79,6 +80,11 @@ APP_ERROR StreamPuller::DeInit(void)
     return APP_ERR_OK;
 }
 
+void StreamPuller::BindOutputPorts()
+{
+    videoDecoderPort_ = GetOutputPort(MT_VideoDecoder);
+}
+
 APP_ERROR StreamPuller::Process(std::shared_ptr<void> inputData)
 {
     int failureNum = 0;
@@ -193,15 +199,16 @@ void StreamPuller::PullStreamDataLoop()
                 std::shared_ptr<FrameData> frameData = std::make_shared<FrameData>();
                 frameData->frameInfo = frameInfo_;
                 frameData->frameInfo.eof = true;
-                SendToNextModule(MT_VideoDecoder, frameData, frameData->frameInfo.channelId);
+                uint32_t channelId = frameData->frameInfo.channelId;
+                SendToPort(videoDecoderPort_, std::move(frameData), channelId);
                 break;
             }
-            LogInfo << "StreamPuller [" << instanceId_ << "]: channel Read frame failed, continue";
+            LogBinInfo("StreamPuller [{}]: channel Read frame failed, continue", instanceId_);
             av_packet_unref(&pkt);
             continue;
         } else if (pkt.stream_index == videoStream_) {
             if (pkt.size <= 0) {
-                LogError << "Invalid pkt.size: " << pkt.size;
+                LogBinError("Invalid pkt.size: {}", pkt.size);
                 av_packet_unref(&pkt);
                 continue;
             }
@@ -213,7 +220,8 @@ void StreamPuller::PullStreamDataLoop()
             frameData->frameInfo.eof = false;
             frameData->streamData.data.reset(dataBuffer, free);
             frameData->streamData.size = pkt.size;
-            SendToNextModule(MT_VideoDecoder, frameData, frameData->frameInfo.channelId);
+            uint32_t channelId = frameData->frameInfo.channelId;
+            SendToPort(videoDecoderPort_, std::move(frameData), channelId);
             frameInfo_.frameId++;
         }
         av_packet_unref(&pkt);
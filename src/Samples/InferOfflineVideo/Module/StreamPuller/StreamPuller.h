@@ -36,6 +36,7 @@ public:
 
 protected:
     APP_ERROR Process(std::shared_ptr<void> inputData);
+    void BindOutputPorts();
 
 private:
     APP_ERROR ParseConfig(ConfigParser &configParser);
@@ -49,6 +50,7 @@ private:
     FrameInfo frameInfo_;
     std::string streamName_;
     AVFormatContext *pFormatCtx_ = nullptr;
+    ascendBaseModule::PortId videoDecoderPort_ = ascendBaseModule::INVALID_PORT_ID;
 };
 
 MODULE_REGIST(StreamPuller)
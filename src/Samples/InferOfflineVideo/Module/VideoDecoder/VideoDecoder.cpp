@@ -19,7 +19,9 @@
 #include "ErrorCode/ErrorCode.h"
 #include "VideoDecoder/VideoDecoder.h"
 #include "Log/Log.h"
+#include "Log/BinaryLog.h"
 #include "FileManager/FileManager.h"
+#include "Tracer/Tracer.h"
 #include "ModelInfer/ModelInfer.h"
 #include <sys/time.h>
 
@@ -41,20 +43,20 @@ void VideoDecoder::VideoDecoderCallBack(acldvppStreamDesc *input, acldvppPicDesc
     void *dataDev = acldvppGetStreamDescData(input);
     APP_ERROR ret = (APP_ERROR)acldvppFree(dataDev);
     if (ret != APP_ERR_OK) {
-        LogError << "fail to free input stream desc dataDev";
+        LogBinError("fail to free input stream desc dataDev");
     }
     ret = (APP_ERROR)acldvppDestroyStreamDesc(input);
     if (ret != APP_ERR_OK) {
-        LogError << "fail to destroy input stream desc";
+        LogBinError("fail to destroy input stream desc");
     }
 
     DecodeInfo *decodeInfo = (DecodeInfo *)userdata;
     if (decodeInfo == nullptr) {
-        LogError << "VideoDecoder: user data is nullptr";
+        LogBinError("VideoDecoder: user data is nullptr");
         return;
     }
     VideoDecoder* videoDecoder = decodeInfo->videoDecoder;
-    if (videoDecoder->frameId % videoDecoder->skipInterval_ == 0) {
+    if (videoDecoder->frameId % videoDecoder->skipInterval_.load(std::memory_order_relaxed) == 0) {
         std::shared_ptr<DvppDataInfo> temp = std::make_shared<DvppDataInfo>();
         temp->height = decodeInfo->frameInfo.height;
         temp->width = decodeInfo->frameInfo.width;
@@ -76,13 +78,16 @@ void VideoDecoder::VideoDecoderCallBack(acldvppStreamDesc *input, acldvppPicDesc
         toNext->srcImageHeight = decodeInfo->frameInfo.height;
         toNext->frameId = videoDecoder->frameId;
         toNext->dvppData = std::move(temp);
-        videoDecoder->SendToNextModule(MT_ModelInfer, toNext, toNext->channelId);
+        uint32_t channelId = toNext->channelId;
+        videoDecoder->SendToPort(videoDecoder->modelInferPort_, std::move(toNext), channelId);
+        LogBinDebug("VideoDecoder [{}]: channel {} frame {} decoded and resized", videoDecoder->instanceId_,
+            channelId, videoDecoder->frameId);
     }
     videoDecoder->frameId++;
     acldvppFree(acldvppGetPicDescData(output));
     ret = (APP_ERROR)acldvppDestroyPicDesc(output);
     if (ret != APP_ERR_OK) {
-        LogError << "Fail to destroy pic desc";
+        LogBinError("Fail to destroy pic desc");
     }
     delete decodeInfo;
 }
@@ -100,6 +105,8 @@ void *VideoDecoder::DecoderThread(void *arg)
         LogError << "Failed to set context, ret = " << ret;
         return ((void *)(-1));
     }
+    ApplyThreadPolicy(videoDecoder->threadPolicy_, "VideoDecoder[" + std::to_string(videoDecoder->instanceId_) +
+        "] DecoderThread");
 
     LogInfo << "DecoderThread start";
     while (!videoDecoder->stopDecoderThread_) {
@@ -160,6 +167,17 @@ APP_ERROR VideoDecoder::Init(ConfigParser &configParser, ModuleInitArgs &initArg
         return ret;
     }
 
+    // raising skipInterval sheds the load of the channels without a restart; registered once Init cannot fail, the
+    // callback uses this
+    WatchConfig({"skipInterval"}, [this](const ConfigParser &config) {
+        uint32_t skipInterval = 0;
+        if (config.GetUnsignedIntValue("skipInterval", skipInterval) != APP_ERR_OK || skipInterval == 0) {
+            LogWarn << "VideoDecoder[" << instanceId_ << "]: invalid skipInterval, " << skipInterval_ << " is kept.";
+            return;
+        }
+        skipInterval_ = skipInterval;
+    });
+
     LogDebug << "VideoDecoder [" << instanceId_ << "] Init success";
     return APP_ERR_OK;
 }
@@ -188,15 +206,17 @@ APP_ERROR VideoDecoder::ParseConfig(ConfigParser &configParser)
     }
 
     itemCfgStr = std::string("skipInterval");
-    ret = configParser.GetUnsignedIntValue(itemCfgStr, skipInterval_);
+    uint32_t skipInterval = 0;
+    ret = configParser.GetUnsignedIntValue(itemCfgStr, skipInterval);
     if (ret != APP_ERR_OK) {
         LogError << "VideoDecoder[" << instanceId_ << "]: Fail to get config variable named " << itemCfgStr << ".";
         return ret;
     }
-    if (skipInterval_ == 0) {
+    if (skipInterval == 0) {
         LogError << "The value of skipInterval_ must be greater than 0";
         return APP_ERR_ACL_FAILURE;
     }
+    skipInterval_ = skipInterval;
 
     return ret;
 }
@@ -220,19 +240,26 @@ APP_ERROR VideoDecoder::CreateVdecDvppCommon(acldvppStreamFormat format)
     return ret;
 }
 
+void VideoDecoder::BindOutputPorts()
+{
+    modelInferPort_ = GetOutputPort(MT_ModelInfer);
+}
+
 APP_ERROR VideoDecoder::Process(std::shared_ptr<void> inputData)
 {
     std::shared_ptr<FrameData> frameData = std::static_pointer_cast<FrameData>(inputData);
+    Tracer::SetFrame(frameData->frameInfo.channelId, frameData->frameInfo.frameId);
     if (frameData->frameInfo.eof) {
         APP_ERROR ret = vdecDvppCommon_->VdecSendEosFrame();
         if (ret != APP_ERR_OK) {
-            LogError << "Failed to send eos frame, ret = " << ret;
+            LogBinError("Failed to send eos frame, ret = {}", ret);
             return ret;
         }
         std::shared_ptr<DvppDataInfoT> toNext = std::make_shared<DvppDataInfoT>();
         toNext->eof = true;
         toNext->channelId = frameData->frameInfo.channelId;
-        SendToNextModule(MT_ModelInfer, toNext, toNext->channelId);
+        uint32_t channelId = toNext->channelId;
+        SendToPort(modelInferPort_, std::move(toNext), channelId);
         return APP_ERR_OK;
     }
     streamWidth_ = frameData->frameInfo.width;
@@ -241,7 +268,7 @@ APP_ERROR VideoDecoder::Process(std::shared_ptr<void> inputData)
     if (vdecDvppCommon_ == nullptr) {
         APP_ERROR ret = CreateVdecDvppCommon(frameData->frameInfo.format);
         if (ret != APP_ERR_OK) {
-            LogError << "CreateVdecDvppCommon Failed";
+            LogBinError("CreateVdecDvppCommon Failed");
             return ret;
         }
     }
@@ -256,7 +283,7 @@ APP_ERROR VideoDecoder::Process(std::shared_ptr<void> inputData)
 
     APP_ERROR ret = vdecDvppCommon_->CombineVdecProcess(vdecData, decodeInfo);
     if (ret != APP_ERR_OK) {
-        LogError << "Failed to do VdecProcess, ret = " << ret;
+        LogBinError("Failed to do VdecProcess, ret = {}", ret);
         return ret;
     }
 
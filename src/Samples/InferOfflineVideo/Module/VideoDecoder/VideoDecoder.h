@@ -31,6 +31,7 @@ public:
 
 protected:
     APP_ERROR Process(std::shared_ptr<void> inputData);
+    void BindOutputPorts();
 
 private:
     APP_ERROR ParseConfig(ConfigParser &configParser);
@@ -47,12 +48,13 @@ private:
     uint32_t streamHeight_ = 0;
     uint32_t resizeWidth_ = 0;
     uint32_t resizeHeight_ = 0;
-    uint32_t skipInterval_ = 1;
+    std::atomic<uint32_t> skipInterval_ = {1}; // changed by the config watcher while the frames are decoded
 
     aclrtStream vpcDvppStream_ = nullptr;
     DvppCommon* vpcDvppCommon_ = nullptr;
     DvppCommon* vdecDvppCommon_ = nullptr;
     pthread_t decoderThreadId_;
+    ascendBaseModule::PortId modelInferPort_ = ascendBaseModule::INVALID_PORT_ID;
 };
 
 struct DecodeInfo {
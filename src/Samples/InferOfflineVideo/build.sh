@@ -47,6 +47,17 @@ function buildA500() {
     return ${ret}
 }
 
+# build program which runs on the host ACL stand-in, no NPU or Ascend toolkit needed
+function buildStub() {
+    path_build=$path_cur/build
+    preparePath $path_build
+    cmake -DCMAKE_BUILD_TYPE=$build_type -DASCEND_ACL_STUB=ON ..
+    make -j
+    ret=$?
+    cd ..
+    return ${ret}
+}
+
 # set ASCEND_VERSION to ascend-toolkit/latest when it was not specified by user
 if [ ! "${ASCEND_VERSION}" ]; then
     export ASCEND_VERSION=ascend-toolkit/latest
@@ -57,6 +68,8 @@ fi
 # build with different according to the parameter, default is A300
 if [ "$1" == "A500" ]; then
     buildA500
+elif [ "$1" == "stub" ]; then
+    buildStub
 else
     buildA300
 fi
@@ -44,10 +44,14 @@ ModuleDesc g_moduleDesc[MODULE_TYPE_COUNT] = {
     {MT_PostProcess, -1},
 };
 
+// VideoDecoder sends from its decoder callback thread and from its process thread, so it needs a MPMC ring
 ModuleConnectDesc g_connectDesc[MODULE_CONNECT_COUNT] = {
-    {MT_StreamPuller, MT_VideoDecoder, MODULE_CONNECT_CHANNEL},
-    {MT_VideoDecoder, MT_ModelInfer, MODULE_CONNECT_CHANNEL},
-    {MT_ModelInfer, MT_PostProcess, MODULE_CONNECT_CHANNEL},
+    {MT_StreamPuller, MT_VideoDecoder, MODULE_CONNECT_CHANNEL, MODULE_QUEUE_SPSC, MODULE_OVERLOAD_BLOCK, 0,
+        QUEUE_WAIT_DEFAULT, false},
+    {MT_VideoDecoder, MT_ModelInfer, MODULE_CONNECT_CHANNEL, MODULE_QUEUE_MPMC, MODULE_OVERLOAD_BLOCK, 0,
+        QUEUE_WAIT_DEFAULT, false},
+    {MT_ModelInfer, MT_PostProcess, MODULE_CONNECT_CHANNEL, MODULE_QUEUE_SPSC, MODULE_OVERLOAD_BLOCK, 0,
+        QUEUE_WAIT_DEFAULT, false},
 };
 
 void SigHandler(int signo)
@@ -77,6 +81,17 @@ APP_ERROR InitModuleManager(ModuleManager &moduleManager, std::string &configPat
         LogError << "Invalid channel count, ret = " << ret;
         return APP_ERR_COMM_INVALID_PARAM;
     }
+    // the frames of a channel go to any instance of a scaled ModelInfer and are sent on in order, a channel
+    // connection would keep them on one instance
+    uint32_t maxInstances = 0;
+    if (configParser.GetUnsignedIntValue(std::string(MT_ModelInfer) + ".maxInstances", maxInstances) == APP_ERR_OK &&
+        maxInstances > 0) {
+        for (auto &connectDesc : g_connectDesc) {
+            if (connectDesc.moduleRecv == MT_ModelInfer) {
+                connectDesc.connectType = MODULE_CONNECT_LEAST_LOADED_ORDERED;
+            }
+        }
+    }
     LogInfo << "ModuleManager: begin to init";
     ret = moduleManager.Init(configPath, aclConfigPath);
     if (ret != APP_ERR_OK) {
@@ -0,0 +1,268 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "CommandParser/CommandParser.h"
+#include "Log/BinaryLog.h"
+
+using namespace AtlasAscendLog;
+
+namespace {
+const int TIME_SIZE = 32;
+const int BYTES6 = 6;
+const uint64_t NS_PER_SECOND = 1000000000;
+const uint64_t NS_PER_US = 1000;
+const double SYNC_MAX_DRIFT = 0.01; // ticks per second between two sync blocks further from the start ones are ignored
+// the same as Log
+const std::vector<std::string> LEVEL_STRINGS = { "[Debug]", "[Info ]", "[Warn ]", "[Error]", "[Fatal]" };
+
+struct DecodedSite {
+    uint32_t level;
+    uint32_t line;
+    std::string file;
+    std::string function;
+    std::string format;
+};
+
+struct DecodedLine {
+    int64_t timeNs;
+    std::string text;
+};
+
+// reads the blocks of one file in order, the blocks of every start of BinaryLog begin with BINARY_BLOCK_START
+class LogDecoder {
+public:
+    bool Decode(const std::string &data, std::vector<DecodedLine> &lines)
+    {
+        size_t headSize = strlen(BINARY_LOG_MAGIC) + sizeof(uint8_t);
+        if (data.size() < headSize || data.compare(0, strlen(BINARY_LOG_MAGIC), BINARY_LOG_MAGIC) != 0) {
+            std::cout << "Not a binary log file." << std::endl;
+            return false;
+        }
+        if (static_cast<uint8_t>(data[strlen(BINARY_LOG_MAGIC)]) != BINARY_LOG_VERSION) {
+            std::cout << "Unsupported version " << static_cast<int>(data[strlen(BINARY_LOG_MAGIC)]) << "."
+                      << std::endl;
+            return false;
+        }
+        size_t pos = headSize;
+        while (pos < data.size()) {
+            uint8_t type = data[pos];
+            uint32_t size = 0;
+            if (data.size() - pos < sizeof(type) + sizeof(size)) {
+                break;
+            }
+            memcpy(&size, data.data() + pos + sizeof(type), sizeof(size));
+            pos += sizeof(type) + sizeof(size);
+            if (data.size() - pos < size) {
+                break;
+            }
+            DecodeBlock(type, data.data() + pos, size, lines);
+            pos += size;
+        }
+        if (pos < data.size()) {
+            // the process was killed while the block was written
+            std::cout << "The last block is truncated, " << data.size() - pos << " bytes ignored." << std::endl;
+        }
+        return true;
+    }
+
+private:
+    void DecodeBlock(uint8_t type, const char *data, uint32_t size, std::vector<DecodedLine> &lines)
+    {
+        switch (type) {
+            case BINARY_BLOCK_START:
+                memcpy(&startTicksPerSecond_, data, sizeof(startTicksPerSecond_));
+                memcpy(&utcOffset_, data + sizeof(startTicksPerSecond_), sizeof(utcOffset_));
+                ticksPerSecond_ = startTicksPerSecond_;
+                syncTsc_ = 0;
+                syncNs_ = 0;
+                sites_.clear();
+                break;
+            case BINARY_BLOCK_SYNC:
+                DecodeSync(data);
+                break;
+            case BINARY_BLOCK_SITE:
+                DecodeSite(data);
+                break;
+            case BINARY_BLOCK_RECORDS:
+                DecodeRecords(data, size, lines);
+                break;
+            case BINARY_BLOCK_DROPPED: {
+                uint64_t droppedNum = 0;
+                memcpy(&droppedNum, data, sizeof(droppedNum));
+                std::ostringstream ss;
+                ss << "[Warn ]" << FormatTime(syncNs_) << " " << droppedNum
+                   << " log records dropped, the ring of their thread was full";
+                lines.push_back({ static_cast<int64_t>(syncNs_), ss.str() });
+                break;
+            }
+            default:
+                std::cout << "Unknown block type " << static_cast<int>(type) << " skipped." << std::endl;
+                break;
+        }
+    }
+
+    // the ticks per second measured at start are replaced by the ones between this sync block and the one before,
+    // unless the realtime clock was set in between
+    void DecodeSync(const char *data)
+    {
+        uint64_t syncTsc = 0;
+        uint64_t syncNs = 0;
+        memcpy(&syncTsc, data, sizeof(syncTsc));
+        memcpy(&syncNs, data + sizeof(syncTsc), sizeof(syncNs));
+        if (syncNs_ != 0 && syncNs > syncNs_ && syncTsc > syncTsc_) {
+            double ticksPerSecond = (syncTsc - syncTsc_) / (static_cast<double>(syncNs - syncNs_) / NS_PER_SECOND);
+            if (std::fabs(ticksPerSecond - startTicksPerSecond_) <= startTicksPerSecond_ * SYNC_MAX_DRIFT) {
+                ticksPerSecond_ = ticksPerSecond;
+            }
+        }
+        syncTsc_ = syncTsc;
+        syncNs_ = syncNs;
+    }
+
+    void DecodeSite(const char *data)
+    {
+        uint32_t siteId = 0;
+        uint8_t level = 0;
+        DecodedSite site = {};
+        memcpy(&siteId, data, sizeof(siteId));
+        data += sizeof(siteId);
+        memcpy(&level, data, sizeof(level));
+        data += sizeof(level);
+        memcpy(&site.line, data, sizeof(site.line));
+        data += sizeof(site.line);
+        site.level = level;
+        site.file = ReadString(data);
+        site.function = ReadString(data);
+        site.format = ReadString(data);
+        sites_[siteId] = site;
+    }
+
+    void DecodeRecords(const char *data, uint32_t size, std::vector<DecodedLine> &lines)
+    {
+        const char *end = data + size;
+        while (data < end) {
+            uint32_t siteId = 0;
+            uint64_t tsc = 0;
+            uint8_t argNum = 0;
+            memcpy(&siteId, data, sizeof(siteId));
+            data += sizeof(siteId);
+            memcpy(&tsc, data, sizeof(tsc));
+            data += sizeof(tsc);
+            memcpy(&argNum, data, sizeof(argNum));
+            data += sizeof(argNum);
+            const char *args = data;
+            for (uint8_t i = 0; i < argNum; i++) {
+                data += GetBinaryArgSize(data);
+            }
+            // the tsc may be a little older than the sync block before it
+            double elapsed = static_cast<double>(static_cast<int64_t>(tsc - syncTsc_)) / ticksPerSecond_;
+            int64_t timeNs = static_cast<int64_t>(syncNs_) + std::llround(elapsed * NS_PER_SECOND);
+            auto site = sites_.find(siteId);
+            if (site == sites_.end()) {
+                lines.push_back({ timeNs, "[Error]" + FormatTime(timeNs) + " record of unknown site " +
+                    std::to_string(siteId) });
+                continue;
+            }
+            std::ostringstream ss;
+            ss << ((site->second.level < LEVEL_STRINGS.size()) ? LEVEL_STRINGS[site->second.level] : "[?????]")
+               << FormatTime(timeNs) << "[" << site->second.file << " " << site->second.function << ":"
+               << site->second.line << "] " << FormatBinaryRecord(site->second.format, args, argNum);
+            lines.push_back({ timeNs, ss.str() });
+        }
+    }
+
+    static std::string ReadString(const char *&data)
+    {
+        uint16_t length = 0;
+        memcpy(&length, data, sizeof(length));
+        data += sizeof(length);
+        std::string value(data, length);
+        data += length;
+        return value;
+    }
+
+    // [<date> <time>:<microseconds>] as Log prints it
+    std::string FormatTime(int64_t timeNs) const
+    {
+        time_t seconds = timeNs / static_cast<int64_t>(NS_PER_SECOND) + utcOffset_;
+        struct tm tmBuf = {};
+        char timeString[TIME_SIZE] = {0};
+        strftime(timeString, TIME_SIZE, "[%F %X:", gmtime_r(&seconds, &tmBuf));
+        std::ostringstream ss;
+        ss.fill('0');
+        ss << timeString << std::setw(BYTES6) << (timeNs % NS_PER_SECOND) / NS_PER_US << "]";
+        return ss.str();
+    }
+
+    double startTicksPerSecond_ = NS_PER_SECOND;
+    double ticksPerSecond_ = NS_PER_SECOND;
+    int32_t utcOffset_ = 0;
+    uint64_t syncTsc_ = 0;
+    uint64_t syncNs_ = 0;
+    std::map<uint32_t, DecodedSite> sites_ = {};
+};
+}
+
+int main(int argc, const char *argv[])
+{
+    CommandParser option;
+    option.AddOption("-i", "", "binary log file written by BinaryLog, ./logs/log_<date>.blog");
+    option.AddOption("-o", "", "text log file to write, the screen when empty");
+    option.ParseArgs(argc, argv);
+
+    std::string inputFile = option.GetStringOption("-i");
+    std::ifstream input(inputFile, std::ios::binary);
+    if (!input) {
+        std::cout << "Fail to open " << inputFile << "." << std::endl;
+        return 1;
+    }
+    std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    std::vector<DecodedLine> lines;
+    LogDecoder decoder;
+    if (!decoder.Decode(data, lines)) {
+        return 1;
+    }
+    // the rings of the threads are written one after the other, put their lines back in time order
+    std::stable_sort(lines.begin(), lines.end(),
+        [](const DecodedLine &left, const DecodedLine &right) { return left.timeNs < right.timeNs; });
+
+    std::string outputFile = option.GetStringOption("-o");
+    std::ofstream output;
+    if (!outputFile.empty()) {
+        output.open(outputFile);
+        if (!output) {
+            std::cout << "Fail to open " << outputFile << "." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream &stream = outputFile.empty() ? std::cout : output;
+    for (auto &line : lines) {
+        stream << line.text << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,481 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "CommandParser/CommandParser.h"
+
+namespace {
+const int KEY_WIDTH = 64;
+const int FIELD_WIDTH = 14;
+const int VALUE_WIDTH = 14;
+const int VALUE_PRECISION = 4;
+const int EXIT_REGRESSION = 1;
+const int EXIT_INVALID_INPUT = 2;
+const double PERCENT = 100.0;
+const std::string JSON_EXTENSION = ".jsonl";
+// the first columns of a csv row and the first keys of a json row, the measurements follow
+const std::vector<std::string> ROW_KEYS = { "time", "type", "name", "labels" };
+const std::vector<std::string> TIME_SUFFIXES = { "_ns", "_us", "_ms" };
+// columns of the histograms of the metrics, in the unit of the name of the metric
+const std::set<std::string> HISTOGRAM_COLUMNS = { "p50", "p90", "p99", "p999", "average", "max" };
+
+enum Direction {
+    DIRECTION_NONE = 0, // shown, never a regression
+    DIRECTION_LOWER,    // a latency
+    DIRECTION_HIGHER    // a throughput
+};
+
+struct Row {
+    std::string type;
+    std::string name;
+    std::string labels;
+    std::vector<std::pair<std::string, double>> values; // in the order of the file
+};
+
+// a record file of MetricsRecordFile, the last row of every type, name and labels is kept
+struct Run {
+    std::map<std::string, std::string> metadata;
+    std::map<std::string, Row> rows;
+    std::vector<std::string> keys; // in the order of their first row
+};
+
+bool EndsWith(const std::string &text, const std::string &suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool HasTimeSuffix(const std::string &text)
+{
+    for (auto &suffix : TIME_SUFFIXES) {
+        if (EndsWith(text, suffix)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// times are better lower and rates higher, except the rates of drops
+Direction GetDirection(const Row &row, const std::string &field)
+{
+    if (HasTimeSuffix(field) || (HISTOGRAM_COLUMNS.count(field) != 0 && HasTimeSuffix(row.name))) {
+        return DIRECTION_LOWER;
+    }
+    if (field == "tps" || EndsWith(field, "_per_s")) {
+        return (row.name.find("dropped") != std::string::npos) ? DIRECTION_LOWER : DIRECTION_HIGHER;
+    }
+    return DIRECTION_NONE;
+}
+
+std::string GetKey(const Row &row)
+{
+    return row.type + " " + row.name + (row.labels.empty() ? "" : "{" + row.labels + "}");
+}
+
+void AddRow(Run &run, const Row &row)
+{
+    std::string key = GetKey(row);
+    if (run.rows.find(key) == run.rows.end()) {
+        run.keys.push_back(key);
+    }
+    run.rows[key] = row;
+}
+
+// a flat json object as written by MetricsRecordFile: string and number values only
+class JsonLineParser {
+public:
+    explicit JsonLineParser(const std::string &line) : line_(line) {}
+
+    bool Parse(std::vector<std::pair<std::string, std::string>> &items)
+    {
+        SkipSpaces();
+        if (!Consume('{')) {
+            return false;
+        }
+        SkipSpaces();
+        if (Consume('}')) {
+            return true;
+        }
+        do {
+            std::string key;
+            std::string value;
+            SkipSpaces();
+            if (!ParseString(key)) {
+                return false;
+            }
+            SkipSpaces();
+            if (!Consume(':')) {
+                return false;
+            }
+            SkipSpaces();
+            if (!ParseValue(value)) {
+                return false;
+            }
+            items.push_back(std::make_pair(key, value));
+            SkipSpaces();
+        } while (Consume(','));
+        return Consume('}');
+    }
+
+private:
+    void SkipSpaces()
+    {
+        while (pos_ < line_.size() && isspace(static_cast<unsigned char>(line_[pos_]))) {
+            pos_++;
+        }
+    }
+
+    bool Consume(char c)
+    {
+        if (pos_ < line_.size() && line_[pos_] == c) {
+            pos_++;
+            return true;
+        }
+        return false;
+    }
+
+    bool ParseString(std::string &value)
+    {
+        const int unicodeLength = 4;
+        const int hexBase = 16;
+        if (!Consume('"')) {
+            return false;
+        }
+        while (pos_ < line_.size() && line_[pos_] != '"') {
+            char c = line_[pos_++];
+            if (c != '\\') {
+                value += c;
+                continue;
+            }
+            if (pos_ >= line_.size()) {
+                return false;
+            }
+            c = line_[pos_++];
+            if (c == 'u' && pos_ + unicodeLength <= line_.size()) {
+                // MetricsRecordFile escapes the control characters only
+                value += static_cast<char>(strtol(line_.substr(pos_, unicodeLength).c_str(), nullptr, hexBase));
+                pos_ += unicodeLength;
+            } else {
+                value += (c == 'n') ? '\n' : (c == 't') ? '\t' : (c == 'r') ? '\r' : c;
+            }
+        }
+        return Consume('"');
+    }
+
+    bool ParseValue(std::string &value)
+    {
+        if (pos_ < line_.size() && line_[pos_] == '"') {
+            return ParseString(value);
+        }
+        size_t end = line_.find_first_of(",}", pos_);
+        if (end == std::string::npos || end == pos_) {
+            return false;
+        }
+        value = line_.substr(pos_, end - pos_);
+        while (!value.empty() && isspace(static_cast<unsigned char>(value.back()))) {
+            value.pop_back();
+        }
+        pos_ = end;
+        return true;
+    }
+
+    const std::string &line_;
+    size_t pos_ = 0;
+};
+
+// the fields of a csv line, the quoted ones may hold commas and doubled quotes
+std::vector<std::string> SplitCsvLine(const std::string &line)
+{
+    std::vector<std::string> fields(1);
+    bool isQuoted = false;
+    for (size_t i = 0; i < line.size(); i++) {
+        char c = line[i];
+        if (isQuoted) {
+            if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+                fields.back() += c;
+                i++;
+            } else if (c == '"') {
+                isQuoted = false;
+            } else {
+                fields.back() += c;
+            }
+        } else if (c == '"') {
+            isQuoted = true;
+        } else if (c == ',') {
+            fields.push_back("");
+        } else if (c != '\r') {
+            fields.back() += c;
+        }
+    }
+    return fields;
+}
+
+bool ParseNumber(const std::string &text, double &value)
+{
+    if (text.empty()) {
+        return false;
+    }
+    char *end = nullptr;
+    value = strtod(text.c_str(), &end);
+    return end == text.c_str() + text.size();
+}
+
+bool LoadJsonLines(std::istream &input, Run &run)
+{
+    std::string line;
+    int lineNum = 0;
+    while (std::getline(input, line)) {
+        lineNum++;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        std::vector<std::pair<std::string, std::string>> items;
+        if (!JsonLineParser(line).Parse(items)) {
+            std::cout << "Invalid json at line " << lineNum << "." << std::endl;
+            return false;
+        }
+        std::map<std::string, std::string> keys(items.begin(), items.end());
+        if (keys["type"] == "run") {
+            for (auto &item : items) {
+                if (item.first != "type") {
+                    run.metadata[item.first] = item.second;
+                }
+            }
+            continue;
+        }
+        Row row = { keys["type"], keys["name"], keys["labels"], {} };
+        for (auto &item : items) {
+            double value = 0;
+            bool isRowKey = std::find(ROW_KEYS.begin(), ROW_KEYS.end(), item.first) != ROW_KEYS.end();
+            if (!isRowKey && ParseNumber(item.second, value)) {
+                row.values.push_back(std::make_pair(item.first, value));
+            }
+        }
+        AddRow(run, row);
+    }
+    return true;
+}
+
+bool LoadCsv(std::istream &input, Run &run)
+{
+    std::string line;
+    std::vector<std::string> header;
+    while (std::getline(input, line)) {
+        if (line.compare(0, 2, "# ") == 0) {
+            size_t equalPos = line.find('=');
+            if (equalPos != std::string::npos) {
+                run.metadata[line.substr(2, equalPos - 2)] = line.substr(equalPos + 1);
+            }
+            continue;
+        }
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        std::vector<std::string> fields = SplitCsvLine(line);
+        if (header.empty()) {
+            header = fields;
+            if (header.size() < ROW_KEYS.size() || !std::equal(ROW_KEYS.begin(), ROW_KEYS.end(), header.begin())) {
+                std::cout << "The csv header must start with time,type,name,labels." << std::endl;
+                return false;
+            }
+            continue;
+        }
+        fields.resize(header.size());
+        Row row = { fields[1], fields[2], fields[3], {} }; // type, name and labels after the time
+        for (size_t i = ROW_KEYS.size(); i < header.size(); i++) {
+            double value = 0;
+            if (ParseNumber(fields[i], value)) {
+                row.values.push_back(std::make_pair(header[i], value));
+            }
+        }
+        AddRow(run, row);
+    }
+    return true;
+}
+
+bool LoadRun(const std::string &fileName, Run &run)
+{
+    std::ifstream input(fileName);
+    if (!input) {
+        std::cout << "Fail to open " << fileName << "." << std::endl;
+        return false;
+    }
+    bool isJson = EndsWith(fileName, JSON_EXTENSION) || input.peek() == '{';
+    bool isLoaded = isJson ? LoadJsonLines(input, run) : LoadCsv(input, run);
+    if (isLoaded && run.rows.empty()) {
+        std::cout << "No row in " << fileName << "." << std::endl;
+        return false;
+    }
+    return isLoaded;
+}
+
+void PrintMetadata(const Run &base, const Run &next)
+{
+    std::set<std::string> keys;
+    for (auto &item : base.metadata) {
+        keys.insert(item.first);
+    }
+    for (auto &item : next.metadata) {
+        keys.insert(item.first);
+    }
+    if (keys.empty()) {
+        return;
+    }
+    std::cout << std::left << std::setw(FIELD_WIDTH * 2) << "run" << std::setw(KEY_WIDTH / 2) << "base" << "new"
+              << std::endl;
+    for (auto &key : keys) {
+        auto baseIter = base.metadata.find(key);
+        auto nextIter = next.metadata.find(key);
+        std::string baseValue = (baseIter == base.metadata.end()) ? "-" : baseIter->second;
+        std::string nextValue = (nextIter == next.metadata.end()) ? "-" : nextIter->second;
+        std::cout << std::setw(FIELD_WIDTH * 2) << key << std::setw(KEY_WIDTH / 2) << baseValue << nextValue
+                  << ((baseValue != nextValue) ? "  *" : "") << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+std::set<std::string> ParseFields(const std::string &text)
+{
+    std::set<std::string> fields;
+    std::stringstream ss(text);
+    std::string field;
+    while (std::getline(ss, field, ',')) {
+        if (!field.empty()) {
+            fields.insert(field);
+        }
+    }
+    return fields;
+}
+
+struct CompareSummary {
+    uint32_t comparedNum;
+    uint32_t regressionNum;
+    uint32_t improvementNum;
+    uint32_t missingNum;
+};
+
+// the verdict of one value: a change against its direction beyond the threshold is a regression; from 0 the
+// change has no percent, any rise is then beyond the threshold
+std::string CompareValue(Direction direction, double baseValue, double nextValue, double threshold,
+    CompareSummary &summary)
+{
+    if (direction == DIRECTION_NONE) {
+        return "";
+    }
+    summary.comparedNum++;
+    double change = 0;
+    if (baseValue != 0) {
+        change = (nextValue - baseValue) / std::fabs(baseValue) * PERCENT;
+    } else if (nextValue != 0) {
+        change = (nextValue > 0) ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity();
+    }
+    double worse = (direction == DIRECTION_LOWER) ? change : -change;
+    if (worse > threshold) {
+        summary.regressionNum++;
+        return "REGRESSION";
+    }
+    if (worse < -threshold) {
+        summary.improvementNum++;
+        return "improved";
+    }
+    return "";
+}
+
+void PrintValue(double value)
+{
+    std::ostringstream ss;
+    ss << std::setprecision(VALUE_PRECISION + 2) << value;
+    std::cout << std::setw(VALUE_WIDTH) << ss.str();
+}
+
+CompareSummary Compare(const Run &base, const Run &next, double threshold, const std::set<std::string> &fields)
+{
+    CompareSummary summary = {};
+    std::cout << std::left << std::setw(KEY_WIDTH) << "row" << std::setw(FIELD_WIDTH) << "field"
+              << std::setw(VALUE_WIDTH) << "base" << std::setw(VALUE_WIDTH) << "new" << std::setw(VALUE_WIDTH)
+              << "change(%)" << std::endl;
+    for (auto &key : base.keys) {
+        auto nextIter = next.rows.find(key);
+        if (nextIter == next.rows.end()) {
+            std::cout << std::setw(KEY_WIDTH) << key << "missing in the new run" << std::endl;
+            summary.missingNum++;
+            continue;
+        }
+        const Row &baseRow = base.rows.find(key)->second;
+        std::map<std::string, double> nextValues(nextIter->second.values.begin(), nextIter->second.values.end());
+        for (auto &baseValue : baseRow.values) {
+            Direction direction = GetDirection(baseRow, baseValue.first);
+            auto nextValue = nextValues.find(baseValue.first);
+            bool isSelected = fields.empty() ? direction != DIRECTION_NONE : fields.count(baseValue.first) != 0;
+            if (!isSelected || nextValue == nextValues.end()) {
+                continue;
+            }
+            std::string verdict = CompareValue(direction, baseValue.second, nextValue->second, threshold, summary);
+            std::cout << std::setw(KEY_WIDTH) << key << std::setw(FIELD_WIDTH) << baseValue.first;
+            PrintValue(baseValue.second);
+            PrintValue(nextValue->second);
+            if (baseValue.second == 0) {
+                std::cout << std::setw(VALUE_WIDTH) << "-";
+            } else {
+                std::ostringstream change;
+                change << std::showpos << std::fixed << std::setprecision(2)
+                       << (nextValue->second - baseValue.second) / std::fabs(baseValue.second) * PERCENT;
+                std::cout << std::setw(VALUE_WIDTH) << change.str();
+            }
+            std::cout << verdict << std::endl;
+        }
+    }
+    return summary;
+}
+}
+
+int main(int argc, const char *argv[])
+{
+    CommandParser option;
+    option.AddOption("-base", "", "record file of the reference run, JSON Lines (.jsonl) or CSV");
+    option.AddOption("-new", "", "record file of the run to check, JSON Lines (.jsonl) or CSV");
+    option.AddOption("-threshold", "5", "change in percent beyond which a worse latency or throughput is flagged");
+    option.AddOption("-fields", "", "fields to compare separated by commas, the latencies and throughputs when empty");
+    option.AddOption("-allow_missing", "false", "the rows of the reference run missing in the new run are no failure");
+    option.ParseArgs(argc, argv);
+
+    Run base;
+    Run next;
+    if (!LoadRun(option.GetStringOption("-base"), base) || !LoadRun(option.GetStringOption("-new"), next)) {
+        return EXIT_INVALID_INPUT;
+    }
+    double threshold = option.GetDoubleOption("-threshold");
+    PrintMetadata(base, next);
+    CompareSummary summary = Compare(base, next, threshold, ParseFields(option.GetStringOption("-fields")));
+    std::cout << std::endl << summary.comparedNum << " values compared, " << summary.regressionNum
+              << " regressions and " << summary.improvementNum << " improvements beyond " << threshold << "%";
+    if (summary.missingNum != 0) {
+        std::cout << ", " << summary.missingNum << " rows missing in the new run";
+    }
+    std::cout << "." << std::endl;
+    bool isMissingFailed = summary.missingNum != 0 && !option.GetBoolOption("-allow_missing");
+    return (summary.regressionNum == 0 && !isMissingFailed) ? 0 : EXIT_REGRESSION;
+}
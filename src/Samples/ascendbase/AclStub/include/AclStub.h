@@ -0,0 +1,55 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_ACL_STUB_H
+#define INC_ACL_STUB_H
+
+#include "acl/acl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// engines of the NPU whose work is simulated by the stand-in
+typedef enum {
+    ACL_STUB_MODEL = 0, // aclmdlExecute and aclmdlExecuteAsync
+    ACL_STUB_VDEC,      // aclvdecSendFrame
+    ACL_STUB_VPC,       // acldvppVpcResizeAsync, acldvppVpcCropAsync and acldvppVpcCropAndPasteAsync
+    ACL_STUB_JPEGD,     // acldvppJpegDecodeAsync
+    ACL_STUB_JPEGE,     // acldvppJpegEncodeAsync
+    ACL_STUB_ENGINE_COUNT
+} aclStubEngine;
+
+// called by aclmdlExecute instead of the latency sleep, its return value is the one of aclmdlExecute
+typedef aclError (*aclStubModelCallback)(uint32_t modelId, const aclmdlDataset *input, aclmdlDataset *output,
+    void *userData);
+
+// time one task of the engine takes, the calling thread or the stream sleeps for it,
+// ACL_STUB_<ENGINE>_LATENCY_US in the environment sets it at startup, 0 by default
+void aclStubSetLatency(aclStubEngine engine, uint32_t latencyUs);
+uint32_t aclStubGetLatency(aclStubEngine engine);
+// nullptr restores the latency sleep
+void aclStubSetModelCallback(aclStubModelCallback callback, void *userData);
+// input and output sizes of the models loaded afterwards, ACL_STUB_MODEL_INPUT_SIZES and
+// ACL_STUB_MODEL_OUTPUT_SIZES in the environment set them at startup as comma separated byte counts,
+// the YoloV3 caffe model of InferOfflineVideo at 416x416 by default
+aclError aclStubSetModelIo(const size_t *inputSizes, size_t inputNum, const size_t *outputSizes, size_t outputNum);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
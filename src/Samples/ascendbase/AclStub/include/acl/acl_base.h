@@ -0,0 +1,82 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_ACL_STUB_ACL_BASE_H
+#define INC_ACL_STUB_ACL_BASE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// host stand-in of the ACL, the error codes are the ones mirrored by APP_ERR_ACL_* in ErrorCode.h
+typedef int aclError;
+
+static const int ACL_ERROR_NONE = 0;
+static const int ACL_ERROR_FAILURE = -1;
+static const int ACL_ERROR_INVALID_PARAM = 1;
+static const int ACL_ERROR_BAD_ALLOC = 2;
+static const int ACL_ERROR_RT_FAILURE = 3;
+static const int ACL_ERROR_READ_MODEL_FAILURE = 7;
+static const int ACL_ERROR_PARSE_MODEL = 8;
+static const int ACL_ERROR_REPEAT_INITIALIZE = 15;
+static const int ACL_ERROR_INVALID_FILE = 18;
+static const int ACL_ERROR_API_NOT_SUPPORT = 25;
+static const int ACL_ERROR_CREATE_DATA_BUF_FAILED = 26;
+
+typedef enum {
+    ACL_DT_UNDEFINED = -1,
+    ACL_FLOAT = 0,
+    ACL_FLOAT16 = 1,
+    ACL_INT8 = 2,
+    ACL_INT32 = 3,
+    ACL_UINT8 = 4,
+    ACL_INT16 = 6,
+    ACL_UINT16 = 7,
+    ACL_UINT32 = 8,
+    ACL_INT64 = 9,
+    ACL_UINT64 = 10,
+    ACL_DOUBLE = 11,
+    ACL_BOOL = 12
+} aclDataType;
+
+typedef enum {
+    ACL_FORMAT_UNDEFINED = -1,
+    ACL_FORMAT_NCHW = 0,
+    ACL_FORMAT_NHWC = 1,
+    ACL_FORMAT_ND = 2,
+    ACL_FORMAT_NC1HWC0 = 3,
+    ACL_FORMAT_FRACTAL_Z = 4
+} aclFormat;
+
+// memory address and size of one input or output of a model
+typedef struct aclDataBuffer aclDataBuffer;
+
+aclError aclInit(const char *configPath);
+aclError aclFinalize();
+
+aclDataBuffer *aclCreateDataBuffer(void *data, size_t size);
+aclError aclDestroyDataBuffer(const aclDataBuffer *dataBuffer);
+void *aclGetDataBufferAddr(const aclDataBuffer *dataBuffer);
+uint32_t aclGetDataBufferSize(const aclDataBuffer *dataBuffer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,570 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <memory>
+#include "acl/ops/acl_dvpp.h"
+#include "AclStubInner.h"
+
+namespace {
+const size_t DVPP_MEM_ALIGN = 128;
+const uint32_t JPEGD_ALIGN_WIDTH = 128;
+const uint32_t JPEGD_ALIGN_HEIGHT = 16;
+const uint8_t JPEG_MARKER = 0xff;
+const uint8_t JPEG_SOI = 0xd8;
+const uint8_t JPEG_SOF0 = 0xc0;
+const uint8_t JPEG_SOF15 = 0xcf;
+const uint8_t JPEG_DHT = 0xc4;
+const uint8_t JPEG_JPG = 0xc8;
+const uint8_t JPEG_DAC = 0xcc;
+const uint8_t JPEG_RST0 = 0xd0;
+const uint8_t JPEG_EOI = 0xd9;
+const uint8_t JPEG_TEM = 0x01;
+const uint32_t JPEG_SOF_SIZE = 8; // length, precision, height, width and components
+
+uint32_t AlignUp(uint32_t value, uint32_t align)
+{
+    return (value + align - 1) / align * align;
+}
+
+uint32_t ReadUint16(const uint8_t *data)
+{
+    return (static_cast<uint32_t>(data[0]) << 8) | data[1];
+}
+}
+
+struct acldvppPicDesc {
+    void *data;
+    uint32_t size;
+    acldvppPixelFormat format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t widthStride;
+    uint32_t heightStride;
+    uint32_t retCode;
+};
+
+struct acldvppStreamDesc {
+    void *data;
+    uint32_t size;
+    acldvppStreamFormat format;
+    uint64_t timestamp;
+    uint8_t eos;
+};
+
+struct acldvppChannelDesc {
+    bool isCreated;
+};
+
+struct acldvppRoiConfig {
+    uint32_t left;
+    uint32_t right;
+    uint32_t top;
+    uint32_t bottom;
+};
+
+struct acldvppResizeConfig {
+    uint32_t interpolation;
+};
+
+struct acldvppJpegeConfig {
+    uint32_t level;
+};
+
+struct aclvdecChannelDesc {
+    uint32_t channelId;
+    uint64_t threadId;
+    aclvdecCallback callback;
+    acldvppStreamFormat enType;
+    acldvppPixelFormat outPicFormat;
+    std::unique_ptr<aclStub::TaskWorker> worker; // set between aclvdecCreateChannel and aclvdecDestroyChannel
+};
+
+aclError acldvppMalloc(void **devPtr, size_t size)
+{
+    if (devPtr == nullptr || size == 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return (posix_memalign(devPtr, DVPP_MEM_ALIGN, size) == 0) ? ACL_ERROR_NONE : ACL_ERROR_BAD_ALLOC;
+}
+
+aclError acldvppFree(void *devPtr)
+{
+    if (devPtr == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    std::free(devPtr);
+    return ACL_ERROR_NONE;
+}
+
+acldvppPicDesc *acldvppCreatePicDesc()
+{
+    return new acldvppPicDesc();
+}
+
+aclError acldvppDestroyPicDesc(acldvppPicDesc *picDesc)
+{
+    if (picDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete picDesc;
+    return ACL_ERROR_NONE;
+}
+
+#define ACL_STUB_SET_FIELD(desc, field, value) \
+    do {                                       \
+        if ((desc) == nullptr) {               \
+            return ACL_ERROR_INVALID_PARAM;    \
+        }                                      \
+        (desc)->field = (value);               \
+        return ACL_ERROR_NONE;                 \
+    } while (0)
+
+aclError acldvppSetPicDescData(acldvppPicDesc *picDesc, void *dataDev)
+{
+    ACL_STUB_SET_FIELD(picDesc, data, dataDev);
+}
+
+aclError acldvppSetPicDescSize(acldvppPicDesc *picDesc, uint32_t size)
+{
+    ACL_STUB_SET_FIELD(picDesc, size, size);
+}
+
+aclError acldvppSetPicDescFormat(acldvppPicDesc *picDesc, acldvppPixelFormat format)
+{
+    ACL_STUB_SET_FIELD(picDesc, format, format);
+}
+
+aclError acldvppSetPicDescWidth(acldvppPicDesc *picDesc, uint32_t width)
+{
+    ACL_STUB_SET_FIELD(picDesc, width, width);
+}
+
+aclError acldvppSetPicDescHeight(acldvppPicDesc *picDesc, uint32_t height)
+{
+    ACL_STUB_SET_FIELD(picDesc, height, height);
+}
+
+aclError acldvppSetPicDescWidthStride(acldvppPicDesc *picDesc, uint32_t widthStride)
+{
+    ACL_STUB_SET_FIELD(picDesc, widthStride, widthStride);
+}
+
+aclError acldvppSetPicDescHeightStride(acldvppPicDesc *picDesc, uint32_t heightStride)
+{
+    ACL_STUB_SET_FIELD(picDesc, heightStride, heightStride);
+}
+
+void *acldvppGetPicDescData(const acldvppPicDesc *picDesc)
+{
+    return (picDesc == nullptr) ? nullptr : picDesc->data;
+}
+
+uint32_t acldvppGetPicDescSize(const acldvppPicDesc *picDesc)
+{
+    return (picDesc == nullptr) ? 0 : picDesc->size;
+}
+
+acldvppPixelFormat acldvppGetPicDescFormat(const acldvppPicDesc *picDesc)
+{
+    return (picDesc == nullptr) ? PIXEL_FORMAT_YUV_400 : picDesc->format;
+}
+
+uint32_t acldvppGetPicDescWidth(const acldvppPicDesc *picDesc)
+{
+    return (picDesc == nullptr) ? 0 : picDesc->width;
+}
+
+uint32_t acldvppGetPicDescHeight(const acldvppPicDesc *picDesc)
+{
+    return (picDesc == nullptr) ? 0 : picDesc->height;
+}
+
+uint32_t acldvppGetPicDescWidthStride(const acldvppPicDesc *picDesc)
+{
+    return (picDesc == nullptr) ? 0 : picDesc->widthStride;
+}
+
+uint32_t acldvppGetPicDescHeightStride(const acldvppPicDesc *picDesc)
+{
+    return (picDesc == nullptr) ? 0 : picDesc->heightStride;
+}
+
+uint32_t acldvppGetPicDescRetCode(const acldvppPicDesc *picDesc)
+{
+    return (picDesc == nullptr) ? 0 : picDesc->retCode;
+}
+
+acldvppStreamDesc *acldvppCreateStreamDesc()
+{
+    return new acldvppStreamDesc();
+}
+
+aclError acldvppDestroyStreamDesc(acldvppStreamDesc *streamDesc)
+{
+    if (streamDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete streamDesc;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetStreamDescData(acldvppStreamDesc *streamDesc, void *dataDev)
+{
+    ACL_STUB_SET_FIELD(streamDesc, data, dataDev);
+}
+
+aclError acldvppSetStreamDescSize(acldvppStreamDesc *streamDesc, uint32_t size)
+{
+    ACL_STUB_SET_FIELD(streamDesc, size, size);
+}
+
+aclError acldvppSetStreamDescFormat(acldvppStreamDesc *streamDesc, acldvppStreamFormat format)
+{
+    ACL_STUB_SET_FIELD(streamDesc, format, format);
+}
+
+aclError acldvppSetStreamDescTimestamp(acldvppStreamDesc *streamDesc, uint64_t timestamp)
+{
+    ACL_STUB_SET_FIELD(streamDesc, timestamp, timestamp);
+}
+
+aclError acldvppSetStreamDescEos(acldvppStreamDesc *streamDesc, uint8_t eos)
+{
+    ACL_STUB_SET_FIELD(streamDesc, eos, eos);
+}
+
+void *acldvppGetStreamDescData(const acldvppStreamDesc *streamDesc)
+{
+    return (streamDesc == nullptr) ? nullptr : streamDesc->data;
+}
+
+uint32_t acldvppGetStreamDescSize(const acldvppStreamDesc *streamDesc)
+{
+    return (streamDesc == nullptr) ? 0 : streamDesc->size;
+}
+
+acldvppStreamFormat acldvppGetStreamDescFormat(const acldvppStreamDesc *streamDesc)
+{
+    return (streamDesc == nullptr) ? H265_MAIN_LEVEL : streamDesc->format;
+}
+
+uint64_t acldvppGetStreamDescTimestamp(const acldvppStreamDesc *streamDesc)
+{
+    return (streamDesc == nullptr) ? 0 : streamDesc->timestamp;
+}
+
+uint8_t acldvppGetStreamDescEos(const acldvppStreamDesc *streamDesc)
+{
+    return (streamDesc == nullptr) ? 0 : streamDesc->eos;
+}
+
+acldvppRoiConfig *acldvppCreateRoiConfig(uint32_t left, uint32_t right, uint32_t top, uint32_t bottom)
+{
+    return new acldvppRoiConfig {left, right, top, bottom};
+}
+
+aclError acldvppDestroyRoiConfig(acldvppRoiConfig *roiConfig)
+{
+    if (roiConfig == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete roiConfig;
+    return ACL_ERROR_NONE;
+}
+
+acldvppResizeConfig *acldvppCreateResizeConfig()
+{
+    return new acldvppResizeConfig();
+}
+
+aclError acldvppDestroyResizeConfig(acldvppResizeConfig *resizeConfig)
+{
+    if (resizeConfig == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete resizeConfig;
+    return ACL_ERROR_NONE;
+}
+
+acldvppJpegeConfig *acldvppCreateJpegeConfig()
+{
+    return new acldvppJpegeConfig();
+}
+
+aclError acldvppDestroyJpegeConfig(acldvppJpegeConfig *jpegeConfig)
+{
+    if (jpegeConfig == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete jpegeConfig;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppSetJpegeConfigLevel(acldvppJpegeConfig *jpegeConfig, uint32_t level)
+{
+    ACL_STUB_SET_FIELD(jpegeConfig, level, level);
+}
+
+acldvppChannelDesc *acldvppCreateChannelDesc()
+{
+    return new acldvppChannelDesc();
+}
+
+aclError acldvppDestroyChannelDesc(acldvppChannelDesc *channelDesc)
+{
+    if (channelDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete channelDesc;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppCreateChannel(acldvppChannelDesc *channelDesc)
+{
+    ACL_STUB_SET_FIELD(channelDesc, isCreated, true);
+}
+
+aclError acldvppDestroyChannel(acldvppChannelDesc *channelDesc)
+{
+    ACL_STUB_SET_FIELD(channelDesc, isCreated, false);
+}
+
+namespace {
+aclError PushDvppTask(const acldvppChannelDesc *channelDesc, const void *input, acldvppPicDesc *outputDesc,
+    aclStubEngine engine, aclrtStream stream)
+{
+    if (channelDesc == nullptr || !channelDesc->isCreated || input == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return aclStub::PushTask(stream, [outputDesc, engine]() {
+        aclStub::SimulateLatency(engine);
+        if (outputDesc != nullptr) {
+            outputDesc->retCode = 0;
+        }
+    });
+}
+}
+
+aclError acldvppVpcResizeAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc,
+    acldvppPicDesc *outputDesc, acldvppResizeConfig *resizeConfig, aclrtStream stream)
+{
+    if (outputDesc == nullptr || resizeConfig == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return PushDvppTask(channelDesc, inputDesc, outputDesc, ACL_STUB_VPC, stream);
+}
+
+aclError acldvppVpcCropAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc,
+    acldvppPicDesc *outputDesc, acldvppRoiConfig *cropArea, aclrtStream stream)
+{
+    if (outputDesc == nullptr || cropArea == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return PushDvppTask(channelDesc, inputDesc, outputDesc, ACL_STUB_VPC, stream);
+}
+
+aclError acldvppVpcCropAndPasteAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc,
+    acldvppPicDesc *outputDesc, acldvppRoiConfig *cropArea, acldvppRoiConfig *pasteArea, aclrtStream stream)
+{
+    if (outputDesc == nullptr || cropArea == nullptr || pasteArea == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return PushDvppTask(channelDesc, inputDesc, outputDesc, ACL_STUB_VPC, stream);
+}
+
+aclError acldvppJpegGetImageInfo(const void *data, uint32_t size, uint32_t *width, uint32_t *height,
+    int32_t *components)
+{
+    const uint8_t *jpeg = static_cast<const uint8_t *>(data);
+    if (jpeg == nullptr || width == nullptr || height == nullptr || size < 2 || jpeg[0] != JPEG_MARKER ||
+        jpeg[1] != JPEG_SOI) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    uint32_t pos = 2;
+    while (pos + 1 < size) {
+        if (jpeg[pos] != JPEG_MARKER) {
+            return ACL_ERROR_INVALID_PARAM;
+        }
+        uint8_t marker = jpeg[pos + 1];
+        pos += 2;
+        if (marker == JPEG_MARKER) {
+            pos--; // fill byte
+            continue;
+        }
+        if (marker == JPEG_TEM || (marker >= JPEG_RST0 && marker <= JPEG_EOI)) {
+            continue; // no segment
+        }
+        if (pos + 2 > size) {
+            break;
+        }
+        uint32_t length = ReadUint16(jpeg + pos);
+        bool isSof = marker >= JPEG_SOF0 && marker <= JPEG_SOF15 && marker != JPEG_DHT && marker != JPEG_JPG &&
+            marker != JPEG_DAC;
+        if (isSof && length >= JPEG_SOF_SIZE && pos + JPEG_SOF_SIZE <= size) {
+            *height = ReadUint16(jpeg + pos + 3);
+            *width = ReadUint16(jpeg + pos + 5);
+            if (components != nullptr) {
+                *components = jpeg[pos + 7];
+            }
+            return ACL_ERROR_NONE;
+        }
+        pos += length;
+    }
+    return ACL_ERROR_INVALID_PARAM;
+}
+
+aclError acldvppJpegPredictDecSize(const void *data, uint32_t dataSize, acldvppPixelFormat outputPixelFormat,
+    uint32_t *decSize)
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    aclError ret = acldvppJpegGetImageInfo(data, dataSize, &width, &height, nullptr);
+    if (ret != ACL_ERROR_NONE || decSize == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    uint32_t planeSize = AlignUp(width, JPEGD_ALIGN_WIDTH) * AlignUp(height, JPEGD_ALIGN_HEIGHT);
+    switch (outputPixelFormat) {
+        case PIXEL_FORMAT_YUV_400:
+            *decSize = planeSize;
+            break;
+        case PIXEL_FORMAT_YUV_SEMIPLANAR_420:
+        case PIXEL_FORMAT_YVU_SEMIPLANAR_420:
+            *decSize = planeSize * 3 / 2; // 3 / 2: Y plane and UV plane of half size
+            break;
+        case PIXEL_FORMAT_YUV_SEMIPLANAR_422:
+        case PIXEL_FORMAT_YVU_SEMIPLANAR_422:
+            *decSize = planeSize * 2; // 2: Y plane and UV plane of the same size
+            break;
+        case PIXEL_FORMAT_YUV_SEMIPLANAR_444:
+        case PIXEL_FORMAT_YVU_SEMIPLANAR_444:
+            *decSize = planeSize * 3; // 3: Y plane and UV plane of twice the size
+            break;
+        default:
+            return ACL_ERROR_INVALID_PARAM;
+    }
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppJpegPredictEncSize(const acldvppPicDesc *inputDesc, const acldvppJpegeConfig *config,
+    uint32_t *size)
+{
+    if (inputDesc == nullptr || config == nullptr || size == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    // never more than the YUV420SP image
+    *size = inputDesc->widthStride * inputDesc->heightStride * 3 / 2;
+    return ACL_ERROR_NONE;
+}
+
+aclError acldvppJpegDecodeAsync(acldvppChannelDesc *channelDesc, const void *data, uint32_t size,
+    acldvppPicDesc *outputDesc, aclrtStream stream)
+{
+    if (outputDesc == nullptr || size == 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return PushDvppTask(channelDesc, data, outputDesc, ACL_STUB_JPEGD, stream);
+}
+
+aclError acldvppJpegEncodeAsync(acldvppChannelDesc *channelDesc, acldvppPicDesc *inputDesc, const void *data,
+    uint32_t *size, acldvppJpegeConfig *config, aclrtStream stream)
+{
+    if (data == nullptr || size == nullptr || config == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return PushDvppTask(channelDesc, inputDesc, nullptr, ACL_STUB_JPEGE, stream);
+}
+
+aclvdecChannelDesc *aclvdecCreateChannelDesc()
+{
+    return new aclvdecChannelDesc();
+}
+
+aclError aclvdecDestroyChannelDesc(aclvdecChannelDesc *channelDesc)
+{
+    if (channelDesc == nullptr || channelDesc->worker != nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete channelDesc;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclvdecSetChannelDescChannelId(aclvdecChannelDesc *channelDesc, uint32_t channelId)
+{
+    ACL_STUB_SET_FIELD(channelDesc, channelId, channelId);
+}
+
+aclError aclvdecSetChannelDescThreadId(aclvdecChannelDesc *channelDesc, uint64_t threadId)
+{
+    ACL_STUB_SET_FIELD(channelDesc, threadId, threadId);
+}
+
+aclError aclvdecSetChannelDescCallback(aclvdecChannelDesc *channelDesc, aclvdecCallback callback)
+{
+    ACL_STUB_SET_FIELD(channelDesc, callback, callback);
+}
+
+aclError aclvdecSetChannelDescEnType(aclvdecChannelDesc *channelDesc, acldvppStreamFormat enType)
+{
+    ACL_STUB_SET_FIELD(channelDesc, enType, enType);
+}
+
+aclError aclvdecSetChannelDescOutPicFormat(aclvdecChannelDesc *channelDesc, acldvppPixelFormat outPicFormat)
+{
+    ACL_STUB_SET_FIELD(channelDesc, outPicFormat, outPicFormat);
+}
+
+aclError aclvdecCreateChannel(aclvdecChannelDesc *channelDesc)
+{
+    if (channelDesc == nullptr || channelDesc->callback == nullptr || channelDesc->threadId == 0 ||
+        channelDesc->worker != nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    channelDesc->worker.reset(new aclStub::TaskWorker());
+    return ACL_ERROR_NONE;
+}
+
+aclError aclvdecDestroyChannel(aclvdecChannelDesc *channelDesc)
+{
+    if (channelDesc == nullptr || channelDesc->worker == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    channelDesc->worker.reset();
+    return ACL_ERROR_NONE;
+}
+
+aclError aclvdecSendFrame(aclvdecChannelDesc *channelDesc, acldvppStreamDesc *input, acldvppPicDesc *output,
+    aclvdecFrameConfig *config, void *userData)
+{
+    if (channelDesc == nullptr || channelDesc->worker == nullptr || input == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    if (input->eos != 0) {
+        channelDesc->worker->Synchronize();
+        return ACL_ERROR_NONE;
+    }
+    if (output == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    uint64_t threadId = channelDesc->threadId;
+    aclvdecCallback callback = channelDesc->callback;
+    channelDesc->worker->Push([threadId, callback, input, output, userData]() {
+        aclStub::SimulateLatency(ACL_STUB_VDEC);
+        output->retCode = 0;
+        aclStub::PostReport(threadId, [callback, input, output, userData]() { callback(input, output, userData); });
+    });
+    return ACL_ERROR_NONE;
+}
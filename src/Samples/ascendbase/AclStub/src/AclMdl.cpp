@@ -0,0 +1,285 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include "AclStubInner.h"
+
+namespace {
+const size_t MODEL_MEM_SIZE = 1024; // work and weight memory asked by aclmdlQuerySizeFromMem
+// YoloV3 caffe at 416x416: the YUV420SP image and the image info, the boxes and the box count
+const std::vector<size_t> DEFAULT_INPUT_SIZES = {416 * 416 * 3 / 2, 4 * sizeof(float)};
+const std::vector<size_t> DEFAULT_OUTPUT_SIZES = {6 * 1024 * sizeof(float), 8 * sizeof(uint32_t)};
+
+struct ModelIo {
+    std::vector<size_t> inputSizes;
+    std::vector<size_t> outputSizes;
+};
+
+std::mutex g_modelMutex;
+std::shared_ptr<const ModelIo> g_modelIo = nullptr; // given to the models loaded next
+std::map<uint32_t, std::shared_ptr<const ModelIo>> g_models;
+uint32_t g_nextModelId = 1;
+aclStubModelCallback g_modelCallback = nullptr;
+void *g_modelUserData = nullptr;
+
+std::vector<size_t> ParseSizes(const char *value, const std::vector<size_t> &defaultSizes)
+{
+    if (value == nullptr) {
+        return defaultSizes;
+    }
+    std::vector<size_t> sizes;
+    std::stringstream sizeStream(value);
+    std::string item;
+    while (std::getline(sizeStream, item, ',')) {
+        sizes.push_back(std::strtoul(item.c_str(), nullptr, 0));
+    }
+    return sizes;
+}
+
+// call with g_modelMutex held
+std::shared_ptr<const ModelIo> GetModelIo()
+{
+    if (g_modelIo == nullptr) {
+        std::shared_ptr<ModelIo> modelIo = std::make_shared<ModelIo>();
+        modelIo->inputSizes = ParseSizes(std::getenv("ACL_STUB_MODEL_INPUT_SIZES"), DEFAULT_INPUT_SIZES);
+        modelIo->outputSizes = ParseSizes(std::getenv("ACL_STUB_MODEL_OUTPUT_SIZES"), DEFAULT_OUTPUT_SIZES);
+        g_modelIo = modelIo;
+    }
+    return g_modelIo;
+}
+
+std::shared_ptr<const ModelIo> FindModel(uint32_t modelId)
+{
+    std::lock_guard<std::mutex> lock(g_modelMutex);
+    auto iter = g_models.find(modelId);
+    return (iter == g_models.end()) ? nullptr : iter->second;
+}
+
+aclError LoadModel(uint32_t *modelId)
+{
+    if (modelId == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(g_modelMutex);
+    *modelId = g_nextModelId++;
+    g_models[*modelId] = GetModelIo();
+    return ACL_ERROR_NONE;
+}
+
+aclError ExecuteModel(uint32_t modelId, const aclmdlDataset *input, aclmdlDataset *output)
+{
+    std::shared_ptr<const ModelIo> modelIo = FindModel(modelId);
+    if (modelIo == nullptr || input == nullptr || output == nullptr ||
+        input->buffers.size() != modelIo->inputSizes.size() ||
+        output->buffers.size() != modelIo->outputSizes.size()) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    aclStubModelCallback callback = nullptr;
+    void *userData = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_modelMutex);
+        callback = g_modelCallback;
+        userData = g_modelUserData;
+    }
+    if (callback != nullptr) {
+        return callback(modelId, input, output, userData);
+    }
+    aclStub::SimulateLatency(ACL_STUB_MODEL);
+    // no object found by the post processing
+    for (size_t i = 0; i < output->buffers.size(); i++) {
+        aclDataBuffer *buffer = output->buffers[i];
+        if (buffer->data != nullptr) {
+            std::memset(buffer->data, 0, std::min(buffer->size, modelIo->outputSizes[i]));
+        }
+    }
+    return ACL_ERROR_NONE;
+}
+}
+
+struct aclmdlDesc {
+    std::shared_ptr<const ModelIo> modelIo;
+};
+
+void aclStubSetModelCallback(aclStubModelCallback callback, void *userData)
+{
+    std::lock_guard<std::mutex> lock(g_modelMutex);
+    g_modelCallback = callback;
+    g_modelUserData = userData;
+}
+
+aclError aclStubSetModelIo(const size_t *inputSizes, size_t inputNum, const size_t *outputSizes, size_t outputNum)
+{
+    if ((inputSizes == nullptr && inputNum > 0) || (outputSizes == nullptr && outputNum > 0)) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    std::shared_ptr<ModelIo> modelIo = std::make_shared<ModelIo>();
+    modelIo->inputSizes.assign(inputSizes, inputSizes + inputNum);
+    modelIo->outputSizes.assign(outputSizes, outputSizes + outputNum);
+    std::lock_guard<std::mutex> lock(g_modelMutex);
+    g_modelIo = modelIo;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclmdlLoadFromFile(const char *modelPath, uint32_t *modelId)
+{
+    return (modelPath == nullptr) ? ACL_ERROR_INVALID_PARAM : LoadModel(modelId);
+}
+
+aclError aclmdlLoadFromMem(const void *model, size_t modelSize, uint32_t *modelId)
+{
+    return (model == nullptr || modelSize == 0) ? ACL_ERROR_INVALID_PARAM : LoadModel(modelId);
+}
+
+aclError aclmdlQuerySizeFromMem(const void *model, size_t modelSize, size_t *workSize, size_t *weightSize)
+{
+    if (model == nullptr || modelSize == 0 || workSize == nullptr || weightSize == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *workSize = MODEL_MEM_SIZE;
+    *weightSize = MODEL_MEM_SIZE;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclmdlLoadFromMemWithMem(const void *model, size_t modelSize, uint32_t *modelId, void *workPtr,
+    size_t workSize, void *weightPtr, size_t weightSize)
+{
+    return (model == nullptr || modelSize == 0) ? ACL_ERROR_INVALID_PARAM : LoadModel(modelId);
+}
+
+aclError aclmdlUnload(uint32_t modelId)
+{
+    std::lock_guard<std::mutex> lock(g_modelMutex);
+    return (g_models.erase(modelId) == 0) ? ACL_ERROR_INVALID_PARAM : ACL_ERROR_NONE;
+}
+
+aclError aclmdlExecute(uint32_t modelId, const aclmdlDataset *input, aclmdlDataset *output)
+{
+    return ExecuteModel(modelId, input, output);
+}
+
+aclError aclmdlExecuteAsync(uint32_t modelId, const aclmdlDataset *input, aclmdlDataset *output,
+    aclrtStream stream)
+{
+    if (FindModel(modelId) == nullptr || input == nullptr || output == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return aclStub::PushTask(stream, [modelId, input, output]() { (void)ExecuteModel(modelId, input, output); });
+}
+
+aclmdlDesc *aclmdlCreateDesc()
+{
+    return new aclmdlDesc();
+}
+
+aclError aclmdlDestroyDesc(aclmdlDesc *modelDesc)
+{
+    if (modelDesc == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete modelDesc;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclmdlGetDesc(aclmdlDesc *modelDesc, uint32_t modelId)
+{
+    std::shared_ptr<const ModelIo> modelIo = FindModel(modelId);
+    if (modelDesc == nullptr || modelIo == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    modelDesc->modelIo = modelIo;
+    return ACL_ERROR_NONE;
+}
+
+size_t aclmdlGetNumInputs(aclmdlDesc *modelDesc)
+{
+    return (modelDesc == nullptr || modelDesc->modelIo == nullptr) ? 0 : modelDesc->modelIo->inputSizes.size();
+}
+
+size_t aclmdlGetNumOutputs(aclmdlDesc *modelDesc)
+{
+    return (modelDesc == nullptr || modelDesc->modelIo == nullptr) ? 0 : modelDesc->modelIo->outputSizes.size();
+}
+
+size_t aclmdlGetInputSizeByIndex(aclmdlDesc *modelDesc, size_t index)
+{
+    if (index >= aclmdlGetNumInputs(modelDesc)) {
+        return 0;
+    }
+    return modelDesc->modelIo->inputSizes[index];
+}
+
+size_t aclmdlGetOutputSizeByIndex(aclmdlDesc *modelDesc, size_t index)
+{
+    if (index >= aclmdlGetNumOutputs(modelDesc)) {
+        return 0;
+    }
+    return modelDesc->modelIo->outputSizes[index];
+}
+
+aclError aclmdlGetInputIndexByName(const aclmdlDesc *modelDesc, const char *name, size_t *index)
+{
+    return ACL_ERROR_INVALID_PARAM;
+}
+
+aclError aclmdlSetDynamicBatchSize(uint32_t modelId, aclmdlDataset *dataset, size_t index, uint64_t batchSize)
+{
+    return ACL_ERROR_INVALID_PARAM;
+}
+
+aclError aclmdlSetDynamicHWSize(uint32_t modelId, aclmdlDataset *dataset, size_t index, uint64_t height,
+    uint64_t width)
+{
+    return ACL_ERROR_INVALID_PARAM;
+}
+
+aclmdlDataset *aclmdlCreateDataset()
+{
+    return new aclmdlDataset();
+}
+
+aclError aclmdlDestroyDataset(const aclmdlDataset *dataset)
+{
+    if (dataset == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete dataset;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclmdlAddDatasetBuffer(aclmdlDataset *dataset, aclDataBuffer *dataBuffer)
+{
+    if (dataset == nullptr || dataBuffer == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    dataset->buffers.push_back(dataBuffer);
+    return ACL_ERROR_NONE;
+}
+
+size_t aclmdlGetDatasetNumBuffers(const aclmdlDataset *dataset)
+{
+    return (dataset == nullptr) ? 0 : dataset->buffers.size();
+}
+
+aclDataBuffer *aclmdlGetDatasetBuffer(const aclmdlDataset *dataset, size_t index)
+{
+    return (dataset == nullptr || index >= dataset->buffers.size()) ? nullptr : dataset->buffers[index];
+}
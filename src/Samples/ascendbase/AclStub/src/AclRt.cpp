@@ -0,0 +1,469 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <pthread.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include "AclStubInner.h"
+
+namespace aclStub {
+namespace {
+const char *LATENCY_ENV_NAMES[ACL_STUB_ENGINE_COUNT] = {
+    "ACL_STUB_MODEL_LATENCY_US",
+    "ACL_STUB_VDEC_LATENCY_US",
+    "ACL_STUB_VPC_LATENCY_US",
+    "ACL_STUB_JPEGD_LATENCY_US",
+    "ACL_STUB_JPEGE_LATENCY_US",
+};
+
+struct Context {
+    int32_t deviceId;
+};
+
+// callbacks waiting for the thread that runs aclrtProcessReport
+struct ReportQueue {
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::function<void()>> reports;
+};
+
+struct Stream {
+    TaskWorker worker;
+    std::atomic<uint64_t> reportThreadId;
+    Stream() : reportThreadId(0) {}
+};
+
+std::atomic<uint32_t> g_latencyUs[ACL_STUB_ENGINE_COUNT];
+std::once_flag g_latencyOnce;
+std::atomic_bool g_isInit(false);
+std::mutex g_deviceMutex;
+std::map<int32_t, int> g_deviceRefCounts;             // aclrtSetDevice calls not reset yet
+std::map<int32_t, Context *> g_defaultContexts;       // created by the first aclrtSetDevice of the device
+std::mutex g_reportMutex;
+std::map<uint64_t, std::shared_ptr<ReportQueue>> g_reportQueues;
+thread_local Context *g_currentContext = nullptr;
+
+void InitLatency()
+{
+    std::call_once(g_latencyOnce, []() {
+        for (int i = 0; i < ACL_STUB_ENGINE_COUNT; i++) {
+            const char *value = std::getenv(LATENCY_ENV_NAMES[i]);
+            g_latencyUs[i] = (value == nullptr) ? 0 : static_cast<uint32_t>(std::strtoul(value, nullptr, 0));
+        }
+    });
+}
+
+std::shared_ptr<ReportQueue> GetReportQueue(uint64_t threadId)
+{
+    std::lock_guard<std::mutex> lock(g_reportMutex);
+    std::shared_ptr<ReportQueue> &reportQueue = g_reportQueues[threadId];
+    if (reportQueue == nullptr) {
+        reportQueue = std::make_shared<ReportQueue>();
+    }
+    return reportQueue;
+}
+
+uint64_t GetThreadId()
+{
+    return static_cast<uint64_t>(pthread_self());
+}
+}
+
+TaskWorker::TaskWorker()
+{
+    thread_ = std::thread(&TaskWorker::Run, this);
+}
+
+TaskWorker::~TaskWorker()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStop_ = true;
+    }
+    taskCond_.notify_all();
+    thread_.join();
+}
+
+void TaskWorker::Push(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+    }
+    taskCond_.notify_one();
+}
+
+void TaskWorker::Synchronize()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    idleCond_.wait(lock, [this]() { return tasks_.empty() && !isBusy_; });
+}
+
+void TaskWorker::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        taskCond_.wait(lock, [this]() { return !tasks_.empty() || isStop_; });
+        if (tasks_.empty()) {
+            return;
+        }
+        std::function<void()> task = std::move(tasks_.front());
+        tasks_.pop_front();
+        isBusy_ = true;
+        lock.unlock();
+        task();
+        lock.lock();
+        isBusy_ = false;
+        if (tasks_.empty()) {
+            idleCond_.notify_all();
+        }
+    }
+}
+
+aclError PushTask(aclrtStream stream, std::function<void()> task)
+{
+    if (stream == nullptr) {
+        task();
+        return ACL_ERROR_NONE;
+    }
+    static_cast<Stream *>(stream)->worker.Push(std::move(task));
+    return ACL_ERROR_NONE;
+}
+
+void PostReport(uint64_t threadId, std::function<void()> report)
+{
+    std::shared_ptr<ReportQueue> reportQueue = GetReportQueue(threadId);
+    {
+        std::lock_guard<std::mutex> lock(reportQueue->mutex);
+        reportQueue->reports.push_back(std::move(report));
+    }
+    reportQueue->cond.notify_one();
+}
+
+void SimulateLatency(aclStubEngine engine)
+{
+    uint32_t latencyUs = aclStubGetLatency(engine);
+    if (latencyUs > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(latencyUs));
+    }
+}
+}
+
+using namespace aclStub;
+
+void aclStubSetLatency(aclStubEngine engine, uint32_t latencyUs)
+{
+    if (engine < 0 || engine >= ACL_STUB_ENGINE_COUNT) {
+        return;
+    }
+    InitLatency();
+    g_latencyUs[engine] = latencyUs;
+}
+
+uint32_t aclStubGetLatency(aclStubEngine engine)
+{
+    if (engine < 0 || engine >= ACL_STUB_ENGINE_COUNT) {
+        return 0;
+    }
+    InitLatency();
+    return g_latencyUs[engine].load(std::memory_order_relaxed);
+}
+
+aclError aclInit(const char *configPath)
+{
+    bool isInit = false;
+    if (!g_isInit.compare_exchange_strong(isInit, true)) {
+        return ACL_ERROR_REPEAT_INITIALIZE;
+    }
+    InitLatency();
+    return ACL_ERROR_NONE;
+}
+
+aclError aclFinalize()
+{
+    g_isInit = false;
+    return ACL_ERROR_NONE;
+}
+
+aclDataBuffer *aclCreateDataBuffer(void *data, size_t size)
+{
+    return new aclDataBuffer {data, size};
+}
+
+aclError aclDestroyDataBuffer(const aclDataBuffer *dataBuffer)
+{
+    if (dataBuffer == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete dataBuffer;
+    return ACL_ERROR_NONE;
+}
+
+void *aclGetDataBufferAddr(const aclDataBuffer *dataBuffer)
+{
+    return (dataBuffer == nullptr) ? nullptr : dataBuffer->data;
+}
+
+uint32_t aclGetDataBufferSize(const aclDataBuffer *dataBuffer)
+{
+    return (dataBuffer == nullptr) ? 0 : static_cast<uint32_t>(dataBuffer->size);
+}
+
+aclError aclrtSetDevice(int32_t deviceId)
+{
+    if (deviceId < 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(g_deviceMutex);
+    g_deviceRefCounts[deviceId]++;
+    Context *&context = g_defaultContexts[deviceId];
+    if (context == nullptr) {
+        context = new Context {deviceId};
+    }
+    g_currentContext = context;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtResetDevice(int32_t deviceId)
+{
+    std::lock_guard<std::mutex> lock(g_deviceMutex);
+    auto iter = g_deviceRefCounts.find(deviceId);
+    if (iter == g_deviceRefCounts.end()) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    if (--iter->second > 0) {
+        return ACL_ERROR_NONE;
+    }
+    g_deviceRefCounts.erase(iter);
+    Context *context = g_defaultContexts[deviceId];
+    g_defaultContexts.erase(deviceId);
+    if (g_currentContext == context) {
+        g_currentContext = nullptr;
+    }
+    delete context;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtGetDevice(int32_t *deviceId)
+{
+    if (deviceId == nullptr || g_currentContext == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *deviceId = g_currentContext->deviceId;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtGetRunMode(aclrtRunMode *runMode)
+{
+    if (runMode == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *runMode = ACL_HOST;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtCreateContext(aclrtContext *context, int32_t deviceId)
+{
+    if (context == nullptr || deviceId < 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    Context *newContext = new Context {deviceId};
+    g_currentContext = newContext;
+    *context = newContext;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtDestroyContext(aclrtContext context)
+{
+    if (context == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    if (g_currentContext == context) {
+        g_currentContext = nullptr;
+    }
+    delete static_cast<Context *>(context);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtSetCurrentContext(aclrtContext context)
+{
+    if (context == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    g_currentContext = static_cast<Context *>(context);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtGetCurrentContext(aclrtContext *context)
+{
+    if (context == nullptr || g_currentContext == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *context = g_currentContext;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtCreateStream(aclrtStream *stream)
+{
+    if (stream == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *stream = new Stream();
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtDestroyStream(aclrtStream stream)
+{
+    if (stream == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    delete static_cast<Stream *>(stream);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtSynchronizeStream(aclrtStream stream)
+{
+    if (stream != nullptr) {
+        static_cast<Stream *>(stream)->worker.Synchronize();
+    }
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtMalloc(void **devPtr, size_t size, aclrtMemMallocPolicy policy)
+{
+    if (devPtr == nullptr || size == 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    *devPtr = std::malloc(size);
+    return (*devPtr == nullptr) ? ACL_ERROR_BAD_ALLOC : ACL_ERROR_NONE;
+}
+
+aclError aclrtFree(void *devPtr)
+{
+    if (devPtr == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    std::free(devPtr);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtMallocHost(void **hostPtr, size_t size)
+{
+    return aclrtMalloc(hostPtr, size, ACL_MEM_MALLOC_NORMAL_ONLY);
+}
+
+aclError aclrtFreeHost(void *hostPtr)
+{
+    return aclrtFree(hostPtr);
+}
+
+aclError aclrtMemset(void *devPtr, size_t maxCount, int32_t value, size_t count)
+{
+    if (devPtr == nullptr || count > maxCount) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    std::memset(devPtr, value, count);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtMemcpy(void *dst, size_t destMax, const void *src, size_t count, aclrtMemcpyKind kind)
+{
+    if (dst == nullptr || src == nullptr || count > destMax) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    std::memcpy(dst, src, count);
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtMemcpyAsync(void *dst, size_t destMax, const void *src, size_t count, aclrtMemcpyKind kind,
+    aclrtStream stream)
+{
+    if (dst == nullptr || src == nullptr || count > destMax) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    return PushTask(stream, [dst, src, count]() { std::memcpy(dst, src, count); });
+}
+
+aclError aclrtSubscribeReport(uint64_t threadId, aclrtStream stream)
+{
+    if (stream == nullptr) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    static_cast<Stream *>(stream)->reportThreadId = threadId;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtUnSubscribeReport(uint64_t threadId, aclrtStream stream)
+{
+    if (stream == nullptr || static_cast<Stream *>(stream)->reportThreadId != threadId) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    static_cast<Stream *>(stream)->reportThreadId = 0;
+    return ACL_ERROR_NONE;
+}
+
+aclError aclrtLaunchCallback(aclrtCallback fn, void *userData, aclrtCallbackBlockType blockType, aclrtStream stream)
+{
+    if (fn == nullptr || stream == nullptr || static_cast<Stream *>(stream)->reportThreadId == 0) {
+        return ACL_ERROR_INVALID_PARAM;
+    }
+    Stream *launchStream = static_cast<Stream *>(stream);
+    return PushTask(stream, [fn, userData, blockType, launchStream]() {
+        if (blockType == ACL_CALLBACK_NO_BLOCK) {
+            PostReport(launchStream->reportThreadId, [fn, userData]() { fn(userData); });
+            return;
+        }
+        // the tasks launched after the callback wait for it
+        std::shared_ptr<std::promise<void>> done = std::make_shared<std::promise<void>>();
+        std::future<void> doneFuture = done->get_future();
+        PostReport(launchStream->reportThreadId, [fn, userData, done]() {
+            fn(userData);
+            done->set_value();
+        });
+        doneFuture.wait();
+    });
+}
+
+aclError aclrtProcessReport(int32_t timeout)
+{
+    std::shared_ptr<ReportQueue> reportQueue = GetReportQueue(GetThreadId());
+    std::deque<std::function<void()>> reports;
+    {
+        std::unique_lock<std::mutex> lock(reportQueue->mutex);
+        auto isReady = [&reportQueue]() { return !reportQueue->reports.empty(); };
+        if (timeout < 0) {
+            reportQueue->cond.wait(lock, isReady);
+        } else if (!reportQueue->cond.wait_for(lock, std::chrono::milliseconds(timeout), isReady)) {
+            return ACL_ERROR_RT_FAILURE;
+        }
+        reports.swap(reportQueue->reports);
+    }
+    for (auto &report : reports) {
+        report();
+    }
+    return ACL_ERROR_NONE;
+}
+
+aclError aclopSetModelDir(const char *modelDir)
+{
+    return (modelDir == nullptr) ? ACL_ERROR_INVALID_PARAM : ACL_ERROR_NONE;
+}
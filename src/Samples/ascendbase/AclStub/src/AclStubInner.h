@@ -0,0 +1,68 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_ACL_STUB_INNER_H
+#define INC_ACL_STUB_INNER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "AclStub.h"
+
+struct aclDataBuffer {
+    void *data;
+    size_t size;
+};
+
+struct aclmdlDataset {
+    std::vector<aclDataBuffer *> buffers;
+};
+
+namespace aclStub {
+// runs the tasks pushed to it in order on a thread of its own, like the NPU runs the tasks of a stream
+class TaskWorker {
+public:
+    TaskWorker();
+    ~TaskWorker(); // runs the pending tasks before it returns
+    void Push(std::function<void()> task);
+    // wait for the tasks pushed so far
+    void Synchronize();
+
+private:
+    void Run();
+
+private:
+    std::mutex mutex_ = {};
+    std::condition_variable taskCond_ = {};
+    std::condition_variable idleCond_ = {};
+    std::deque<std::function<void()>> tasks_ = {};
+    bool isBusy_ = false;
+    bool isStop_ = false;
+    std::thread thread_ = {};
+};
+
+// run the task on the stream, or in the calling thread for the default stream
+aclError PushTask(aclrtStream stream, std::function<void()> task);
+// queue the report to the thread threadId, it runs it in aclrtProcessReport
+void PostReport(uint64_t threadId, std::function<void()> report);
+// sleep for the latency of the engine
+void SimulateLatency(aclStubEngine engine);
+}
+
+#endif
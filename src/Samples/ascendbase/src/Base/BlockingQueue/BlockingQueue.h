@@ -17,21 +17,28 @@
 #define BLOCKING_QUEUE_H
 
 #include "ErrorCode/ErrorCode.h"
+#include "BlockingQueue/QueueBase.h"
+#include "BlockingQueue/WaitStrategy.h"
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <list>
 #include <mutex>
 #include <stdint.h>
+#include <utility>
+#include <vector>
 
 static const int DEFAULT_MAX_QUEUE_SIZE = 256;
 
-template<typename T> class BlockingQueue {
+template<typename T> class BlockingQueue : public QueueBase<T> {
 public:
-    BlockingQueue(uint32_t maxSize = DEFAULT_MAX_QUEUE_SIZE) : max_size_(maxSize), is_stoped_(false) {}
+    BlockingQueue(uint32_t maxSize = DEFAULT_MAX_QUEUE_SIZE) : max_size_(maxSize), size_(0), is_stoped_(false) {}
 
     ~BlockingQueue() {}
 
     APP_ERROR Pop(T &item)
     {
+        SpinForItem();
         std::unique_lock<std::mutex> lock(mutex_);
 
         while (queue_.empty() && !is_stoped_) {
@@ -45,8 +52,9 @@ public:
         if (queue_.empty()) {
             return APP_ERR_QUEUE_EMPTY;
         } else {
-            item = queue_.front();
+            item = std::move(queue_.front());
             queue_.pop_front();
+            size_.store(queue_.size(), std::memory_order_relaxed);
         }
 
         full_cond_.notify_one();
@@ -56,13 +64,18 @@ public:
 
     APP_ERROR Pop(T& item, unsigned int timeOutMs)
     {
+        if (timeOutMs > 0) {
+            SpinForItem();
+        }
         std::unique_lock<std::mutex> lock(mutex_);
-        auto realTime = std::chrono::milliseconds(timeOutMs);
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeOutMs);
 
         while (queue_.empty() && !is_stoped_) {
-            empty_cond_.wait_for(lock, realTime);
+            if (empty_cond_.wait_until(lock, deadline) == std::cv_status::timeout) {
+                break;
+            }
         }
-        
+
         if (is_stoped_) {
             return APP_ERR_QUEUE_STOPED;
         }
@@ -70,8 +83,9 @@ public:
         if (queue_.empty()) {
             return APP_ERR_QUEUE_EMPTY;
         } else {
-            item = queue_.front();
+            item = std::move(queue_.front());
             queue_.pop_front();
+            size_.store(queue_.size(), std::memory_order_relaxed);
         }
 
         full_cond_.notify_one();
@@ -80,23 +94,95 @@ public:
     }
 
     APP_ERROR Push(const T& item, bool isWait = false)
+    {
+        return PushItem(item, isWait);
+    }
+
+    APP_ERROR Push(T &&item, bool isWait = false)
+    {
+        return PushItem(std::move(item), isWait);
+    }
+
+    // construct the item in place from args
+    template<typename... Args> APP_ERROR Emplace(bool isWait, Args &&...args)
     {
         std::unique_lock<std::mutex> lock(mutex_);
+        APP_ERROR ret = WaitForRoom(lock, isWait);
+        if (ret != APP_ERR_OK) {
+            return ret;
+        }
+        queue_.emplace_back(std::forward<Args>(args)...);
+        size_.store(queue_.size(), std::memory_order_release);
 
-        while (queue_.size() >= max_size_ && isWait && !is_stoped_) {
-            full_cond_.wait(lock);
+        empty_cond_.notify_one();
+
+        return APP_ERR_OK;
+    }
+
+    APP_ERROR PopBatch(std::vector<T> &items, uint32_t maxCount, unsigned int timeOutMs)
+    {
+        items.clear();
+        SpinForItem();
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        while (queue_.empty() && !is_stoped_) {
+            empty_cond_.wait(lock);
         }
 
         if (is_stoped_) {
             return APP_ERR_QUEUE_STOPED;
         }
 
-        if (queue_.size() >= max_size_) {
-            return APP_ERROR_QUEUE_FULL;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeOutMs);
+        while (true) {
+            while (!queue_.empty() && items.size() < maxCount) {
+                items.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+            size_.store(queue_.size(), std::memory_order_relaxed);
+            if (items.size() >= maxCount || timeOutMs == 0 || is_stoped_) {
+                break;
+            }
+            // let the blocked senders refill the queue while the batch is not full
+            full_cond_.notify_all();
+            if (empty_cond_.wait_until(lock, deadline) == std::cv_status::timeout) {
+                while (!queue_.empty() && items.size() < maxCount) {
+                    items.push_back(std::move(queue_.front()));
+                    queue_.pop_front();
+                }
+                size_.store(queue_.size(), std::memory_order_relaxed);
+                break;
+            }
         }
-        queue_.push_back(item);
 
-        empty_cond_.notify_one();
+        full_cond_.notify_all();
+
+        return APP_ERR_OK;
+    }
+
+    APP_ERROR PushBatch(const std::vector<T> &items, bool isWait = false)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        for (auto &item : items) {
+            while (queue_.size() >= max_size_ && isWait && !is_stoped_) {
+                empty_cond_.notify_all();
+                full_cond_.wait(lock);
+            }
+
+            if (is_stoped_) {
+                return APP_ERR_QUEUE_STOPED;
+            }
+
+            if (queue_.size() >= max_size_) {
+                empty_cond_.notify_all();
+                return APP_ERROR_QUEUE_FULL;
+            }
+            queue_.push_back(item);
+            size_.store(queue_.size(), std::memory_order_release);
+        }
+
+        empty_cond_.notify_all();
 
         return APP_ERR_OK;
     }
@@ -118,6 +204,7 @@ public:
         }
 
         queue_.push_front(item);
+        size_.store(queue_.size(), std::memory_order_release);
 
         empty_cond_.notify_one();
 
@@ -152,7 +239,10 @@ public:
             return std::list<T>();
         }
 
-        return queue_;
+        std::list<T> items;
+        items.swap(queue_);
+        size_.store(0, std::memory_order_relaxed);
+        return items;
     }
 
     APP_ERROR GetBackItem(T &item)
@@ -182,7 +272,7 @@ public:
 
     int GetSize()
     {
-        return queue_.size();
+        return size_.load(std::memory_order_relaxed);
     }
 
     APP_ERROR IsEmpty()
@@ -190,10 +280,56 @@ public:
         return queue_.empty();
     }
 
+    void SetWaitStrategy(QueueWaitStrategy strategy, uint32_t spinUs = QUEUE_SPIN_US)
+    {
+        spinner_.SetStrategy(strategy, spinUs);
+    }
+
     void Clear()
     {
         std::unique_lock<std::mutex> lock(mutex_);
         queue_.clear();
+        size_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // busy wait before taking the lock, the producer then finds nobody to wake up on empty_cond_
+    void SpinForItem()
+    {
+        spinner_.Spin([this]() {
+            return size_.load(std::memory_order_acquire) > 0 || is_stoped_.load(std::memory_order_relaxed);
+        });
+    }
+
+    APP_ERROR WaitForRoom(std::unique_lock<std::mutex> &lock, bool isWait)
+    {
+        while (queue_.size() >= max_size_ && isWait && !is_stoped_) {
+            full_cond_.wait(lock);
+        }
+
+        if (is_stoped_) {
+            return APP_ERR_QUEUE_STOPED;
+        }
+
+        if (queue_.size() >= max_size_) {
+            return APP_ERROR_QUEUE_FULL;
+        }
+        return APP_ERR_OK;
+    }
+
+    template<typename U> APP_ERROR PushItem(U &&item, bool isWait)
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        APP_ERROR ret = WaitForRoom(lock, isWait);
+        if (ret != APP_ERR_OK) {
+            return ret;
+        }
+        queue_.push_back(std::forward<U>(item));
+        size_.store(queue_.size(), std::memory_order_release);
+
+        empty_cond_.notify_one();
+
+        return APP_ERR_OK;
     }
 
 private:
@@ -202,7 +338,9 @@ private:
     std::condition_variable empty_cond_;
     std::condition_variable full_cond_;
     uint32_t max_size_;
+    std::atomic<size_t> size_; // queue_.size() readable without the lock
 
-    bool is_stoped_;
+    std::atomic<bool> is_stoped_;
+    QueueSpinner spinner_ = {};
 };
 #endif // __INC_BLOCKING_QUEUE_H__
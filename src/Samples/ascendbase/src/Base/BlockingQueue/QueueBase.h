@@ -0,0 +1,56 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef QUEUE_BASE_H
+#define QUEUE_BASE_H
+
+#include <list>
+#include <vector>
+#include <stdint.h>
+#include "ErrorCode/ErrorCode.h"
+#include "BlockingQueue/WaitStrategy.h"
+
+// Common interface of the queues used to connect modules, so that every connection can choose its own
+// implementation (BlockingQueue, RingQueue). All implementations share the same semantics:
+// Pop blocks until an item arrives or the queue is stopped and moves the item out, Push returns
+// APP_ERROR_QUEUE_FULL when the queue is full and isWait is false, and every operation returns
+// APP_ERR_QUEUE_STOPED once Stop has been called.
+template<typename T> class QueueBase {
+public:
+    virtual ~QueueBase() {}
+
+    virtual APP_ERROR Pop(T &item) = 0;
+    // wait at most timeOutMs, return APP_ERR_QUEUE_EMPTY if nothing arrived in time
+    virtual APP_ERROR Pop(T &item, unsigned int timeOutMs) = 0;
+    virtual APP_ERROR Push(const T &item, bool isWait = false) = 0;
+    // take the ownership of item, item is only moved from when APP_ERR_OK is returned
+    virtual APP_ERROR Push(T &&item, bool isWait = false) = 0;
+    // wait until at least one item arrives, then take up to maxCount items into items (cleared first),
+    // waiting at most timeOutMs after the first item for the batch to fill; 0 takes only the available items
+    virtual APP_ERROR PopBatch(std::vector<T> &items, uint32_t maxCount, unsigned int timeOutMs) = 0;
+    // push the items in order; if isWait is false the items that do not fit are dropped and
+    // APP_ERROR_QUEUE_FULL is returned
+    virtual APP_ERROR PushBatch(const std::vector<T> &items, bool isWait = false) = 0;
+    virtual void Stop() = 0;
+    virtual void Restart() = 0;
+    // take out the items left in the queue once Stop has been called, nothing if it is not stopped
+    virtual std::list<T> GetRemainItems() = 0;
+    virtual APP_ERROR IsFull() = 0;
+    virtual int GetSize() = 0;
+    virtual APP_ERROR IsEmpty() = 0;
+    // how Pop and PopBatch wait for an item, a queue which has no choice ignores it
+    virtual void SetWaitStrategy(QueueWaitStrategy /* strategy */, uint32_t /* spinUs */ = QUEUE_SPIN_US) {}
+};
+#endif
@@ -0,0 +1,147 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef WAIT_STRATEGY_H
+#define WAIT_STRATEGY_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdint.h>
+
+// what a consumer does while its queue is empty, before it parks on the condition variable of the queue;
+// a parked consumer costs the producer a futex wake and the scheduling latency, a spinning one costs a cpu
+enum QueueWaitStrategy {
+    QUEUE_WAIT_DEFAULT = 0, // keep the strategy the queue was created with
+    QUEUE_WAIT_BLOCK,       // park at once
+    QUEUE_WAIT_SPIN,        // busy wait with a cpu pause for the spin budget, then park
+    QUEUE_WAIT_SPIN_YIELD,  // busy wait, then yield the cpu for another spin budget, then park
+    QUEUE_WAIT_ADAPTIVE     // busy wait about twice the recent waits, park at once when they exceed the spin budget
+};
+
+static const uint32_t QUEUE_SPIN_US = 50;        // default spin budget
+static const uint32_t QUEUE_MIN_YIELD_COUNT = 64; // yields made in the yield phase even with a spin budget of 0
+static const uint32_t QUEUE_CLOCK_INTERVAL = 32;  // pauses between two reads of the clock
+static const int64_t QUEUE_ADAPTIVE_WEIGHT = 8;   // the average wait moves by 1/8 of every new wait
+static const uint32_t QUEUE_ADAPTIVE_RETRY = 16;  // a consumer which stopped spinning tries again every 16 waits
+static const int64_t QUEUE_ADAPTIVE_MIN_NS = 1000; // shortest adaptive spin
+
+inline void CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// spin phase of the wait of a queue consumer, the queue parks the consumer when Spin returns false
+class QueueSpinner {
+public:
+    QueueSpinner(QueueWaitStrategy strategy = QUEUE_WAIT_BLOCK, uint32_t spinUs = QUEUE_SPIN_US)
+        : strategy_(strategy), spinNs_(spinUs * NS_PER_US), averageWaitNs_(0), waitCount_(0)
+    {}
+
+    void SetStrategy(QueueWaitStrategy strategy, uint32_t spinUs = QUEUE_SPIN_US)
+    {
+        if (strategy == QUEUE_WAIT_DEFAULT) {
+            return;
+        }
+        spinNs_.store(static_cast<int64_t>(spinUs) * NS_PER_US, std::memory_order_relaxed);
+        strategy_.store(strategy, std::memory_order_relaxed);
+    }
+
+    QueueWaitStrategy GetStrategy() const
+    {
+        return strategy_.load(std::memory_order_relaxed);
+    }
+
+    // return true as soon as ready() does, false if the consumer has to park
+    template<typename Pred> bool Spin(Pred ready)
+    {
+        QueueWaitStrategy strategy = strategy_.load(std::memory_order_relaxed);
+        if (ready()) {
+            return true;
+        }
+        if (strategy == QUEUE_WAIT_BLOCK) {
+            return false;
+        }
+        int64_t spinNs = spinNs_.load(std::memory_order_relaxed);
+        if (strategy == QUEUE_WAIT_ADAPTIVE) {
+            return SpinAdaptive(ready, spinNs);
+        }
+        auto startTime = std::chrono::steady_clock::now();
+        if (SpinFor(ready, startTime, spinNs) >= 0) {
+            return true;
+        }
+        if (strategy != QUEUE_WAIT_SPIN_YIELD) {
+            return false;
+        }
+        auto yieldEndTime = std::chrono::steady_clock::now() + std::chrono::nanoseconds(spinNs);
+        for (uint32_t i = 0; i < QUEUE_MIN_YIELD_COUNT || std::chrono::steady_clock::now() < yieldEndTime; i++) {
+            if (ready()) {
+                return true;
+            }
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+private:
+    static const int64_t NS_PER_US = 1000;
+
+    // return the time it took ready() to become true, -1 if it did not within spinNs
+    template<typename Pred> int64_t SpinFor(Pred ready, std::chrono::steady_clock::time_point startTime,
+        int64_t spinNs)
+    {
+        for (uint32_t i = 1;; i++) {
+            if (ready()) {
+                return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() -
+                    startTime).count();
+            }
+            CpuRelax();
+            if (i % QUEUE_CLOCK_INTERVAL == 0 && std::chrono::steady_clock::now() - startTime >=
+                std::chrono::nanoseconds(spinNs)) {
+                return -1;
+            }
+        }
+    }
+
+    // a wait which ends in the park is accounted as twice the spin budget, so that the consumers of an idle queue
+    // soon stop spinning, they try again now and then to notice the queue got busy
+    template<typename Pred> bool SpinAdaptive(Pred ready, int64_t spinNs)
+    {
+        int64_t averageWaitNs = averageWaitNs_.load(std::memory_order_relaxed);
+        uint32_t waitCount = waitCount_.fetch_add(1, std::memory_order_relaxed);
+        if (averageWaitNs >= spinNs && waitCount % QUEUE_ADAPTIVE_RETRY != 0) {
+            return false;
+        }
+        int64_t budgetNs = std::min(std::max(2 * averageWaitNs, QUEUE_ADAPTIVE_MIN_NS), spinNs);
+        int64_t waitNs = SpinFor(ready, std::chrono::steady_clock::now(), budgetNs);
+        int64_t sampleNs = (waitNs >= 0) ? waitNs : 2 * spinNs;
+        averageWaitNs_.store(averageWaitNs + (sampleNs - averageWaitNs) / QUEUE_ADAPTIVE_WEIGHT,
+            std::memory_order_relaxed);
+        return waitNs >= 0;
+    }
+
+    std::atomic<QueueWaitStrategy> strategy_;
+    std::atomic<int64_t> spinNs_;
+    std::atomic<int64_t> averageWaitNs_; // updated by every consumer without synchronization, it is only a hint
+    std::atomic<uint32_t> waitCount_;
+};
+
+#endif
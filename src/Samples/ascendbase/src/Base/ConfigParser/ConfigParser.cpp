@@ -52,8 +52,9 @@ inline void ConfigParser::RemoveAllSpaces(std::string &str)
 // Remove spaces from both left and right based on the string
 inline void ConfigParser::Trim(std::string &str)
 {
-    str.erase(str.begin(), std::find_if(str.begin(), str.end(), std::not1(std::ptr_fun(::isspace))));
-    str.erase(std::find_if(str.rbegin(), str.rend(), std::not1(std::ptr_fun(::isspace))).base(), str.end());
+    auto isNotSpace = [](int ch) { return !isspace(ch); };
+    str.erase(str.begin(), std::find_if(str.begin(), str.end(), isNotSpace));
+    str.erase(std::find_if(str.rbegin(), str.rend(), isNotSpace).base(), str.end());
     return;
 }
 APP_ERROR ConfigParser::ParseConfig(const std::string &fileName)
@@ -95,7 +96,7 @@ APP_ERROR ConfigParser::ParseConfig(const std::string &fileName)
 }
 
 // Get the string value by key name
-APP_ERROR ConfigParser::GetStringValue(const std::string &name, std::string &value)
+APP_ERROR ConfigParser::GetStringValue(const std::string &name, std::string &value) const
 {
     if (configData_.count(name) == 0) {
         return APP_ERR_COMM_NO_EXIST;
@@ -105,7 +106,7 @@ APP_ERROR ConfigParser::GetStringValue(const std::string &name, std::string &val
 }
 
 // Get the int value by key name
-APP_ERROR ConfigParser::GetIntValue(const std::string &name, int &value)
+APP_ERROR ConfigParser::GetIntValue(const std::string &name, int &value) const
 {
     if (configData_.count(name) == 0) {
         return APP_ERR_COMM_NO_EXIST;
@@ -118,7 +119,7 @@ APP_ERROR ConfigParser::GetIntValue(const std::string &name, int &value)
 }
 
 // Get the unsigned integer value by key name
-APP_ERROR ConfigParser::GetUnsignedIntValue(const std::string &name, unsigned int &value)
+APP_ERROR ConfigParser::GetUnsignedIntValue(const std::string &name, unsigned int &value) const
 {
     if (configData_.count(name) == 0) {
         return APP_ERR_COMM_NO_EXIST;
@@ -131,7 +132,7 @@ APP_ERROR ConfigParser::GetUnsignedIntValue(const std::string &name, unsigned in
 }
 
 // Get the bool value
-APP_ERROR ConfigParser::GetBoolValue(const std::string &name, bool &value)
+APP_ERROR ConfigParser::GetBoolValue(const std::string &name, bool &value) const
 {
     if (configData_.count(name) == 0) {
         return APP_ERR_COMM_NO_EXIST;
@@ -148,7 +149,7 @@ APP_ERROR ConfigParser::GetBoolValue(const std::string &name, bool &value)
 }
 
 // Get the float value
-APP_ERROR ConfigParser::GetFloatValue(const std::string &name, float &value)
+APP_ERROR ConfigParser::GetFloatValue(const std::string &name, float &value) const
 {
     if (configData_.count(name) == 0) {
         return APP_ERR_COMM_NO_EXIST;
@@ -161,7 +162,7 @@ APP_ERROR ConfigParser::GetFloatValue(const std::string &name, float &value)
 }
 
 // Get the double value
-APP_ERROR ConfigParser::GetDoubleValue(const std::string &name, double &value)
+APP_ERROR ConfigParser::GetDoubleValue(const std::string &name, double &value) const
 {
     if (configData_.count(name) == 0) {
         return APP_ERR_COMM_NO_EXIST;
@@ -174,7 +175,7 @@ APP_ERROR ConfigParser::GetDoubleValue(const std::string &name, double &value)
 }
 
 // Array like 1,2,4,8  split by ","
-APP_ERROR ConfigParser::GetVectorUint32Value(const std::string &name, std::vector<uint32_t> &vector)
+APP_ERROR ConfigParser::GetVectorUint32Value(const std::string &name, std::vector<uint32_t> &vector) const
 {
     if (configData_.count(name) == 0) {
         return APP_ERR_COMM_NO_EXIST;
@@ -195,6 +196,12 @@ APP_ERROR ConfigParser::GetVectorUint32Value(const std::string &name, std::vecto
     return APP_ERR_OK;
 }
 
+// Get all the key-value pairs read from the config file
+const std::map<std::string, std::string> &ConfigParser::GetAllValues() const
+{
+    return configData_;
+}
+
 // new config
 void ConfigParser::NewConfig(const std::string &fileName)
 {
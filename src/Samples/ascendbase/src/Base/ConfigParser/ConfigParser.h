@@ -32,19 +32,21 @@ public:
     // Read the config file and save the useful infomation with the key-value pairs format in configData_
     APP_ERROR ParseConfig(const std::string &fileName);
     // Get the string value by key name
-    APP_ERROR GetStringValue(const std::string &name, std::string &value);
+    APP_ERROR GetStringValue(const std::string &name, std::string &value) const;
     // Get the int value by key name
-    APP_ERROR GetIntValue(const std::string &name, int &value);
+    APP_ERROR GetIntValue(const std::string &name, int &value) const;
     // Get the unsigned int value by key name
-    APP_ERROR GetUnsignedIntValue(const std::string &name, unsigned int &value);
+    APP_ERROR GetUnsignedIntValue(const std::string &name, unsigned int &value) const;
     // Get the bool value by key name
-    APP_ERROR GetBoolValue(const std::string &name, bool &value);
+    APP_ERROR GetBoolValue(const std::string &name, bool &value) const;
     // Get the float value by key name
-    APP_ERROR GetFloatValue(const std::string &name, float &value);
+    APP_ERROR GetFloatValue(const std::string &name, float &value) const;
     // Get the double value by key name
-    APP_ERROR GetDoubleValue(const std::string &name, double &value);
+    APP_ERROR GetDoubleValue(const std::string &name, double &value) const;
     // Get the vector by key name, split by ","
-    APP_ERROR GetVectorUint32Value(const std::string &name, std::vector<uint32_t> &vector);
+    APP_ERROR GetVectorUint32Value(const std::string &name, std::vector<uint32_t> &vector) const;
+    // Get all the key-value pairs read from the config file
+    const std::map<std::string, std::string> &GetAllValues() const;
 
     void NewConfig(const std::string &fileName);
     // Write the values into new config file
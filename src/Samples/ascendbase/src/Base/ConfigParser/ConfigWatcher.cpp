@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ConfigParser/ConfigWatcher.h"
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "Log/Log.h"
+
+namespace {
+const size_t INOTIFY_BUFFER_SIZE = 4096;
+
+// the directory and the name of the file, inotify watches the directory
+void SplitPath(const std::string &fileName, std::string &dirName, std::string &baseName)
+{
+    size_t slashPos = fileName.rfind('/');
+    dirName = (slashPos == std::string::npos) ? "." : fileName.substr(0, std::max<size_t>(slashPos, 1));
+    baseName = (slashPos == std::string::npos) ? fileName : fileName.substr(slashPos + 1);
+}
+
+// true when one of the events of the buffer is about the file
+bool HasFileEvent(const char *buffer, ssize_t length, const std::string &baseName)
+{
+    bool hasEvent = false;
+    for (ssize_t pos = 0; pos < length;) {
+        const struct inotify_event *event = reinterpret_cast<const struct inotify_event *>(buffer + pos);
+        if (event->len != 0 && baseName == event->name) {
+            hasEvent = true;
+        }
+        pos += sizeof(struct inotify_event) + event->len;
+    }
+    return hasEvent;
+}
+
+std::string GetValue(const std::map<std::string, std::string> &values, const std::string &key)
+{
+    auto iter = values.find(key);
+    return (iter == values.end()) ? "<none>" : iter->second;
+}
+}
+
+std::shared_ptr<ConfigWatcher> ConfigWatcher::GetInstance()
+{
+    static std::shared_ptr<ConfigWatcher> instance(new ConfigWatcher());
+    return instance;
+}
+
+ConfigWatcher::~ConfigWatcher()
+{
+    Stop();
+}
+
+APP_ERROR ConfigWatcher::Start(const std::string &fileName)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (thread_.joinable()) {
+        return APP_ERR_OK;
+    }
+    std::shared_ptr<ConfigParser> config = std::make_shared<ConfigParser>();
+    APP_ERROR ret = config->ParseConfig(fileName);
+    if (ret != APP_ERR_OK) {
+        LogError << "ConfigWatcher: fail to parse " << fileName << ".";
+        return ret;
+    }
+    std::string dirName;
+    std::string baseName;
+    SplitPath(fileName, dirName, baseName);
+    int inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0) {
+        LogError << "ConfigWatcher: fail to init inotify, " << strerror(errno) << ".";
+        return APP_ERR_COMM_FAILURE;
+    }
+    // an editor writes the file in place (IN_CLOSE_WRITE) or renames a new one over it (IN_MOVED_TO)
+    if (inotify_add_watch(inotifyFd, dirName.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        LogError << "ConfigWatcher: fail to watch " << dirName << ", " << strerror(errno) << ".";
+        close(inotifyFd);
+        return APP_ERR_COMM_FAILURE;
+    }
+    fileName_ = fileName;
+    std::atomic_store(&config_, std::shared_ptr<const ConfigParser>(config));
+    isStop_ = false;
+    thread_ = std::thread(&ConfigWatcher::WatchThread, this, inotifyFd);
+    LogInfo << "ConfigWatcher: watching " << fileName << ".";
+    return APP_ERR_OK;
+}
+
+void ConfigWatcher::Stop()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!thread_.joinable()) {
+        return;
+    }
+    isStop_ = true;
+    thread_.join();
+}
+
+std::shared_ptr<const ConfigParser> ConfigWatcher::GetConfig() const
+{
+    return std::atomic_load(&config_);
+}
+
+void ConfigWatcher::WatchThread(int inotifyFd)
+{
+    std::string dirName;
+    std::string baseName;
+    SplitPath(fileName_, dirName, baseName);
+    alignas(struct inotify_event) char buffer[INOTIFY_BUFFER_SIZE];
+    struct pollfd pollFd = { inotifyFd, POLLIN, 0 };
+    bool isChanged = false;
+    while (!isStop_) {
+        // once the file changed, wait for the writes following closely and reload when they stop
+        int ready = poll(&pollFd, 1, isChanged ? CONFIG_RELOAD_DELAY_MS : CONFIG_POLL_MS);
+        if (ready > 0) {
+            ssize_t length = 0;
+            while ((length = read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+                isChanged = HasFileEvent(buffer, length, baseName) || isChanged;
+            }
+        } else if (ready == 0 && isChanged) {
+            isChanged = false;
+            Reload();
+        }
+    }
+    close(inotifyFd);
+}
+
+APP_ERROR ConfigWatcher::Reload()
+{
+    std::lock_guard<std::mutex> reloadLock(reloadMutex_);
+    std::shared_ptr<const ConfigParser> oldConfig = GetConfig();
+    if (oldConfig == nullptr) {
+        return APP_ERR_COMM_NO_EXIST;
+    }
+    std::shared_ptr<ConfigParser> newConfig = std::make_shared<ConfigParser>();
+    APP_ERROR ret = newConfig->ParseConfig(fileName_);
+    if (ret != APP_ERR_OK) {
+        LogWarn << "ConfigWatcher: fail to parse " << fileName_ << ", the config is kept.";
+        return ret;
+    }
+    std::atomic_store(&config_, std::shared_ptr<const ConfigParser>(newConfig));
+
+    const std::map<std::string, std::string> &oldValues = oldConfig->GetAllValues();
+    const std::map<std::string, std::string> &newValues = newConfig->GetAllValues();
+    std::map<std::string, bool> changedKeys; // true once a callback is registered for the key
+    for (auto &item : newValues) {
+        auto oldIter = oldValues.find(item.first);
+        if (oldIter == oldValues.end() || oldIter->second != item.second) {
+            changedKeys[item.first] = false;
+        }
+    }
+    for (auto &item : oldValues) {
+        if (newValues.find(item.first) == newValues.end()) {
+            changedKeys[item.first] = false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(watchMutex_);
+    for (auto &watch : watches_) {
+        bool isChanged = false;
+        for (auto &key : watch.second.keys) {
+            auto iter = changedKeys.find(key);
+            if (iter != changedKeys.end()) {
+                iter->second = true;
+                isChanged = true;
+            }
+        }
+        if (isChanged) {
+            watch.second.callback(*newConfig);
+        }
+    }
+    for (auto &item : changedKeys) {
+        LogInfo << "ConfigWatcher: " << item.first << " changed from " << GetValue(oldValues, item.first) << " to "
+                << GetValue(newValues, item.first)
+                << (item.second ? ", applied." : ", applied at the next start.");
+    }
+    return APP_ERR_OK;
+}
+
+ConfigWatchId ConfigWatcher::Register(const std::vector<std::string> &keys, ConfigCallback callback)
+{
+    std::lock_guard<std::mutex> lock(watchMutex_);
+    ConfigWatchId id = nextWatchId_++;
+    watches_[id] = { keys, callback };
+    return id;
+}
+
+void ConfigWatcher::Unregister(ConfigWatchId id)
+{
+    std::lock_guard<std::mutex> lock(watchMutex_);
+    watches_.erase(id);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CONFIG_WATCHER_H
+#define CONFIG_WATCHER_H
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConfigParser/ConfigParser.h"
+#include "ErrorCode/ErrorCode.h"
+
+const uint32_t CONFIG_RELOAD_DELAY_MS = 100; // writes closer together than this are reloaded once
+const uint32_t CONFIG_POLL_MS = 200;         // the watcher sees Stop within this time
+
+// called with the new config when the value of one of the keys it was registered for changed, was added or removed
+using ConfigCallback = std::function<void(const ConfigParser &config)>;
+using ConfigWatchId = uint64_t;
+
+// the config file reloaded when it is written or replaced: every reload is parsed into a new ConfigParser published
+// at once, so a reader of GetConfig sees either the old values or the new ones and keeps its snapshot as long as it
+// holds the pointer; the callbacks of the changed keys are called one after the other in the thread of the watcher
+class ConfigWatcher {
+public:
+    static std::shared_ptr<ConfigWatcher> GetInstance();
+    ~ConfigWatcher();
+    // parse the file and watch its directory with inotify, so that the editors replacing the file are seen too;
+    // does nothing when already started
+    APP_ERROR Start(const std::string &fileName);
+    void Stop();
+    // nullptr until Start
+    std::shared_ptr<const ConfigParser> GetConfig() const;
+    // the config is parsed again and the callbacks of the changed keys are called; a file which cannot be read
+    // keeps the current config
+    APP_ERROR Reload();
+    // the callback must not call Register or Unregister; once Unregister returns it is not called any more
+    ConfigWatchId Register(const std::vector<std::string> &keys, ConfigCallback callback);
+    void Unregister(ConfigWatchId id);
+
+private:
+    struct Watch {
+        std::vector<std::string> keys;
+        ConfigCallback callback;
+    };
+
+    ConfigWatcher() {}
+    void WatchThread(int inotifyFd);
+
+    std::shared_ptr<const ConfigParser> config_ = nullptr; // std::atomic_load and std::atomic_store only
+    std::mutex mutex_ = {};                                // Start and Stop
+    std::mutex reloadMutex_ = {};
+    std::mutex watchMutex_ = {};                           // watches_, held while the callbacks run
+    std::map<ConfigWatchId, Watch> watches_ = {};
+    ConfigWatchId nextWatchId_ = 1;
+    std::string fileName_ = "";
+    std::thread thread_ = {};
+    std::atomic<bool> isStop_ = {};
+};
+
+#endif
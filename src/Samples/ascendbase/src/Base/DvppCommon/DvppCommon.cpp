@@ -17,6 +17,7 @@
 #include <memory>
 
 #include "Log/Log.h"
+#include "Statistic/Statistic.h"
 #include "DvppCommon.h"
 #include "CommonDataType/CommonDataType.h"
 
@@ -1098,6 +1099,7 @@ APP_ERROR DvppCommon::CreateStreamDesc(std::shared_ptr<DvppDataInfo> data)
  */
 APP_ERROR DvppCommon::CombineVdecProcess(std::shared_ptr<DvppDataInfo> data, void *userData)
 {
+    PROBE("DvppCommon.CombineVdecProcess");
     // Return special error code when the DvppCommon object is not initialized with InitVdec
     if (!isVdec_) {
         LogError << "CombineVdecProcess cannot be called by the DvppCommon object which is not initialized with InitVdec.";
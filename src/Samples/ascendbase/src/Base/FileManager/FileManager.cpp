@@ -508,11 +508,11 @@ APP_ERROR SaveFileWithTimeStamp(std::shared_ptr<void> dataBuffer, uint32_t buffe
     // Result file name use the time stamp as a suffix
     struct timeval time = { 0, 0 };
     gettimeofday(&time, nullptr);
-    const int TIME_DIFF_S = 28800; // 8 hour time difference
     const int TIME_STRING_SIZE = 32;
     char timeString[TIME_STRING_SIZE] = {0};
-    time_t timeVal = time.tv_sec + TIME_DIFF_S;
-    struct tm *ptm = gmtime(&timeVal);
+    time_t timeVal = time.tv_sec + AtlasAscendLog::Log::GetUtcOffset();
+    struct tm tmBuf = {};
+    struct tm *ptm = gmtime_r(&timeVal, &tmBuf);
     if (ptm != nullptr) {
         strftime(timeString, sizeof(timeString), "%Y%m%d%H%M%S", ptm);
     }
@@ -15,15 +15,30 @@
  */
 
 #include "ModuleBase.h"
+#include <algorithm>
 #include "Log/Log.h"
+#include "ModuleManager/ModuleExecutor.h"
+#include "ModuleManager/ReorderBuffer.h"
 #include "BlockingQueue/BlockingQueue.h"
 #include "ErrorCode/ErrorCode.h"
-#include <sys/time.h>
 #include "Statistic/Statistic.h"
+#include "Tracer/Tracer.h"
+#include "Metrics/Metrics.h"
 
 namespace ascendBaseModule {
 const int INPUTQUEUE_WARN_SIZE = 32;
-const double TIME_COUNTS = 1000.0;
+const double NS_PER_MS = 1000000.0;
+const uint64_t NS_PER_US = 1000;
+const int EXECUTOR_TASK_BUDGET = 32; // max items processed before the executor worker is given back
+const int RETIRE_POLL_MS = 1;
+
+namespace {
+// the instance processing sequenced messages on this thread, what it sends goes to g_heldMessages
+thread_local ModuleBase *g_holdingModule = nullptr;
+thread_local std::vector<HeldMessage> *g_heldMessages = nullptr;
+// time spent in ProcessFused on this thread, taken out of the Process time of the sender
+thread_local int64_t g_fusedCostNs = 0;
+}
 
 void ModuleBase::AssignInitArgs(ModuleInitArgs &initArgs)
 {
@@ -34,13 +49,32 @@ void ModuleBase::AssignInitArgs(ModuleInitArgs &initArgs)
     pipelineName_ = initArgs.pipelineName;
     moduleName_ = initArgs.moduleName;
     instanceId_ = initArgs.instanceId;
+    threadPolicy_ = initArgs.threadPolicy;
     isStop_ = false;
+    isRetired_ = false;
 }
 
 // run module instance in a new thread created
 APP_ERROR ModuleBase::Run()
 {
     LogDebug << moduleName_ << "[" << instanceId_ << "] Run";
+    BindOutputPorts();
+    traceNameId_ = Tracer::RegisterName(moduleName_);
+    BindMetrics();
+    if (isFusedInput_) {
+        LogDebug << moduleName_ << "[" << instanceId_ << "] runs in the thread of its sender";
+        return APP_ERR_OK;
+    }
+    // a module without input queue loops in Process, it keeps its own thread
+    if (executor_ != nullptr && !withoutInputQueue_) {
+        if (inputQueue_ == nullptr) {
+            LogFatal << "Invalid input queue of " << moduleName_ << "[" << instanceId_ << "].";
+            return APP_ERR_COMM_INVALID_POINTER;
+        }
+        isScheduled_.store(false);
+        NotifyInput();
+        return APP_ERR_OK;
+    }
     processThr_ = std::thread(&ModuleBase::ProcessThread, this);
     return APP_ERR_OK;
 }
@@ -57,6 +91,9 @@ void ModuleBase::ProcessThread()
         return;
     }
 #endif
+    std::string threadName = moduleName_ + "[" + std::to_string(instanceId_) + "]";
+    ApplyThreadPolicy(threadPolicy_, threadName);
+    Tracer::SetThreadName(threadName);
     // if the module has no input queue, call Process function directly.
     if (withoutInputQueue_ == true) {
         ret = Process(nullptr);
@@ -72,15 +109,24 @@ void ModuleBase::ProcessThread()
     }
     LogDebug << "Input queue for " << moduleName_ << "[" << instanceId_ << "], inputQueue=" << inputQueue_;
     // repeatly pop data from input queue and call the Process funtion. Results will be pushed to output queues.
+    if (batchSize_ > 1) {
+        ProcessBatchLoop();
+        LogInfo << moduleName_ << "[" << instanceId_ << "] process thread End";
+        return;
+    }
     while (!isStop_) {
         std::shared_ptr<void> frameInfo = nullptr;
         ret = inputQueue_->Pop(frameInfo);
         if (ret == APP_ERR_QUEUE_STOPED) {
             LogDebug << moduleName_ << "[" << instanceId_ << "] input queue Stopped";
             break;
+        } else if (ret == APP_ERR_OK && frameInfo == nullptr && isRetired_) {
+            // pushed by Retire after the messages to process
+            LogDebug << moduleName_ << "[" << instanceId_ << "] retired";
+            break;
         } else if (ret != APP_ERR_OK || frameInfo == nullptr) {
-            LogError << "Fail to get data from input queue for " << moduleName_ << "[" << instanceId_ << "]"
-                     << ", ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ").";
+            LogErrorLimited(AtlasAscendLog::LOG_FRAME_RATE_LIMIT) << "Fail to get data from input queue for "
+                << moduleName_ << "[" << instanceId_ << "]" << ", ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ").";
             continue;
         }
         CallProcess(frameInfo);
@@ -88,16 +134,111 @@ void ModuleBase::ProcessThread()
     LogInfo << moduleName_ << "[" << instanceId_ << "] process thread End";
 }
 
+// pop up to batchSize_ items at once so that the synchronization of the input queue is paid once per batch
+void ModuleBase::ProcessBatchLoop()
+{
+    LogDebug << moduleName_ << "[" << instanceId_ << "] batchSize=" << batchSize_ << ", batchTimeoutMs="
+             << batchTimeoutMs_;
+    std::vector<std::shared_ptr<void>> inputDatas;
+    inputDatas.reserve(batchSize_);
+    while (!isStop_) {
+        APP_ERROR ret = inputQueue_->PopBatch(inputDatas, batchSize_, batchTimeoutMs_);
+        if (ret == APP_ERR_QUEUE_STOPED) {
+            LogDebug << moduleName_ << "[" << instanceId_ << "] input queue Stopped";
+            break;
+        } else if (ret != APP_ERR_OK || inputDatas.empty()) {
+            LogErrorLimited(AtlasAscendLog::LOG_FRAME_RATE_LIMIT) << "Fail to get data from input queue for "
+                << moduleName_ << "[" << instanceId_ << "]" << ", ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ").";
+            continue;
+        }
+        // the nullptr pushed by Retire comes after the messages to process
+        bool isRetireMark = isRetired_ && std::find(inputDatas.begin(), inputDatas.end(), nullptr) != inputDatas.end();
+        inputDatas.erase(std::remove(inputDatas.begin(), inputDatas.end(), nullptr), inputDatas.end());
+        if (!inputDatas.empty()) {
+            CallProcessBatch(inputDatas);
+        }
+        if (isRetireMark) {
+            LogDebug << moduleName_ << "[" << instanceId_ << "] retired";
+            break;
+        }
+    }
+}
+
+APP_ERROR ModuleBase::ProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas)
+{
+    APP_ERROR result = APP_ERR_OK;
+    for (auto &inputData : inputDatas) {
+        APP_ERROR ret = Process(std::move(inputData));
+        if (ret != APP_ERR_OK) {
+            result = ret;
+        }
+    }
+    return result;
+}
+
+void ModuleBase::CallProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas)
+{
+    bool isTraced = Tracer::IsEnabled();
+    int64_t traceBeginNs = 0;
+    if (isTraced) {
+        for (auto &inputData : inputDatas) {
+            Tracer::FlowEnd(inputData.get());
+        }
+        traceBeginNs = Tracer::Begin();
+    }
+    int64_t fusedCostNs = g_fusedCostNs;
+    uint64_t startTicks = ProbeClock::Now();
+    APP_ERROR ret = (reorderBuffer_ == nullptr) ? ProcessBatch(inputDatas) : ProcessInOrder(inputDatas, true);
+    int64_t costNs = ProbeClock::ToNs(ProbeClock::Now() - startTicks);
+    if (isTraced) {
+        Tracer::End(traceNameId_, instanceId_, traceBeginNs);
+    }
+    double costMs = costNs / NS_PER_MS;
+    AddProcessStat(costNs - (g_fusedCostNs - fusedCostNs));
+    int queueSize = inputQueue_->GetSize();
+    if (messageInMetric_ != nullptr) {
+        messageInMetric_->Add(inputDatas.size());
+        queueDepthMetric_->Set(queueSize);
+    }
+    if (queueSize > INPUTQUEUE_WARN_SIZE) {
+        LogWarn << "[Statistic] [Module] [" << moduleName_ << "] [" << instanceId_ << "] [QueueSize] [" << queueSize <<
+            "] [ProcessBatch] [" << inputDatas.size() << "] [" << costMs << " ms]";
+    }
+
+    if (ret != APP_ERR_OK) {
+        LogError << "Fail to process batch data for " << moduleName_ << "[" << instanceId_ << "]"
+                 << ", ret=" << ret << "(" << GetAppErrCodeInfo(ret) << ").";
+    }
+}
+
 void ModuleBase::CallProcess(std::shared_ptr<void> &frameAiInfo)
 {
-    struct timeval startTime = { 0, 0 };
-    struct timeval endTime = { 0, 0 };
-    gettimeofday(&startTime, nullptr);
-    APP_ERROR ret = Process(frameAiInfo);
-    gettimeofday(&endTime, nullptr);
-    double costMs =
-        (endTime.tv_sec - startTime.tv_sec) * TIME_COUNTS + (endTime.tv_usec - startTime.tv_usec) / TIME_COUNTS;
+    bool isTraced = Tracer::IsEnabled();
+    int64_t traceBeginNs = 0;
+    if (isTraced) {
+        Tracer::FlowEnd(frameAiInfo.get());
+        traceBeginNs = Tracer::Begin();
+    }
+    int64_t fusedCostNs = g_fusedCostNs;
+    uint64_t startTicks = ProbeClock::Now();
+    APP_ERROR ret = APP_ERR_OK;
+    if (reorderBuffer_ == nullptr) {
+        ret = Process(std::move(frameAiInfo));
+    } else {
+        std::vector<std::shared_ptr<void>> inputDatas(1, std::move(frameAiInfo));
+        ret = ProcessInOrder(inputDatas, false);
+    }
+    int64_t costNs = ProbeClock::ToNs(ProbeClock::Now() - startTicks);
+    if (isTraced) {
+        Tracer::End(traceNameId_, instanceId_, traceBeginNs);
+    }
+    double costMs = costNs / NS_PER_MS;
+    AddProcessStat(costNs - (g_fusedCostNs - fusedCostNs));
     int queueSize = inputQueue_->GetSize();
+    if (messageInMetric_ != nullptr) {
+        messageInMetric_->Add();
+        queueDepthMetric_->Set(queueSize);
+    }
     if (queueSize > INPUTQUEUE_WARN_SIZE) {
         LogWarn << "[Statistic] [Module] [" << moduleName_ << "] [" << instanceId_ << "] [QueueSize] [" << queueSize <<
             "] [Process] [" << costMs << " ms]";
@@ -109,20 +250,308 @@ void ModuleBase::CallProcess(std::shared_ptr<void> &frameAiInfo)
     }
 }
 
-void ModuleBase::SetOutputInfo(std::string moduleName, ModuleConnectType connectType,
-    std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> outputQueVec)
+void ModuleBase::BindMetrics()
+{
+    std::shared_ptr<MetricsRegistry> registry = MetricsRegistry::GetInstance();
+    MetricLabels labels = { { "module", moduleName_ }, { "instance", std::to_string(instanceId_) } };
+    queueDepthMetric_ = registry->GetGauge("ascend_module_queue_depth",
+        "Size of the input queue after the last Process call.", labels);
+    latencyMetric_ = registry->GetHistogram("ascend_module_process_latency_us",
+        "Time spent in one Process or ProcessBatch call, in microseconds.", labels);
+    messageInMetric_ = registry->GetCounter("ascend_module_messages_in_total",
+        "Messages given to Process or ProcessBatch.", labels);
+    messageOutMetric_ = registry->GetCounter("ascend_module_messages_out_total",
+        "Messages sent to the next modules, dropped ones included.", labels);
+    processProbe_ = Statistic::GetProbe(moduleName_);
+}
+
+// the dropped message of MODULE_OVERLOAD_DROP_OLDEST and MODULE_OVERLOAD_LATEST_ONLY is a queued one, it is counted
+// on the channel of the message which took its place, the same one when every channel has its own receiver
+void ModuleBase::CountDrop(ModuleOutputInfo &outputInfo, int channelId)
+{
+    if (messageOutMetric_ == nullptr) {
+        return;
+    }
+    std::shared_ptr<MetricCounter> dropMetric = nullptr;
+    {
+        // the module may send on the port from several threads, the vdec callback of VideoDecoder for one
+        std::lock_guard<std::mutex> locker(dropMetricMutex_);
+        std::shared_ptr<MetricCounter> &channelMetric = outputInfo.dropMetrics[channelId];
+        if (channelMetric == nullptr) {
+            MetricLabels labels = { { "module", moduleName_ }, { "instance", std::to_string(instanceId_) },
+                { "next", outputInfo.moduleName }, { "channel", std::to_string(channelId) } };
+            channelMetric = MetricsRegistry::GetInstance()->GetCounter("ascend_module_messages_dropped_total",
+                "Messages dropped by the overload policy of the connection to the next module.", labels);
+        }
+        dropMetric = channelMetric;
+    }
+    dropMetric->Add();
+}
+
+void ModuleBase::AddProcessStat(int64_t costNs)
+{
+    costNs = (costNs > 0) ? costNs : 0;
+    processCount_.fetch_add(1, std::memory_order_relaxed);
+    processTimeNs_.fetch_add(costNs, std::memory_order_relaxed);
+    if (latencyMetric_ != nullptr) {
+        latencyMetric_->Record(costNs / NS_PER_US);
+    }
+    if (processProbe_ != nullptr && Statistic::statisticEnable.load(std::memory_order_relaxed)) {
+        processProbe_->Record(costNs);
+    }
+}
+
+void ModuleBase::GetProcessStat(uint64_t &processCount, uint64_t &processTimeUs) const
+{
+    processCount = processCount_.load(std::memory_order_relaxed);
+    processTimeUs = processTimeNs_.load(std::memory_order_relaxed) / NS_PER_US;
+}
+
+// the inputs are SequencedMessage, what Process sends is held and sent in the order of the sequences;
+// a message sent on a channel belongs to the last input of that channel, or to the last input if there is none
+APP_ERROR ModuleBase::ProcessInOrder(std::vector<std::shared_ptr<void>> &inputDatas, bool isBatch)
 {
-    if (outputQueVec.size() == 0) {
-        LogFatal << "outputQueVec is Empty! " << moduleName;
+    std::vector<SequencedMessage> sequences;
+    sequences.reserve(inputDatas.size());
+    for (auto &inputData : inputDatas) {
+        std::shared_ptr<SequencedMessage> message = std::static_pointer_cast<SequencedMessage>(inputData);
+        inputData = std::move(message->data);
+        sequences.push_back({ message->channelId, message->sequence, nullptr });
+    }
+
+    std::vector<HeldMessage> heldMessages;
+    ModuleBase *lastModule = g_holdingModule;
+    std::vector<HeldMessage> *lastMessages = g_heldMessages;
+    g_holdingModule = this;
+    g_heldMessages = &heldMessages;
+    APP_ERROR ret = isBatch ? ProcessBatch(inputDatas) : Process(std::move(inputDatas[0]));
+    g_holdingModule = lastModule;
+    g_heldMessages = lastMessages;
+
+    std::vector<std::vector<HeldMessage>> messagesOfSequence(sequences.size());
+    for (auto &heldMessage : heldMessages) {
+        size_t index = sequences.size() - 1;
+        for (size_t i = sequences.size(); i > 0; i--) {
+            if (sequences[i - 1].channelId == heldMessage.channelId) {
+                index = i - 1;
+                break;
+            }
+        }
+        messagesOfSequence[index].push_back(std::move(heldMessage));
+    }
+    for (size_t i = 0; i < sequences.size(); i++) {
+        ReleaseInOrder(sequences[i].channelId, sequences[i].sequence, messagesOfSequence[i]);
+    }
+    return ret;
+}
+
+// the instance which completes the next sequence of the channel sends everything ready, the others only store
+void ModuleBase::ReleaseInOrder(int channelId, uint64_t sequence, std::vector<HeldMessage> &messages)
+{
+    if (!reorderBuffer_->Complete(channelId, sequence, messages)) {
         return;
     }
+    std::vector<HeldMessage> readyMessages;
+    while (reorderBuffer_->TakeReady(channelId, readyMessages)) {
+        for (auto &readyMessage : readyMessages) {
+            RouteToPort(readyMessage.portId, readyMessage.data, readyMessage.channelId);
+        }
+        readyMessages.clear();
+    }
+}
+
+// called by an executor worker, process a limited number of items then give the worker back
+void ModuleBase::RunTask()
+{
+    {
+        std::lock_guard<std::mutex> lock(taskMutex_);
+        std::vector<std::shared_ptr<void>> inputDatas;
+        std::shared_ptr<void> frameInfo = nullptr;
+        for (int i = 0; i < EXECUTOR_TASK_BUDGET && !isStop_; i++) {
+            if (inputQueue_->Pop(frameInfo, 0) != APP_ERR_OK) {
+                break;
+            }
+            if (frameInfo == nullptr) {
+                continue;
+            }
+            if (batchSize_ <= 1) {
+                CallProcess(frameInfo);
+                continue;
+            }
+            inputDatas.push_back(std::move(frameInfo));
+            if (inputDatas.size() >= batchSize_) {
+                CallProcessBatch(inputDatas);
+                inputDatas.clear();
+            }
+        }
+        if (!inputDatas.empty()) {
+            CallProcessBatch(inputDatas);
+        }
+    }
+
+    // a sender which pushed after the last Pop saw isScheduled_ still set, so check the queue again
+    isScheduled_.store(false);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!isStop_ && inputQueue_->GetSize() > 0 && !isScheduled_.exchange(true)) {
+        executor_->Submit(this, true);
+    }
+}
+
+void ModuleBase::SetExecutor(ModuleExecutor *executor)
+{
+    executor_ = executor;
+    // what the senders push before Run is scheduled by Run, once the output ports are bound
+    isScheduled_ = true;
+}
+
+void ModuleBase::SetReorderBuffer(std::shared_ptr<ReorderBuffer> reorderBuffer)
+{
+    reorderBuffer_ = reorderBuffer;
+}
 
+void ModuleBase::SetFusedInput(bool isFusedInput)
+{
+    isFusedInput_ = isFusedInput;
+}
+
+bool ModuleBase::IsFusedInput() const
+{
+    return isFusedInput_;
+}
+
+void ModuleBase::ProcessFused(std::shared_ptr<void> &inputData)
+{
+    std::lock_guard<std::mutex> lock(fusedMutex_);
+    if (isStop_) {
+        return;
+    }
+    // the nested fused calls are already part of this one
+    int64_t fusedCostNs = g_fusedCostNs;
+    uint64_t startTicks = ProbeClock::Now();
+    CallProcess(inputData);
+    g_fusedCostNs = fusedCostNs + ProbeClock::ToNs(ProbeClock::Now() - startTicks);
+}
+
+void ModuleBase::NotifyInput()
+{
+    if (executor_ == nullptr || withoutInputQueue_) {
+        return;
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!isScheduled_.exchange(true)) {
+        executor_->Submit(this);
+    }
+}
+
+// an executor worker never sleeps on a full queue, the receiver may need this very worker to drain it
+APP_ERROR ModuleBase::PushToQueue(ModuleOutputInfo &outputInfo, uint32_t index, std::shared_ptr<void> &outputData,
+    int channelId)
+{
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> &outputQueue = outputInfo.outputQueVec[index];
+    if (outputInfo.isFused && index < outputInfo.receiverVec.size()) {
+        outputInfo.receiverVec[index]->ProcessFused(outputData);
+        return APP_ERR_OK;
+    }
+    APP_ERROR ret = APP_ERR_OK;
+    if (outputInfo.overloadPolicy != MODULE_OVERLOAD_BLOCK) {
+        ret = PushOrDrop(outputInfo, index, outputData, channelId);
+    } else if (!ModuleExecutor::IsWorkerThread()) {
+        ret = outputQueue->Push(std::move(outputData), true);
+    } else {
+        while ((ret = outputQueue->Push(std::move(outputData), false)) == APP_ERROR_QUEUE_FULL && !isStop_) {
+            if (index < outputInfo.receiverVec.size()) {
+                outputInfo.receiverVec[index]->NotifyInput();
+            }
+            if (!ModuleExecutor::RunPendingTask()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    if (ret != APP_ERR_QUEUE_STOPED && index < outputInfo.receiverVec.size()) {
+        outputInfo.receiverVec[index]->NotifyInput();
+    }
+    return ret;
+}
+
+// the sender never waits for the receiver, every message dropped is counted on the receiver instance and the channel
+APP_ERROR ModuleBase::PushOrDrop(ModuleOutputInfo &outputInfo, uint32_t index, std::shared_ptr<void> &outputData,
+    int channelId)
+{
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> &outputQueue = outputInfo.outputQueVec[index];
+    std::shared_ptr<void> oldestData = nullptr;
+    APP_ERROR ret = APP_ERR_OK;
+    while (!isStop_ && (ret = outputQueue->Push(std::move(outputData), false)) == APP_ERROR_QUEUE_FULL) {
+        // the receiver may have emptied the queue meanwhile, then nothing is dropped and the push is retried
+        if (outputInfo.overloadPolicy != MODULE_OVERLOAD_DROP_NEWEST &&
+            outputQueue->Pop(oldestData, 0) != APP_ERR_OK) {
+            continue;
+        }
+        uint64_t dropCount = ++(*outputInfo.dropCounts)[index];
+        CountDrop(outputInfo, channelId);
+        if (dropCount == 1) {
+            LogWarn << moduleName_ << "[" << instanceId_ << "] starts dropping messages to " << outputInfo.moduleName
+                    << "[" << index << "], channel=" << channelId << ", policy=" << outputInfo.overloadPolicy;
+        }
+        if (outputInfo.overloadPolicy == MODULE_OVERLOAD_DROP_NEWEST) {
+            return APP_ERR_OK;
+        }
+        oldestData = nullptr;
+    }
+    return ret;
+}
+
+void ModuleBase::SetOutputInfo(std::string moduleName, ModuleConnectType connectType,
+    std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> outputQueVec,
+    std::vector<ModuleBase *> receiverVec)
+{
     ModuleOutputInfo outputInfo;
     outputInfo.moduleName = moduleName;
     outputInfo.connectType = connectType;
     outputInfo.outputQueVec = outputQueVec;
-    outputInfo.outputQueVecSize = outputQueVec.size();
-    outputQueMap_[moduleName] = outputInfo;
+    outputInfo.receiverVec = receiverVec;
+    SetOutputInfo(outputInfo);
+}
+
+void ModuleBase::SetOutputInfo(ModuleOutputInfo outputInfo)
+{
+    if (outputInfo.outputQueVec.size() == 0) {
+        LogFatal << "outputQueVec is Empty! " << outputInfo.moduleName;
+        return;
+    }
+    outputInfo.outputQueVecSize = outputInfo.outputQueVec.size();
+    if (outputInfo.dropCounts == nullptr || outputInfo.dropCounts->size() != outputInfo.outputQueVecSize) {
+        outputInfo.dropCounts = std::make_shared<DropCountVec>(outputInfo.outputQueVecSize);
+    }
+
+    auto iter = outputPortMap_.find(outputInfo.moduleName);
+    if (iter != outputPortMap_.end()) {
+        outputPorts_[iter->second] = outputInfo;
+        return;
+    }
+    outputPortMap_[outputInfo.moduleName] = outputPorts_.size();
+    outputPorts_.push_back(outputInfo);
+}
+
+APP_ERROR ModuleBase::GetDropCounts(const std::string &moduleNext, std::vector<uint64_t> &dropCounts) const
+{
+    PortId portId = GetOutputPort(moduleNext);
+    if (portId == INVALID_PORT_ID) {
+        return APP_ERR_COMM_NO_EXIST;
+    }
+    dropCounts.clear();
+    for (auto &dropCount : *outputPorts_[portId].dropCounts) {
+        dropCounts.push_back(dropCount.load(std::memory_order_relaxed));
+    }
+    return APP_ERR_OK;
+}
+
+PortId ModuleBase::GetOutputPort(const std::string &moduleNext) const
+{
+    auto iter = outputPortMap_.find(moduleNext);
+    if (iter == outputPortMap_.end()) {
+        return INVALID_PORT_ID;
+    }
+    return iter->second;
 }
 
 const std::string ModuleBase::GetModuleName()
@@ -135,49 +564,174 @@ const int ModuleBase::GetInstanceId()
     return instanceId_;
 }
 
-void ModuleBase::SetInputVec(std::shared_ptr<BlockingQueue<std::shared_ptr<void>>> inputQueue)
+void ModuleBase::SetInputVec(std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue)
 {
     inputQueue_ = inputQueue;
 }
 
-void ModuleBase::SendToNextModule(std::string moduleName, std::shared_ptr<void> outputData, int channelId)
+std::shared_ptr<QueueBase<std::shared_ptr<void>>> ModuleBase::GetInputQueue()
+{
+    return inputQueue_;
+}
+
+void ModuleBase::SendToNextModule(const std::string &moduleNext, std::shared_ptr<void> outputData, int channelId)
+{
+    PortId portId = GetOutputPort(moduleNext);
+    if (portId == INVALID_PORT_ID) {
+        LogFatalLimited(AtlasAscendLog::LOG_FRAME_RATE_LIMIT) << "No Next Module " << moduleNext;
+        return;
+    }
+    SendToPort(portId, std::move(outputData), channelId);
+}
+
+void ModuleBase::SendToPort(PortId portId, std::shared_ptr<void> outputData, int channelId)
+{
+    if (reorderBuffer_ != nullptr && g_holdingModule == this) {
+        g_heldMessages->push_back({ portId, std::move(outputData), channelId });
+        return;
+    }
+    RouteToPort(portId, outputData, channelId);
+}
+
+// the receiver instances of an ordered connection share its output ports, any of them may send for the others
+void ModuleBase::RouteToPort(PortId portId, std::shared_ptr<void> &outputData, int channelId)
 {
     if (isStop_) {
         LogDebug << moduleName_ << "[" << instanceId_ << "] is Stopped, can't send to next module";
         return;
     }
 
-    if (outputQueMap_.find(moduleName) == outputQueMap_.end()) {
-        LogFatal << "No Next Module " << moduleName;
+    if (portId < 0 || static_cast<size_t>(portId) >= outputPorts_.size()) {
+        LogFatalLimited(AtlasAscendLog::LOG_FRAME_RATE_LIMIT) << "No Next Module, portId=" << portId;
         return;
     }
+    ModuleOutputInfo &outputInfo = outputPorts_[portId];
+    if (outputInfo.reorderBuffer != nullptr) {
+        std::shared_ptr<SequencedMessage> message = std::make_shared<SequencedMessage>();
+        message->channelId = channelId;
+        message->sequence = outputInfo.reorderBuffer->NextSequence(channelId);
+        message->data = std::move(outputData);
+        outputData = std::move(message);
+    }
+    if (Tracer::IsEnabled()) {
+        Tracer::FlowStart(outputData.get());
+    }
+    if (messageOutMetric_ != nullptr) {
+        messageOutMetric_->Add();
+    }
 
-    auto itr = outputQueMap_.find(moduleName);
-    if (itr == outputQueMap_.end()) {
-        LogFatal << "No Next Module " << moduleName;
-        return;
+    // a receiver retired after activeCount was read has stopped its input queue, the message goes to another one
+    uint32_t index = 0;
+    for (uint32_t i = 0; i <= outputInfo.outputQueVecSize && SelectReceiver(outputInfo, channelId, index); i++) {
+        APP_ERROR ret = PushToQueue(outputInfo, index, outputData, channelId);
+        if (ret != APP_ERR_QUEUE_STOPED || outputInfo.activeCount == nullptr ||
+            index < outputInfo.activeCount->load(std::memory_order_acquire)) {
+            break;
+        }
     }
-    ModuleOutputInfo outputInfo = itr->second;
+    sendCount_++;
+}
 
+// return false if no receiver instance can be chosen
+bool ModuleBase::SelectReceiver(ModuleOutputInfo &outputInfo, int channelId, uint32_t &index)
+{
+    uint32_t queueNum = (outputInfo.activeCount == nullptr) ? outputInfo.outputQueVecSize :
+        outputInfo.activeCount->load(std::memory_order_acquire);
+    // the receiver runs in the thread of this sender only, see ModuleManager::IsFusable
+    if (outputInfo.isFused) {
+        index = static_cast<uint32_t>(instanceId_);
+        return index < outputInfo.outputQueVecSize;
+    }
     if (outputInfo.connectType == MODULE_CONNECT_ONE) {
-        outputInfo.outputQueVec[0]->Push(outputData, true);
+        index = 0;
     } else if (outputInfo.connectType == MODULE_CONNECT_CHANNEL) {
-        uint32_t ch = channelId % outputInfo.outputQueVecSize;
-        if (ch >= outputInfo.outputQueVecSize) {
-            LogFatal << "No Next Module!";
-            return;
+        index = channelId % queueNum;
+        if (index >= outputInfo.outputQueVecSize) {
+            LogFatalLimited(AtlasAscendLog::LOG_FRAME_RATE_LIMIT) << "No Next Module!";
+            return false;
         }
-        outputInfo.outputQueVec[ch]->Push(outputData, true);
     } else if (outputInfo.connectType == MODULE_CONNECT_PAIR) {
-        outputInfo.outputQueVec[instanceId_]->Push(outputData, true);
+        index = instanceId_;
     } else if (outputInfo.connectType == MODULE_CONNECT_RANDOM) {
-        outputInfo.outputQueVec[sendCount_ % outputInfo.outputQueVecSize]->Push(outputData, true);
+        index = sendCount_ % queueNum;
+    } else if (outputInfo.connectType == MODULE_CONNECT_LEAST_LOADED ||
+        outputInfo.connectType == MODULE_CONNECT_LEAST_LOADED_ORDERED) {
+        index = SelectLeastLoaded(outputInfo, queueNum);
+    } else if (outputInfo.connectType == MODULE_CONNECT_POWER_OF_TWO) {
+        index = SelectPowerOfTwo(outputInfo, queueNum);
+    } else {
+        return false;
     }
-    sendCount_++;
+    return true;
+}
+
+// the scan starts at a different instance every time so that the ties are spread
+uint32_t ModuleBase::SelectLeastLoaded(const ModuleOutputInfo &outputInfo, uint32_t queueNum)
+{
+    uint32_t bestIndex = sendCount_ % queueNum;
+    int bestSize = outputInfo.outputQueVec[bestIndex]->GetSize();
+    for (uint32_t i = 1; i < queueNum && bestSize > 0; i++) {
+        uint32_t index = (sendCount_ + i) % queueNum;
+        int size = outputInfo.outputQueVec[index]->GetSize();
+        if (size < bestSize) {
+            bestIndex = index;
+            bestSize = size;
+        }
+    }
+    return bestIndex;
+}
+
+// two queue sizes are read instead of all of them, still far from the imbalance of round-robin
+uint32_t ModuleBase::SelectPowerOfTwo(const ModuleOutputInfo &outputInfo, uint32_t queueNum)
+{
+    if (queueNum == 1) {
+        return 0;
+    }
+    uint32_t first = randomEngine_() % queueNum;
+    uint32_t second = (first + 1 + randomEngine_() % (queueNum - 1)) % queueNum;
+    if (outputInfo.outputQueVec[second]->GetSize() < outputInfo.outputQueVec[first]->GetSize()) {
+        return second;
+    }
+    return first;
 }
 
 // clear input queue and stop the thread of the instance, called before destroy the instance
 APP_ERROR ModuleBase::Stop()
+{
+    return StopInstance(false);
+}
+
+// the messages left in the input queue are moved to another instance by the ModuleManager
+APP_ERROR ModuleBase::Retire()
+{
+    return StopInstance(true);
+}
+
+// the senders stopped choosing the instance, what they pushed before is processed
+void ModuleBase::DrainInput()
+{
+    isRetired_ = true;
+    if (inputQueue_ == nullptr) {
+        return;
+    }
+    if (processThr_.joinable()) {
+        // the process thread stops when it pops it
+        inputQueue_->Push(nullptr, true);
+        processThr_.join();
+        return;
+    }
+    while (executor_ != nullptr && inputQueue_->GetSize() > 0) {
+        NotifyInput();
+        std::this_thread::sleep_for(std::chrono::milliseconds(RETIRE_POLL_MS));
+    }
+}
+
+void ModuleBase::WatchConfig(const std::vector<std::string> &keys, ConfigCallback callback)
+{
+    configWatchIds_.push_back(ConfigWatcher::GetInstance()->Register(keys, callback));
+}
+
+APP_ERROR ModuleBase::StopInstance(bool isRetire)
 {
 #ifdef ASCEND_MODULE_USE_ACL
     APP_ERROR ret = aclrtSetCurrentContext(aclContext_);
@@ -187,17 +741,33 @@ APP_ERROR ModuleBase::Stop()
     }
 #endif
 
-    // stop input queue
-    isStop_ = true;
+    // a retired instance processes its input queue and sends the outputs first, the sends stop after its thread
+    if (isRetire && !withoutInputQueue_) {
+        DrainInput();
+    } else {
+        isStop_ = true;
+    }
 
+    // stop input queue
     if (inputQueue_ != nullptr) {
         inputQueue_->Stop();
     }
 
     if (processThr_.joinable()) {
         processThr_.join();
+    } else if (isFusedInput_) {
+        // wait for the sender running ProcessFused, if any
+        std::lock_guard<std::mutex> lock(fusedMutex_);
+    } else if (executor_ != nullptr) {
+        // wait for the executor worker running the instance, if any
+        std::lock_guard<std::mutex> lock(taskMutex_);
     }
+    isStop_ = true;
 
+    for (auto watchId : configWatchIds_) {
+        ConfigWatcher::GetInstance()->Unregister(watchId);
+    }
+    configWatchIds_.clear();
     return DeInit();
 }
 }
@@ -22,20 +22,48 @@
 #include <vector>
 #include <map>
 #include <atomic>
+#include <mutex>
+#include <random>
+#include <sys/time.h>
 #include "ConfigParser/ConfigParser.h"
+#include "ConfigParser/ConfigWatcher.h"
 #include "BlockingQueue/BlockingQueue.h"
+#include "ThreadPolicy/ThreadPolicy.h"
 #ifdef ASCEND_MODULE_USE_ACL
 #include "acl/acl.h"
 #endif
 
+class MetricCounter;
+class MetricGauge;
+class MetricHistogram;
+class StatisticProbe;
+
 namespace ascendBaseModule {
+class ModuleBase;
+class ModuleExecutor;
+class ReorderBuffer;
+struct HeldMessage;
+
 enum ModuleConnectType {
     MODULE_CONNECT_ONE = 0,
     MODULE_CONNECT_CHANNEL, //
     MODULE_CONNECT_PAIR,    //
-    MODULE_CONNECT_RANDOM   //
+    MODULE_CONNECT_RANDOM,  //
+    MODULE_CONNECT_LEAST_LOADED,        // receiver instance with the shortest input queue
+    MODULE_CONNECT_POWER_OF_TWO,        // shorter input queue of two receiver instances picked at random
+    MODULE_CONNECT_LEAST_LOADED_ORDERED // MODULE_CONNECT_LEAST_LOADED, what the receivers send keeps the channel order
+};
+
+// what the sender does when the input queue of the receiver is full
+enum ModuleOverloadPolicy {
+    MODULE_OVERLOAD_BLOCK = 0,   // wait for room, the sender stalls until the receiver catches up
+    MODULE_OVERLOAD_DROP_NEWEST, // drop the message being sent
+    MODULE_OVERLOAD_DROP_OLDEST, // drop the oldest queued messages to make room
+    MODULE_OVERLOAD_LATEST_ONLY  // queue of one message, a new message replaces the queued one
 };
 
+using DropCountVec = std::vector<std::atomic<uint64_t>>;
+
 struct ModuleInitArguments {
 #ifdef ASCEND_MODULE_USE_ACL
     aclrtRunMode runMode;
@@ -45,18 +73,33 @@ struct ModuleInitArguments {
     std::string moduleName = {};
     int instanceId = -1;
     void *userData = nullptr;
+    ThreadPolicy threadPolicy = {}; // <moduleName>.cpuSet, numaNode and threadPriority
 };
 
 struct ModuleOutputInformation {
     std::string moduleName = "";
     ModuleConnectType connectType = MODULE_CONNECT_RANDOM;
-    std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> outputQueVec = {};
+    std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> outputQueVec = {};
     uint32_t outputQueVecSize = 0;
+    std::vector<ModuleBase *> receiverVec = {}; // instance reading outputQueVec[i], notified after every push
+    ModuleOverloadPolicy overloadPolicy = MODULE_OVERLOAD_BLOCK;
+    std::shared_ptr<DropCountVec> dropCounts = nullptr; // messages dropped per receiver instance, shared by the senders
+    std::shared_ptr<ReorderBuffer> reorderBuffer = nullptr; // MODULE_CONNECT_LEAST_LOADED_ORDERED only
+    // set when the receiver is scaled at runtime, only the first activeCount instances get messages
+    std::shared_ptr<std::atomic<uint32_t>> activeCount = nullptr;
+    // messages this instance dropped per channel, created on the first drop of the channel once Run is called,
+    // under ModuleBase::dropMetricMutex_ as the senders of an instance may drop at the same time
+    std::map<int, std::shared_ptr<MetricCounter>> dropMetrics = {};
+    bool isFused = false; // receiverVec[i]->ProcessFused is called instead of a push to outputQueVec[i]
 };
 
 using ModuleInitArgs = ModuleInitArguments;
 using ModuleOutputInfo = ModuleOutputInformation;
 
+// handle of one output connection, resolved once by GetOutputPort and used by SendToPort on every message
+using PortId = int;
+const PortId INVALID_PORT_ID = -1;
+
 class ModuleBase {
 public:
     ModuleBase() {};
@@ -65,10 +108,36 @@ public:
     virtual APP_ERROR DeInit(void) = 0;
     APP_ERROR Run(void); // create and run process thread
     APP_ERROR Stop(void);
-    void SetInputVec(std::shared_ptr<BlockingQueue<std::shared_ptr<void>>> inputQueue);
+    // stop the instance of a scaled module type once it has processed its input queue, the queue is then stopped
+    // so that the senders which still chose the instance send to another one, what is left in it is for the caller
+    APP_ERROR Retire(void);
+    void SetInputVec(std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue);
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> GetInputQueue();
     void SetOutputInfo(std::string moduleName, ModuleConnectType connectType,
-        std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> outputQueVec);
-    void SendToNextModule(std::string moduleNext, std::shared_ptr<void> outputData, int channelId = 0);
+        std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> outputQueVec,
+        std::vector<ModuleBase *> receiverVec = {});
+    void SetOutputInfo(ModuleOutputInfo outputInfo);
+    // outputData is taken by value, pass it with std::move when the sender does not need it any more
+    void SendToNextModule(const std::string &moduleNext, std::shared_ptr<void> outputData, int channelId = 0);
+    // return INVALID_PORT_ID if the module is not connected to moduleNext
+    PortId GetOutputPort(const std::string &moduleNext) const;
+    void SendToPort(PortId portId, std::shared_ptr<void> outputData, int channelId = 0);
+    // number of messages dropped by the overload policy, one count per receiver instance
+    APP_ERROR GetDropCounts(const std::string &moduleNext, std::vector<uint64_t> &dropCounts) const;
+    // run the instance on the executor instead of its own thread, must be called before Run
+    void SetExecutor(ModuleExecutor *executor);
+    // tell the instance its input queue got data, schedules it on the executor if it is not already
+    void NotifyInput();
+    // set on the receivers of a MODULE_CONNECT_LEAST_LOADED_ORDERED connection, nullptr for any other connection
+    void SetReorderBuffer(std::shared_ptr<ReorderBuffer> reorderBuffer);
+    // set on the receivers of a fused connection, the instance then has no thread and Run does not start one
+    void SetFusedInput(bool isFusedInput);
+    bool IsFusedInput() const;
+    // called by the sender of a fused connection in its own thread, the message is dropped once Stop is called
+    void ProcessFused(std::shared_ptr<void> &inputData);
+    // number of Process or ProcessBatch calls and the time spent in them since the instance was created,
+    // the time spent in the receivers of the fused connections is not counted
+    void GetProcessStat(uint64_t &processCount, uint64_t &processTimeUs) const;
     const std::string GetModuleName();
     const int GetInstanceId();
 
@@ -80,9 +149,37 @@ public:
 
 protected:
     void ProcessThread();
+    void ProcessBatchLoop();
     virtual APP_ERROR Process(std::shared_ptr<void> inputData) = 0;
+    // called instead of Process when batchSize_ is greater than 1, the default one moves every item to Process
+    virtual APP_ERROR ProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas);
     void CallProcess(std::shared_ptr<void> &frameAiInfo);
+    void CallProcessBatch(std::vector<std::shared_ptr<void>> &inputDatas);
     void AssignInitArgs(ModuleInitArgs &initArgs);
+    // called by Run once all the connections are registered, resolve the output ports here
+    virtual void BindOutputPorts() {}
+    // callback called in the thread of ConfigWatcher when one of the keys changes in the config file, with
+    // SystemConfig.configReload set; keep what it reads in atomics read by Process, it is removed before DeInit
+    void WatchConfig(const std::vector<std::string> &keys, ConfigCallback callback);
+
+private:
+    friend class ModuleExecutor;
+    void RunTask();
+    APP_ERROR StopInstance(bool isRetire);
+    void BindMetrics();
+    void AddProcessStat(int64_t costNs);
+    APP_ERROR PushToQueue(ModuleOutputInfo &outputInfo, uint32_t index, std::shared_ptr<void> &outputData,
+        int channelId);
+    APP_ERROR PushOrDrop(ModuleOutputInfo &outputInfo, uint32_t index, std::shared_ptr<void> &outputData,
+        int channelId);
+    bool SelectReceiver(ModuleOutputInfo &outputInfo, int channelId, uint32_t &index);
+    void DrainInput();
+    void CountDrop(ModuleOutputInfo &outputInfo, int channelId);
+    void RouteToPort(PortId portId, std::shared_ptr<void> &outputData, int channelId);
+    uint32_t SelectLeastLoaded(const ModuleOutputInfo &outputInfo, uint32_t queueNum);
+    uint32_t SelectPowerOfTwo(const ModuleOutputInfo &outputInfo, uint32_t queueNum);
+    APP_ERROR ProcessInOrder(std::vector<std::shared_ptr<void>> &inputDatas, bool isBatch);
+    void ReleaseInOrder(int channelId, uint64_t sequence, std::vector<HeldMessage> &messages);
 
 protected:
     int instanceId_ = -1;
@@ -91,12 +188,39 @@ protected:
     int32_t deviceId_ = -1;
     std::thread processThr_ = {};
     std::atomic_bool isStop_ = {};
+    std::atomic_bool isRetired_ = {}; // set by Retire, the instance stops at the end of its input queue
     bool withoutInputQueue_ = false;
-    std::shared_ptr<BlockingQueue<std::shared_ptr<void>>> inputQueue_ = nullptr;
-    std::map<std::string, ModuleOutputInfo> outputQueMap_ = {};
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue_ = nullptr;
+    std::vector<ModuleOutputInfo> outputPorts_ = {};       // indexed by PortId
+    std::map<std::string, PortId> outputPortMap_ = {};     // receiver module name to PortId
     int outputQueVecSize_ = 0;
     ModuleConnectType connectType_ = MODULE_CONNECT_RANDOM;
     int sendCount_ = 0;
+    uint32_t batchSize_ = 1;      // max number of items popped from the input queue at once, set it in Init
+    uint32_t batchTimeoutMs_ = 0; // time to wait for a batch to fill after its first item, 0 means no wait
+    // applied by the process thread, apply it as well in the threads the module creates itself
+    ThreadPolicy threadPolicy_ = {};
+
+private:
+    ModuleExecutor *executor_ = nullptr;
+    std::atomic_bool isScheduled_ = {};
+    std::mutex taskMutex_ = {}; // held while the instance runs on the executor
+    std::shared_ptr<ReorderBuffer> reorderBuffer_ = nullptr;
+    std::minstd_rand randomEngine_ = std::minstd_rand(std::random_device()());
+    std::atomic<uint64_t> processCount_ = {};
+    std::atomic<uint64_t> processTimeNs_ = {};
+    uint16_t traceNameId_ = 0; // name of the events recorded by Tracer
+    bool isFusedInput_ = false;
+    std::mutex fusedMutex_ = {}; // held while a sender runs ProcessFused
+    // labeled with the module name and the instance id in MetricsRegistry, nullptr until Run
+    std::shared_ptr<MetricGauge> queueDepthMetric_ = nullptr;
+    std::shared_ptr<MetricHistogram> latencyMetric_ = nullptr;
+    std::shared_ptr<MetricCounter> messageInMetric_ = nullptr;
+    std::shared_ptr<MetricCounter> messageOutMetric_ = nullptr;
+    std::mutex dropMetricMutex_ = {}; // guards the dropMetrics of every output port
+    // the calls of all the instances of the module, reported by Statistic when it is enabled
+    std::shared_ptr<StatisticProbe> processProbe_ = nullptr;
+    std::vector<ConfigWatchId> configWatchIds_ = {};
 };
 }
 
@@ -0,0 +1,185 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ModuleManager/ModuleExecutor.h"
+#include "ModuleManager/ModuleBase.h"
+#include "Log/Log.h"
+#include "Tracer/Tracer.h"
+
+namespace ascendBaseModule {
+namespace {
+const int MAX_HELP_DEPTH = 8; // nesting limit of RunPendingTask, every level keeps a blocked Process on the stack
+
+thread_local ModuleExecutor *g_currentExecutor = nullptr;
+thread_local uint32_t g_currentWorkerId = 0;
+thread_local int g_helpDepth = 0;
+}
+
+ModuleExecutor::ModuleExecutor() : submitCount_(0), pendingCount_(0), idleCount_(0), isStop_(false) {}
+
+ModuleExecutor::~ModuleExecutor()
+{
+    Stop();
+}
+
+APP_ERROR ModuleExecutor::Start(uint32_t threadNum, std::function<void()> threadInit)
+{
+    if (!workers_.empty()) {
+        LogError << "ModuleExecutor is already started.";
+        return APP_ERR_COMM_FAILURE;
+    }
+    if (threadNum == 0) {
+        threadNum = std::thread::hardware_concurrency();
+    }
+    if (threadNum == 0) {
+        threadNum = 1;
+    }
+
+    isStop_ = false;
+    for (uint32_t i = 0; i < threadNum; i++) {
+        workerQueues_.emplace_back(new WorkerQueue);
+    }
+    for (uint32_t i = 0; i < threadNum; i++) {
+        workers_.emplace_back(&ModuleExecutor::WorkerThread, this, i, threadInit);
+    }
+    LogInfo << "ModuleExecutor started with " << threadNum << " workers.";
+    return APP_ERR_OK;
+}
+
+// the instances must be stopped before, the instances still pending are dropped
+void ModuleExecutor::Stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+        isStop_ = true;
+    }
+    idleCond_.notify_all();
+    for (auto &worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers_.clear();
+    workerQueues_.clear();
+}
+
+void ModuleExecutor::Submit(ModuleBase *module, bool isYield)
+{
+    uint32_t workerId = 0;
+    if (g_currentExecutor == this) {
+        workerId = g_currentWorkerId;
+    } else {
+        workerId = submitCount_.fetch_add(1, std::memory_order_relaxed) % workerQueues_.size();
+    }
+
+    WorkerQueue &workerQueue = *workerQueues_[workerId];
+    {
+        std::lock_guard<std::mutex> lock(workerQueue.mutex);
+        if (isYield) {
+            workerQueue.modules.push_front(module);
+        } else {
+            workerQueue.modules.push_back(module);
+        }
+    }
+
+    // pendingCount_ and idleCount_ are seq_cst, a worker going to sleep either sees the new task or is woken up
+    pendingCount_.fetch_add(1);
+    if (idleCount_.load() > 0) {
+        {
+            std::lock_guard<std::mutex> lock(idleMutex_);
+        }
+        idleCond_.notify_one();
+    }
+}
+
+uint32_t ModuleExecutor::GetThreadNum() const
+{
+    return workers_.size();
+}
+
+bool ModuleExecutor::IsWorkerThread()
+{
+    return g_currentExecutor != nullptr;
+}
+
+bool ModuleExecutor::RunPendingTask()
+{
+    ModuleExecutor *executor = g_currentExecutor;
+    if (executor == nullptr || g_helpDepth >= MAX_HELP_DEPTH) {
+        return false;
+    }
+    ModuleBase *module = executor->TakeTask(g_currentWorkerId);
+    if (module == nullptr) {
+        return false;
+    }
+    g_helpDepth++;
+    module->RunTask();
+    g_helpDepth--;
+    return true;
+}
+
+// newest instance of the own deque first, then the oldest one of the other workers
+ModuleBase *ModuleExecutor::TakeTask(uint32_t workerId)
+{
+    ModuleBase *module = nullptr;
+    size_t workerNum = workerQueues_.size();
+    for (size_t i = 0; i < workerNum && module == nullptr; i++) {
+        WorkerQueue &workerQueue = *workerQueues_[(workerId + i) % workerNum];
+        std::lock_guard<std::mutex> lock(workerQueue.mutex);
+        if (workerQueue.modules.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            module = workerQueue.modules.back();
+            workerQueue.modules.pop_back();
+        } else {
+            module = workerQueue.modules.front();
+            workerQueue.modules.pop_front();
+        }
+    }
+    if (module != nullptr) {
+        pendingCount_.fetch_sub(1);
+    }
+    return module;
+}
+
+void ModuleExecutor::WorkerThread(uint32_t workerId, std::function<void()> threadInit)
+{
+    g_currentExecutor = this;
+    g_currentWorkerId = workerId;
+    if (threadInit != nullptr) {
+        threadInit();
+    }
+    Tracer::SetThreadName("ModuleExecutor worker " + std::to_string(workerId));
+
+    while (!isStop_) {
+        ModuleBase *module = TakeTask(workerId);
+        if (module != nullptr) {
+            module->RunTask();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleMutex_);
+        idleCount_.fetch_add(1);
+        while (pendingCount_.load() <= 0 && !isStop_) {
+            idleCond_.wait(lock);
+        }
+        idleCount_.fetch_sub(1);
+    }
+    g_currentExecutor = nullptr;
+    LogDebug << "ModuleExecutor worker " << workerId << " End";
+}
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_MODULE_EXECUTOR_H
+#define INC_MODULE_EXECUTOR_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ErrorCode/ErrorCode.h"
+
+namespace ascendBaseModule {
+class ModuleBase;
+
+// Fixed pool of worker threads which run the module instances as tasks, used instead of one thread per instance.
+// An instance is submitted when its input queue gets data and is never queued twice, so its items are still
+// processed one after another in the queue order. Every worker owns a deque of ready instances: it runs the
+// newest one first (usually the receiver it has just fed) and steals the oldest one of another worker when
+// its own deque is empty.
+class ModuleExecutor {
+public:
+    ModuleExecutor();
+    ~ModuleExecutor();
+    // threadNum 0 means one worker per core, threadInit is called at the beginning of every worker thread
+    APP_ERROR Start(uint32_t threadNum, std::function<void()> threadInit = nullptr);
+    void Stop();
+    // isYield puts the instance behind the others of the deque, used when it gives the worker back unfinished
+    void Submit(ModuleBase *module, bool isYield = false);
+    uint32_t GetThreadNum() const;
+
+    // true if the calling thread is a worker of an executor
+    static bool IsWorkerThread();
+    // run one pending instance in the calling worker instead of sleeping, return false if there is nothing to run
+    static bool RunPendingTask();
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<ModuleBase *> modules;
+    };
+
+    void WorkerThread(uint32_t workerId, std::function<void()> threadInit);
+    ModuleBase *TakeTask(uint32_t workerId);
+
+private:
+    std::vector<std::unique_ptr<WorkerQueue>> workerQueues_ = {};
+    std::vector<std::thread> workers_ = {};
+    std::atomic<uint32_t> submitCount_;
+    std::atomic<int> pendingCount_;
+    std::atomic<int> idleCount_;
+    std::atomic_bool isStop_;
+    std::mutex idleMutex_ = {};
+    std::condition_variable idleCond_ = {};
+};
+}
+
+#endif
@@ -15,13 +15,40 @@
  */
 
 #include "ModuleManager/ModuleManager.h"
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include "ConfigParser/ConfigWatcher.h"
+#include "ModuleManager/ReorderBuffer.h"
 #include "Log/Log.h"
+#include "Log/BinaryLog.h"
+#include "RingQueue/RingQueue.h"
+#include "Tracer/Tracer.h"
+#include "Metrics/Metrics.h"
+#include "Statistic/Statistic.h"
 #ifdef ASCEND_MODULE_USE_ACL
 #include "ResourceManager/ResourceManager.h"
 #endif
 
 namespace ascendBaseModule {
 const int MODULE_QUEUE_SIZE = 200;
+const uint32_t SCALE_INTERVAL_MS = 1000;   // SystemConfig.autoScaleIntervalMs when omitted
+const uint32_t SCALE_UP_QUEUE_DEPTH = 16;  // <moduleName>.scaleUpQueueDepth when omitted
+const uint32_t SCALE_DOWN_QUEUE_DEPTH = 1; // <moduleName>.scaleDownQueueDepth when omitted
+const uint32_t SCALE_DOWN_ROUNDS = 3;      // rounds at or below the low watermarks before an instance is retired
+const double TIME_COUNTS = 1000.0;
+const int RUN_PASS_COUNT = 2;
+const int SECONDS_PER_MINUTE = 60;
+const size_t HOST_NAME_SIZE = 256;
+const size_t START_TIME_SIZE = 32;
+
+// the commit the binary was built from, defined by the CMakeLists.txt of the sample
+#ifndef ASCEND_GIT_HASH
+#define ASCEND_GIT_HASH "unknown"
+#endif
 
 ModuleManager::ModuleManager() {}
 
@@ -38,11 +65,105 @@ APP_ERROR ModuleManager::Init(std::string &configPath, std::string &aclConfigPat
         return ret;
     }
 
+    SetLogOptions();
+
+    // SystemConfig.logAsync and SystemConfig.logBinary, the log lines and records are written by writer threads
+    // instead of the threads logging them
+    ret = StartLogWriters();
+    if (ret != APP_ERR_OK) {
+        LogFatal << "ModuleManager: fail to start the log writers.";
+        StopServices();
+        return ret;
+    }
+
+    // SystemConfig.traceFile, the Process calls of all the instances are written there by DeInit
+    if (configParser_.GetStringValue("SystemConfig.traceFile", traceFile_) == APP_ERR_OK && !traceFile_.empty()) {
+        uint32_t traceBufferSize = TRACE_BUFFER_SIZE;
+        configParser_.GetUnsignedIntValue("SystemConfig.traceBufferSize", traceBufferSize);
+        ret = Tracer::Start(traceBufferSize);
+        if (ret != APP_ERR_OK) {
+            LogFatal << "ModuleManager: fail to start the tracer.";
+            traceFile_ = "";
+            StopServices();
+            return ret;
+        }
+    }
+
+    SetRunMetadata(configPath);
+
+    // SystemConfig.configReload, the config file is watched and the modules get the keys they watch when it changes
+    bool isConfigReload = false;
+    configParser_.GetBoolValue("SystemConfig.configReload", isConfigReload);
+    if (isConfigReload) {
+        ret = ConfigWatcher::GetInstance()->Start(configPath);
+        if (ret != APP_ERR_OK) {
+            LogFatal << "ModuleManager: fail to watch the config file.";
+            StopServices();
+            return ret;
+        }
+        isConfigWatched_ = true;
+    }
+
+    // SystemConfig.metricsFile and SystemConfig.metricsPort, Prometheus text export of the module metrics, and
+    // SystemConfig.metricsRecordFile, the same metrics appended as JSON Lines or CSV rows for statcompare
+    std::string metricsFile = "";
+    std::string metricsRecordFile = "";
+    uint32_t metricsIntervalMs = METRICS_INTERVAL_MS;
+    uint32_t metricsPort = 0;
+    configParser_.GetStringValue("SystemConfig.metricsFile", metricsFile);
+    configParser_.GetStringValue("SystemConfig.metricsRecordFile", metricsRecordFile);
+    configParser_.GetUnsignedIntValue("SystemConfig.metricsIntervalMs", metricsIntervalMs);
+    configParser_.GetUnsignedIntValue("SystemConfig.metricsPort", metricsPort);
+    if (!metricsFile.empty() || !metricsRecordFile.empty() || metricsPort != 0) {
+        ret = MetricsRegistry::GetInstance()->StartExport(metricsFile, metricsIntervalMs, metricsPort,
+            metricsRecordFile);
+        if (ret != APP_ERR_OK) {
+            LogFatal << "ModuleManager: fail to export the metrics.";
+            StopServices();
+            return ret;
+        }
+        isMetricsExported_ = true;
+    }
+
+    // Statistic.cpuSet, numaNode and threadPriority, keeps the reporter threads off the cpus of the modules
+    ThreadPolicy statisticPolicy;
+    ret = LoadThreadPolicy(configParser_, "Statistic", statisticPolicy);
+    if (ret != APP_ERR_OK) {
+        LogFatal << "ModuleManager: invalid thread policy of Statistic.";
+        StopServices();
+        return ret;
+    }
+    Statistic::SetThreadPolicy(statisticPolicy);
+    // Statistic.windowSec, decaySec and reservoirSize, what the statistic report covers and how many raw durations
+    // of every probe it keeps
+    uint32_t windowSec = STATISTIC_WINDOW_SEC;
+    uint32_t decaySec = STATISTIC_DECAY_SEC;
+    uint32_t reservoirSize = STATISTIC_RESERVOIR_SIZE;
+    configParser_.GetUnsignedIntValue("Statistic.windowSec", windowSec);
+    configParser_.GetUnsignedIntValue("Statistic.decaySec", decaySec);
+    configParser_.GetUnsignedIntValue("Statistic.reservoirSize", reservoirSize);
+    Statistic::SetWindow(windowSec, decaySec);
+    Statistic::SetReservoirSize(reservoirSize);
+    // Statistic.recordFile, the rows of the statistic report as JSON Lines or CSV for statcompare
+    std::string statisticRecordFile = "";
+    configParser_.GetStringValue("Statistic.recordFile", statisticRecordFile);
+    Statistic::SetRecordFile(statisticRecordFile);
+    // Statistic.enable, the Process calls of every module and the PROBE scopes reported every Statistic.periodMs
+    bool isStatisticEnabled = false;
+    configParser_.GetBoolValue("Statistic.enable", isStatisticEnabled);
+    if (isStatisticEnabled) {
+        uint32_t statisticPeriodMs = STATISTIC_REPORT_PERIOD_MS;
+        configParser_.GetUnsignedIntValue("Statistic.periodMs", statisticPeriodMs);
+        Statistic::SetStatisticEnable(true);
+        Statistic::StartReport(statisticPeriodMs);
+    }
+
     // Init Acl
 #ifdef ASCEND_MODULE_USE_ACL
     ret = InitAcl(aclConfigPath);
     if (ret != APP_ERR_OK) {
         LogFatal << "ModuleManager: fail to init Acl.";
+        StopServices();
         return ret;
     }
 #endif
@@ -51,12 +172,44 @@ APP_ERROR ModuleManager::Init(std::string &configPath, std::string &aclConfigPat
     ret = InitPipelineModule();
     if (ret != APP_ERR_OK) {
         LogFatal << "ModuleManager: fail to init pipeline module.";
+#ifdef ASCEND_MODULE_USE_ACL
+        ResourceManager::GetInstance()->Release();
+#endif
+        StopServices();
         return ret;
     }
 
     return ret;
 }
 
+// the services Init started before it failed, stopped in the reverse order so that a later Init starts them again
+void ModuleManager::StopServices()
+{
+    Statistic::StopReport();
+    Statistic::SetStatisticEnable(false);
+    if (isMetricsExported_) {
+        MetricsRegistry::GetInstance()->StopExport();
+        isMetricsExported_ = false;
+    }
+    if (isConfigWatched_) {
+        ConfigWatcher::GetInstance()->Stop();
+        isConfigWatched_ = false;
+    }
+    if (!traceFile_.empty()) {
+        Tracer::Stop();
+        traceFile_ = "";
+    }
+    AtlasAscendLog::Log::WriteSuppressed();
+    if (isLogBinary_) {
+        AtlasAscendLog::BinaryLog::Stop();
+        isLogBinary_ = false;
+    }
+    if (isLogAsync_) {
+        AtlasAscendLog::Log::StopAsync();
+        isLogAsync_ = false;
+    }
+}
+
 #ifdef ASCEND_MODULE_USE_ACL
 APP_ERROR ModuleManager::InitAcl(std::string &aclConfigPath)
 {
@@ -102,9 +255,15 @@ APP_ERROR ModuleManager::InitModuleInstance(std::shared_ptr<ModuleBase> moduleIn
     initArgs.pipelineName = pipelineName;
     initArgs.moduleName = moduleName;
     initArgs.instanceId = instanceId;
+    // an instance run by the executor has no thread of its own, only the threads it creates apply it then
+    APP_ERROR ret = LoadThreadPolicy(configParser_, moduleName, initArgs.threadPolicy);
+    if (ret != APP_ERR_OK) {
+        LogFatal << "ModuleManager: invalid thread policy of " << moduleName << ".";
+        return ret;
+    }
 
     // Initialize the Init function of each module
-    APP_ERROR ret = moduleInstance->Init(configParser_, initArgs);
+    ret = moduleInstance->Init(configParser_, initArgs);
     if (ret != APP_ERR_OK) {
         LogFatal << "ModuleManager: fail to init module, name = " << moduleName.c_str() << ", instance id = " <<
             instanceId << ".";
@@ -131,12 +290,17 @@ APP_ERROR ModuleManager::RegisterModules(std::string pipelineName, ModuleDesc *m
         ModuleDesc moduleDesc = modulesDesc[i];
         int moduleCount = (moduleDesc.moduleCount == -1) ? defaultCount : moduleDesc.moduleCount;
         ModulesInfo modulesInfo;
-        for (int j = 0; j < moduleCount; j++) {
+        // a scaled module type gets maxInstances objects, only the first moduleCount are initialized now
+        int instanceNum = InitScaleInfo(pipelineName, moduleDesc.moduleName, moduleCount, modulesInfo);
+        for (int j = 0; j < instanceNum; j++) {
             moduleInstance.reset(static_cast<ModuleBase *>(ModuleFactory::MakeModule(moduleDesc.moduleName)));
-            APP_ERROR ret = InitModuleInstance(moduleInstance, j, pipelineName, moduleDesc.moduleName);
-            if (ret != APP_ERR_OK) {
-                return ret;
+            if (j < moduleCount) {
+                APP_ERROR ret = InitModuleInstance(moduleInstance, j, pipelineName, moduleDesc.moduleName);
+                if (ret != APP_ERR_OK) {
+                    return ret;
+                }
             }
+            moduleInstance->SetExecutor(executor_.get());
             modulesInfo.moduleVec.push_back(moduleInstance);
         }
         modulesInfoMap[moduleDesc.moduleName] = modulesInfo;
@@ -147,6 +311,38 @@ APP_ERROR ModuleManager::RegisterModules(std::string pipelineName, ModuleDesc *m
     return APP_ERR_OK;
 }
 
+// return the number of instances to create, moduleCount is kept within the bounds of a scaled module type
+int ModuleManager::InitScaleInfo(std::string pipelineName, std::string moduleName, int &moduleCount,
+    ModulesInfo &modulesInfo)
+{
+    ModuleScaleInfo scaleInfo = {};
+    if (configParser_.GetUnsignedIntValue(moduleName + ".maxInstances", scaleInfo.maxInstances) != APP_ERR_OK ||
+        scaleInfo.maxInstances == 0) {
+        return moduleCount;
+    }
+    scaleInfo.pipelineName = pipelineName;
+    scaleInfo.moduleName = moduleName;
+    scaleInfo.minInstances = 1;
+    scaleInfo.scaleUpQueueDepth = SCALE_UP_QUEUE_DEPTH;
+    scaleInfo.scaleDownQueueDepth = SCALE_DOWN_QUEUE_DEPTH;
+    configParser_.GetUnsignedIntValue(moduleName + ".minInstances", scaleInfo.minInstances);
+    configParser_.GetUnsignedIntValue(moduleName + ".scaleUpQueueDepth", scaleInfo.scaleUpQueueDepth);
+    configParser_.GetUnsignedIntValue(moduleName + ".scaleDownQueueDepth", scaleInfo.scaleDownQueueDepth);
+    configParser_.GetUnsignedIntValue(moduleName + ".scaleUpLatencyMs", scaleInfo.scaleUpLatencyMs);
+    configParser_.GetUnsignedIntValue(moduleName + ".scaleDownLatencyMs", scaleInfo.scaleDownLatencyMs);
+    scaleInfo.minInstances = std::max(scaleInfo.minInstances, 1u);
+    scaleInfo.maxInstances = std::max(scaleInfo.maxInstances, scaleInfo.minInstances);
+    moduleCount = std::min(std::max(moduleCount, static_cast<int>(scaleInfo.minInstances)),
+        static_cast<int>(scaleInfo.maxInstances));
+
+    scaleInfo.activeCount = std::make_shared<std::atomic<uint32_t>>(moduleCount);
+    modulesInfo.activeCount = scaleInfo.activeCount;
+    scaleInfoVec_.push_back(scaleInfo);
+    LogInfo << "ModuleManager: " << moduleName << " scales from " << scaleInfo.minInstances << " to " <<
+        scaleInfo.maxInstances << " instances, starts with " << moduleCount << ".";
+    return scaleInfo.maxInstances;
+}
+
 APP_ERROR ModuleManager::RegisterModuleConnects(std::string pipelineName, ModuleConnectDesc *connnectDesc,
     int moduleConnectCount)
 {
@@ -157,13 +353,13 @@ APP_ERROR ModuleManager::RegisterModuleConnects(std::string pipelineName, Module
     }
     modulesInfoMap = iter->second;
 
-    std::shared_ptr<BlockingQueue<std::shared_ptr<void>>> dataQueue = nullptr;
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> dataQueue = nullptr;
 
     // add connect
     for (int i = 0; i < moduleConnectCount; i++) {
         ModuleConnectDesc connectDesc = connnectDesc[i];
         LogDebug << "Add Connect " << connectDesc.moduleSend << " " << connectDesc.moduleRecv << " type " <<
-            connectDesc.connectType;
+            connectDesc.connectType << " queue " << connectDesc.queueType;
         auto iterSend = modulesInfoMap.find(connectDesc.moduleSend);
         auto iterRecv = modulesInfoMap.find(connectDesc.moduleRecv);
         if (iterSend == modulesInfoMap.end() || iterRecv == modulesInfoMap.end()) {
@@ -174,22 +370,111 @@ APP_ERROR ModuleManager::RegisterModuleConnects(std::string pipelineName, Module
         ModulesInfo moduleInfoSend = iterSend->second;
         ModulesInfo moduleInfoRecv = iterRecv->second;
 
+        // these connections keep a channel on one receiver instance, with its state and the order of its messages;
+        // a change of activeCount would move the channels of every instance
+        if (moduleInfoRecv.activeCount != nullptr && (connectDesc.connectType == MODULE_CONNECT_CHANNEL ||
+            connectDesc.connectType == MODULE_CONNECT_PAIR)) {
+            LogError << "Connect " << connectDesc.moduleSend << " " << connectDesc.moduleRecv << " type " <<
+                connectDesc.connectType << " keeps every channel on one instance, " << connectDesc.moduleRecv <<
+                " cannot be scaled at runtime, unset " << connectDesc.moduleRecv << ".maxInstances.";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+
+        // a dropped message would leave a hole in the sequences of its channel and stall it
+        if (connectDesc.connectType == MODULE_CONNECT_LEAST_LOADED_ORDERED &&
+            connectDesc.overloadPolicy != MODULE_OVERLOAD_BLOCK) {
+            LogWarn << "Connect " << connectDesc.moduleSend << " " << connectDesc.moduleRecv <<
+                " keeps the channel order, use MODULE_OVERLOAD_BLOCK instead of policy " << connectDesc.overloadPolicy;
+            connectDesc.overloadPolicy = MODULE_OVERLOAD_BLOCK;
+        }
+
+        // a SPSC ring is only safe when every receiver instance is fed by exactly one sender instance,
+        // MODULE_CONNECT_CHANNEL relies on the channel id being the instance id of the sender
+        ModuleQueueType queueType = connectDesc.queueType;
+        // the number of senders of a receiver changes with the instances of a scaled module type
+        bool isScaled = (moduleInfoSend.activeCount != nullptr) || (moduleInfoRecv.activeCount != nullptr);
+        bool isSingleSender = !isScaled && ((moduleInfoSend.moduleVec.size() == 1) ||
+            (connectDesc.connectType == MODULE_CONNECT_PAIR) ||
+            (connectDesc.connectType == MODULE_CONNECT_CHANNEL &&
+            moduleInfoSend.moduleVec.size() == moduleInfoRecv.moduleVec.size()));
+        if (queueType == MODULE_QUEUE_SPSC && !isSingleSender) {
+            LogWarn << "Connect " << connectDesc.moduleSend << " " << connectDesc.moduleRecv <<
+                " has several senders per receiver, use MODULE_QUEUE_MPMC instead of MODULE_QUEUE_SPSC";
+            queueType = MODULE_QUEUE_MPMC;
+        }
+        // dropping the oldest message pops on the sender side, a SPSC ring has a single consumer,
+        // and a MPMC ring holds at least two messages
+        uint32_t capacity = (connectDesc.queueCapacity == 0) ? MODULE_QUEUE_SIZE : connectDesc.queueCapacity;
+        if (connectDesc.overloadPolicy == MODULE_OVERLOAD_DROP_OLDEST && queueType == MODULE_QUEUE_SPSC) {
+            LogWarn << "Connect " << connectDesc.moduleSend << " " << connectDesc.moduleRecv <<
+                " drops the oldest messages, use MODULE_QUEUE_MPMC instead of MODULE_QUEUE_SPSC";
+            queueType = MODULE_QUEUE_MPMC;
+        } else if (connectDesc.overloadPolicy == MODULE_OVERLOAD_LATEST_ONLY) {
+            queueType = MODULE_QUEUE_BLOCKING;
+            capacity = 1;
+        }
+
         // create input queue for recv module
         for (unsigned int j = 0; j < moduleInfoRecv.moduleVec.size(); j++) {
-            dataQueue = std::make_shared<BlockingQueue<std::shared_ptr<void>>>(MODULE_QUEUE_SIZE);
+            dataQueue = CreateQueue(queueType, capacity);
+            dataQueue->SetWaitStrategy(connectDesc.waitStrategy);
             moduleInfoRecv.inputQueueVec.push_back(dataQueue);
         }
         RegisterInputVec(pipelineName, connectDesc.moduleRecv, moduleInfoRecv.inputQueueVec);
 
-        //
+        configParser_.GetBoolValue(connectDesc.moduleRecv + ".fused", connectDesc.isFused);
+        bool isFused = connectDesc.isFused &&
+            IsFusable(connectDesc, moduleInfoSend, moduleInfoRecv, connnectDesc, moduleConnectCount);
         RegisterOutputModule(pipelineName, connectDesc.moduleSend, connectDesc.moduleRecv, connectDesc.connectType,
-            moduleInfoRecv.inputQueueVec);
+            moduleInfoRecv.inputQueueVec, connectDesc.overloadPolicy, isFused);
     }
     return APP_ERR_OK;
 }
 
+// every receiver must be fed by one sender only and by nothing else, otherwise its Process would run in several
+// threads or would need a thread of its own; a fused connection sends to the receiver with the instance id of the
+// sender whatever the channel, so the senders and the receivers must be as many
+bool ModuleManager::IsFusable(const ModuleConnectDesc &connectDesc, const ModulesInfo &moduleInfoSend,
+    const ModulesInfo &moduleInfoRecv, ModuleConnectDesc *connnectDesc, int moduleConnectCount)
+{
+    std::string reason = "";
+    int inputCount = 0;
+    for (int i = 0; i < moduleConnectCount; i++) {
+        inputCount += (connnectDesc[i].moduleRecv == connectDesc.moduleRecv) ? 1 : 0;
+    }
+    if (connectDesc.connectType != MODULE_CONNECT_CHANNEL && connectDesc.connectType != MODULE_CONNECT_PAIR) {
+        reason = "its connect type is not MODULE_CONNECT_CHANNEL or MODULE_CONNECT_PAIR";
+    } else if (moduleInfoSend.moduleVec.size() != moduleInfoRecv.moduleVec.size()) {
+        reason = "the senders and the receivers are not as many";
+    } else if (moduleInfoSend.activeCount != nullptr || moduleInfoRecv.activeCount != nullptr) {
+        reason = "a side is scaled at runtime";
+    } else if (connectDesc.overloadPolicy != MODULE_OVERLOAD_BLOCK) {
+        reason = "its overload policy drops messages";
+    } else if (inputCount != 1) {
+        reason = connectDesc.moduleRecv + " has other input connections";
+    }
+    if (!reason.empty()) {
+        LogWarn << "Connect " << connectDesc.moduleSend << " " << connectDesc.moduleRecv << " is not fused, " <<
+            reason << ".";
+        return false;
+    }
+    LogInfo << "Connect " << connectDesc.moduleSend << " " << connectDesc.moduleRecv << " is fused.";
+    return true;
+}
+
+std::shared_ptr<QueueBase<std::shared_ptr<void>>> ModuleManager::CreateQueue(ModuleQueueType queueType,
+    uint32_t capacity)
+{
+    if (queueType == MODULE_QUEUE_SPSC) {
+        return std::make_shared<RingQueue<std::shared_ptr<void>, RING_QUEUE_SPSC>>(capacity);
+    } else if (queueType == MODULE_QUEUE_MPMC) {
+        return std::make_shared<RingQueue<std::shared_ptr<void>, RING_QUEUE_MPMC>>(capacity);
+    }
+    return std::make_shared<BlockingQueue<std::shared_ptr<void>>>(capacity);
+}
+
 APP_ERROR ModuleManager::RegisterInputVec(std::string pipelineName, std::string moduleName,
-    std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> inputQueVec)
+    std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> inputQueVec)
 {
     auto pipelineIter = pipelineMap_.find(pipelineName);
     std::map<std::string, ModulesInfo> modulesInfoMap;
@@ -205,7 +490,7 @@ APP_ERROR ModuleManager::RegisterInputVec(std::string pipelineName, std::string
         if (moduleInfo.moduleVec.size() != inputQueVec.size()) {
             return APP_ERR_COMM_FAILURE;
         }
-        std::shared_ptr<BlockingQueue<std::shared_ptr<void>>> inputQueue = nullptr;
+        std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue = nullptr;
         for (unsigned int j = 0; j < moduleInfo.moduleVec.size(); j++) {
             std::shared_ptr<ModuleBase> moduleInstance = moduleInfo.moduleVec[j];
             inputQueue = inputQueVec[j];
@@ -216,7 +501,8 @@ APP_ERROR ModuleManager::RegisterInputVec(std::string pipelineName, std::string
 }
 
 APP_ERROR ModuleManager::RegisterOutputModule(std::string pipelineName, std::string moduleSend, std::string moduleRecv,
-    ModuleConnectType connectType, std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> outputQueVec)
+    ModuleConnectType connectType, std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> outputQueVec,
+    ModuleOverloadPolicy overloadPolicy, bool isFused)
 {
     auto pipelineIter = pipelineMap_.find(pipelineName);
     std::map<std::string, ModulesInfo> modulesInfoMap;
@@ -225,55 +511,276 @@ APP_ERROR ModuleManager::RegisterOutputModule(std::string pipelineName, std::str
     }
     modulesInfoMap = pipelineIter->second;
 
-    // set outputInfo
+    // the receivers are notified after every push when they run on the executor,
+    // and unwrap the sequenced messages of an ordered connection
+    std::shared_ptr<ReorderBuffer> reorderBuffer = nullptr;
+    std::vector<ModuleBase *> receiverVec;
+    std::shared_ptr<std::atomic<uint32_t>> activeCount = nullptr;
+    auto iterRecv = modulesInfoMap.find(moduleRecv);
+    if (iterRecv != modulesInfoMap.end() && iterRecv->second.moduleVec.size() == outputQueVec.size()) {
+        activeCount = iterRecv->second.activeCount;
+        if (connectType == MODULE_CONNECT_LEAST_LOADED_ORDERED) {
+            reorderBuffer = std::make_shared<ReorderBuffer>();
+        }
+        for (auto &moduleInstance : iterRecv->second.moduleVec) {
+            receiverVec.push_back(moduleInstance.get());
+            moduleInstance->SetReorderBuffer(reorderBuffer);
+            moduleInstance->SetFusedInput(isFused);
+        }
+    } else {
+        isFused = false;
+    }
+
+    // set outputInfo, the senders share the drop counts of the connection
+    ModuleOutputInfo outputInfo;
+    outputInfo.moduleName = moduleRecv;
+    outputInfo.connectType = connectType;
+    outputInfo.outputQueVec = outputQueVec;
+    outputInfo.receiverVec = receiverVec;
+    outputInfo.overloadPolicy = overloadPolicy;
+    outputInfo.dropCounts = std::make_shared<DropCountVec>(outputQueVec.size());
+    outputInfo.reorderBuffer = reorderBuffer;
+    outputInfo.activeCount = activeCount;
+    outputInfo.isFused = isFused;
     auto iter = modulesInfoMap.find(moduleSend);
     if (iter != modulesInfoMap.end()) {
         ModulesInfo moduleInfo = iter->second;
         for (unsigned int j = 0; j < moduleInfo.moduleVec.size(); j++) {
             std::shared_ptr<ModuleBase> moduleInstance = moduleInfo.moduleVec[j];
-            moduleInstance->SetOutputInfo(moduleRecv, connectType, outputQueVec);
+            moduleInstance->SetOutputInfo(outputInfo);
         }
     }
     return APP_ERR_OK;
 }
 
+APP_ERROR ModuleManager::GetDropCounts(std::string pipelineName, std::string moduleSend, std::string moduleRecv,
+    std::vector<uint64_t> &dropCounts)
+{
+    auto pipelineIter = pipelineMap_.find(pipelineName);
+    if (pipelineIter == pipelineMap_.end()) {
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    auto iter = pipelineIter->second.find(moduleSend);
+    if (iter == pipelineIter->second.end() || iter->second.moduleVec.empty()) {
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    return iter->second.moduleVec[0]->GetDropCounts(moduleRecv, dropCounts);
+}
+
 APP_ERROR ModuleManager::InitPipelineModule()
 {
-    return APP_ERR_OK;
+    bool executorMode = false;
+    if (configParser_.GetBoolValue("SystemConfig.executorMode", executorMode) != APP_ERR_OK || !executorMode) {
+        return APP_ERR_OK;
+    }
+    unsigned int threadNum = 0;
+    if (configParser_.GetUnsignedIntValue("SystemConfig.executorThreadNum", threadNum) != APP_ERR_OK) {
+        threadNum = 0;
+    }
+
+    // ModuleExecutor.cpuSet, numaNode and threadPriority, for all the workers
+    ThreadPolicy threadPolicy;
+    APP_ERROR ret = LoadThreadPolicy(configParser_, "ModuleExecutor", threadPolicy);
+    if (ret != APP_ERR_OK) {
+        LogFatal << "ModuleManager: invalid thread policy of ModuleExecutor.";
+        return ret;
+    }
+
+    std::function<void()> threadInit = nullptr;
+#ifdef ASCEND_MODULE_USE_ACL
+    aclrtContext context = ResourceManager::GetInstance()->GetContext(deviceId_);
+    threadInit = [context, threadPolicy]() {
+        APP_ERROR ret = aclrtSetCurrentContext(context);
+        if (ret != APP_ERR_OK) {
+            LogFatal << "ModuleExecutor: fail to set context, ret=" << ret << ".";
+        }
+        ApplyThreadPolicy(threadPolicy, "ModuleExecutor worker");
+    };
+#else
+    threadInit = [threadPolicy]() {
+        ApplyThreadPolicy(threadPolicy, "ModuleExecutor worker");
+    };
+#endif
+    executor_.reset(new ModuleExecutor);
+    return executor_->Start(threadNum, threadInit);
 }
 
 APP_ERROR ModuleManager::RunPipeline()
 {
     LogInfo << "ModuleManager: begin to run pipeline.";
 
-    // start the thread of the corresponding module
+    // start the thread of the corresponding module, the receivers of the fused connections first
+    // so that their output ports are bound before their senders call them
     std::map<std::string, ModulesInfo> modulesInfoMap;
     std::shared_ptr<ModuleBase> moduleInstance;
-    for (auto pipelineIter = pipelineMap_.begin(); pipelineIter != pipelineMap_.end(); pipelineIter++) {
-        modulesInfoMap = pipelineIter->second;
-
-        for (auto iter = modulesInfoMap.begin(); iter != modulesInfoMap.end(); iter++) {
-            ModulesInfo modulesInfo = iter->second;
-            for (uint32_t i = 0; i < modulesInfo.moduleVec.size(); i++) {
-                moduleInstance = modulesInfo.moduleVec[i];
-                APP_ERROR ret = moduleInstance->Run();
-                if (ret != APP_ERR_OK) {
-                    LogFatal << "ModuleManager: fail to run module ";
-                    return ret;
+    for (int pass = 0; pass < RUN_PASS_COUNT; pass++) {
+        for (auto pipelineIter = pipelineMap_.begin(); pipelineIter != pipelineMap_.end(); pipelineIter++) {
+            modulesInfoMap = pipelineIter->second;
+
+            for (auto iter = modulesInfoMap.begin(); iter != modulesInfoMap.end(); iter++) {
+                ModulesInfo modulesInfo = iter->second;
+                uint32_t instanceNum = (modulesInfo.activeCount == nullptr) ? modulesInfo.moduleVec.size() :
+                    modulesInfo.activeCount->load();
+                for (uint32_t i = 0; i < instanceNum; i++) {
+                    moduleInstance = modulesInfo.moduleVec[i];
+                    if (moduleInstance->IsFusedInput() != (pass == 0)) {
+                        continue;
+                    }
+                    APP_ERROR ret = moduleInstance->Run();
+                    if (ret != APP_ERR_OK) {
+                        LogFatal << "ModuleManager: fail to run module ";
+                        return ret;
+                    }
                 }
             }
         }
     }
 
+    if (!scaleInfoVec_.empty()) {
+        if (configParser_.GetUnsignedIntValue("SystemConfig.autoScaleIntervalMs", scaleIntervalMs_) != APP_ERR_OK ||
+            scaleIntervalMs_ == 0) {
+            scaleIntervalMs_ = SCALE_INTERVAL_MS;
+        }
+        isScaleStop_ = false;
+        scaleThread_ = std::thread(&ModuleManager::AutoScaleThread, this);
+    }
+
     LogInfo << "ModuleManager: run pipeline success.";
     return APP_ERR_OK;
 }
 
+// compare the mean input queue size and Process time of every scaled module type to its watermarks
+void ModuleManager::AutoScaleThread()
+{
+#ifdef ASCEND_MODULE_USE_ACL
+    APP_ERROR ret = aclrtSetCurrentContext(ResourceManager::GetInstance()->GetContext(deviceId_));
+    if (ret != APP_ERR_OK) {
+        LogFatal << "ModuleManager: fail to set context for the autoscaler, ret=" << ret << ".";
+        return;
+    }
+#endif
+    std::unique_lock<std::mutex> lock(scaleMutex_);
+    while (!scaleCond_.wait_for(lock, std::chrono::milliseconds(scaleIntervalMs_), [this]() { return isScaleStop_; })) {
+        for (auto &scaleInfo : scaleInfoVec_) {
+            AutoScaleModule(scaleInfo);
+        }
+    }
+}
+
+void ModuleManager::AutoScaleModule(ModuleScaleInfo &scaleInfo)
+{
+    ModulesInfo &modulesInfo = pipelineMap_[scaleInfo.pipelineName][scaleInfo.moduleName];
+    uint32_t activeCount = scaleInfo.activeCount->load();
+    uint64_t queueSize = 0;
+    for (uint32_t i = 0; i < activeCount; i++) {
+        std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue = modulesInfo.moduleVec[i]->GetInputQueue();
+        queueSize += (inputQueue == nullptr) ? 0 : inputQueue->GetSize();
+    }
+    uint64_t processCount = 0;
+    uint64_t processTimeUs = 0;
+    for (auto &moduleInstance : modulesInfo.moduleVec) {
+        uint64_t instanceCount = 0;
+        uint64_t instanceTimeUs = 0;
+        moduleInstance->GetProcessStat(instanceCount, instanceTimeUs);
+        processCount += instanceCount;
+        processTimeUs += instanceTimeUs;
+    }
+    double queueDepth = static_cast<double>(queueSize) / activeCount;
+    uint64_t intervalCount = processCount - scaleInfo.lastProcessCount;
+    double latencyMs = (intervalCount == 0) ? 0 :
+        (processTimeUs - scaleInfo.lastProcessTimeUs) / TIME_COUNTS / intervalCount;
+    scaleInfo.lastProcessCount = processCount;
+    scaleInfo.lastProcessTimeUs = processTimeUs;
+    LogDebug << "ModuleManager: " << scaleInfo.moduleName << " instances=" << activeCount << ", queueDepth=" <<
+        queueDepth << ", latencyMs=" << latencyMs;
+
+    bool isHigh = (queueDepth > scaleInfo.scaleUpQueueDepth) ||
+        (scaleInfo.scaleUpLatencyMs > 0 && latencyMs > scaleInfo.scaleUpLatencyMs);
+    bool isLow = (queueDepth <= scaleInfo.scaleDownQueueDepth) &&
+        (scaleInfo.scaleDownLatencyMs == 0 || latencyMs < scaleInfo.scaleDownLatencyMs);
+    if (!isLow) {
+        scaleInfo.lowRounds = 0;
+    }
+    // a sender which chose a retired instance just before its input queue was stopped may still have pushed to it
+    for (uint32_t i = activeCount; i < modulesInfo.moduleVec.size(); i++) {
+        MoveLeftovers(modulesInfo, i);
+    }
+    if (isHigh && activeCount < scaleInfo.maxInstances) {
+        ScaleUp(scaleInfo, modulesInfo);
+    } else if (isLow && activeCount > scaleInfo.minInstances && ++scaleInfo.lowRounds >= SCALE_DOWN_ROUNDS) {
+        scaleInfo.lowRounds = 0;
+        ScaleDown(scaleInfo, modulesInfo);
+    }
+}
+
+// the instance is initialized and running before the senders see it
+APP_ERROR ModuleManager::ScaleUp(ModuleScaleInfo &scaleInfo, ModulesInfo &modulesInfo)
+{
+    uint32_t instanceId = scaleInfo.activeCount->load();
+    std::shared_ptr<ModuleBase> moduleInstance = modulesInfo.moduleVec[instanceId];
+    APP_ERROR ret = InitModuleInstance(moduleInstance, instanceId, scaleInfo.pipelineName, scaleInfo.moduleName);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    // stopped when the instance was retired before
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue = moduleInstance->GetInputQueue();
+    if (inputQueue != nullptr) {
+        inputQueue->Restart();
+    }
+    ret = moduleInstance->Run();
+    if (ret != APP_ERR_OK) {
+        LogError << "ModuleManager: fail to run " << scaleInfo.moduleName << "[" << instanceId << "].";
+        moduleInstance->Retire();
+        return ret;
+    }
+    scaleInfo.activeCount->store(instanceId + 1);
+    LogInfo << "ModuleManager: scale " << scaleInfo.moduleName << " up to " << instanceId + 1 << " instances.";
+    return APP_ERR_OK;
+}
+
+// the senders stop choosing the last instance once activeCount drops, it processes its input queue before it stops,
+// then its queue is stopped so that the senders which chose it before the drop send to another instance
+APP_ERROR ModuleManager::ScaleDown(ModuleScaleInfo &scaleInfo, ModulesInfo &modulesInfo)
+{
+    uint32_t instanceId = scaleInfo.activeCount->load() - 1;
+    scaleInfo.activeCount->store(instanceId);
+    APP_ERROR ret = modulesInfo.moduleVec[instanceId]->Retire();
+    MoveLeftovers(modulesInfo, instanceId);
+    LogInfo << "ModuleManager: scale " << scaleInfo.moduleName << " down to " << instanceId << " instances.";
+    return ret;
+}
+
+// what a sender pushed to the retired instance after it stopped processing and before its queue was stopped; the
+// input connections of a scaled module type do not bind a channel to an instance, the first one takes it
+void ModuleManager::MoveLeftovers(ModulesInfo &modulesInfo, uint32_t instanceId)
+{
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> inputQueue = modulesInfo.moduleVec[instanceId]->GetInputQueue();
+    if (inputQueue == nullptr) {
+        return;
+    }
+    std::shared_ptr<ModuleBase> firstInstance = modulesInfo.moduleVec[0];
+    for (auto &leftData : inputQueue->GetRemainItems()) {
+        if (leftData != nullptr) {
+            firstInstance->GetInputQueue()->Push(std::move(leftData), true);
+            firstInstance->NotifyInput();
+        }
+    }
+}
+
 APP_ERROR ModuleManager::DeInit(void)
 {
     LogInfo << "begin to deinit module manager.";
     APP_ERROR ret = APP_ERR_OK;
 
+    if (scaleThread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(scaleMutex_);
+            isScaleStop_ = true;
+        }
+        scaleCond_.notify_all();
+        scaleThread_.join();
+    }
+
     // DeInit pipeline module
     ret = DeInitPipelineModule();
     if (ret != APP_ERR_OK) {
@@ -281,13 +788,136 @@ APP_ERROR ModuleManager::DeInit(void)
         return ret;
     }
 
+    if (executor_ != nullptr) {
+        executor_->Stop();
+    }
+
+    if (isMetricsExported_) {
+        MetricsRegistry::GetInstance()->StopExport();
+    }
+    if (isConfigWatched_) {
+        ConfigWatcher::GetInstance()->Stop();
+    }
+    // the last report of the statistics, when any was started
+    Statistic::StopReport();
+
+    if (!traceFile_.empty()) {
+        Tracer::Stop();
+        Tracer::Dump(traceFile_);
+    }
+
 #ifdef ASCEND_MODULE_USE_ACL
     ResourceManager::GetInstance()->Release();
 #endif
 
+    AtlasAscendLog::Log::WriteSuppressed();
+    if (isLogBinary_) {
+        AtlasAscendLog::BinaryLog::Stop();
+    }
+    if (isLogAsync_) {
+        AtlasAscendLog::Log::StopAsync();
+    }
+
     return ret;
 }
 
+// SystemConfig.logBufferSize lines are queued to the async writer, SystemConfig.logBinaryBufferSize bytes are the
+// ring of every thread of the binary log, SystemConfig.logOverflowPolicy is block or drop for both
+APP_ERROR ModuleManager::StartLogWriters()
+{
+    bool logAsync = false;
+    bool logBinary = false;
+    configParser_.GetBoolValue("SystemConfig.logAsync", logAsync);
+    configParser_.GetBoolValue("SystemConfig.logBinary", logBinary);
+    if (!logAsync && !logBinary) {
+        return APP_ERR_OK;
+    }
+    std::string overflowPolicy = "block";
+    configParser_.GetStringValue("SystemConfig.logOverflowPolicy", overflowPolicy);
+    if (overflowPolicy != "block" && overflowPolicy != "drop") {
+        LogError << "ModuleManager: invalid SystemConfig.logOverflowPolicy " << overflowPolicy << ".";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    AtlasAscendLog::LogOverflowPolicy policy = (overflowPolicy == "drop") ?
+        AtlasAscendLog::LOG_OVERFLOW_DROP : AtlasAscendLog::LOG_OVERFLOW_BLOCK;
+    if (logAsync) {
+        uint32_t bufferSize = AtlasAscendLog::LOG_BUFFER_SIZE;
+        configParser_.GetUnsignedIntValue("SystemConfig.logBufferSize", bufferSize);
+        APP_ERROR ret = AtlasAscendLog::Log::StartAsync(bufferSize, policy);
+        if (ret != APP_ERR_OK) {
+            return ret;
+        }
+        isLogAsync_ = true;
+    }
+    if (logBinary) {
+        uint32_t bufferSize = AtlasAscendLog::BINARY_LOG_BUFFER_SIZE;
+        configParser_.GetUnsignedIntValue("SystemConfig.logBinaryBufferSize", bufferSize);
+        APP_ERROR ret = AtlasAscendLog::BinaryLog::Start(bufferSize, policy);
+        if (ret != APP_ERR_OK) {
+            return ret;
+        }
+        isLogBinary_ = true;
+    }
+    return APP_ERR_OK;
+}
+
+// SystemConfig.logUtcOffsetMinutes is the time zone of the lines, the local one when omitted;
+// SystemConfig.logRateLimit lines per second from every statement, SystemConfig.logRateBurst of them at once, and
+// SystemConfig.logRateLimit<Level> for the statements of one level, the fatal ones are limited by their own key only
+void ModuleManager::SetLogOptions()
+{
+    int utcOffsetMinutes = 0;
+    if (configParser_.GetIntValue("SystemConfig.logUtcOffsetMinutes", utcOffsetMinutes) == APP_ERR_OK) {
+        AtlasAscendLog::Log::SetUtcOffset(utcOffsetMinutes * SECONDS_PER_MINUTE);
+    }
+
+    uint32_t burst = 0;
+    configParser_.GetUnsignedIntValue("SystemConfig.logRateBurst", burst);
+    uint32_t linesPerSecond = 0;
+    if (configParser_.GetUnsignedIntValue("SystemConfig.logRateLimit", linesPerSecond) == APP_ERR_OK) {
+        AtlasAscendLog::Log::SetDefaultRateLimit(linesPerSecond, burst);
+    }
+    const std::vector<std::string> levelNames = { "Debug", "Info", "Warn", "Error", "Fatal" };
+    for (uint32_t level = 0; level < levelNames.size(); level++) {
+        if (configParser_.GetUnsignedIntValue("SystemConfig.logRateLimit" + levelNames[level], linesPerSecond) ==
+            APP_ERR_OK) {
+            AtlasAscendLog::Log::SetLevelRateLimit(level, linesPerSecond, burst);
+        }
+    }
+}
+
+// what the record files of the metrics and of the statistics write first, so that two runs compared by statcompare
+// tell which build and config they come from
+void ModuleManager::SetRunMetadata(const std::string &configPath)
+{
+    std::ifstream configFile(configPath);
+    std::stringstream configText;
+    configText << configFile.rdbuf();
+    std::ostringstream configHash;
+    configHash << std::hex << std::setw(sizeof(size_t) * 2) << std::setfill('0')
+               << std::hash<std::string>()(configText.str());
+
+    char hostName[HOST_NAME_SIZE] = {0};
+    char startTime[START_TIME_SIZE] = {0};
+    time_t now = time(nullptr);
+    struct tm tmBuf = {};
+    strftime(startTime, START_TIME_SIZE, "%FT%TZ", gmtime_r(&now, &tmBuf));
+    MetricsRecordFile::SetRunMetadata("git_hash", ASCEND_GIT_HASH);
+    MetricsRecordFile::SetRunMetadata("config", configPath);
+    MetricsRecordFile::SetRunMetadata("config_hash", configHash.str());
+    MetricsRecordFile::SetRunMetadata("start_time", startTime);
+    if (gethostname(hostName, HOST_NAME_SIZE - 1) == 0) {
+        MetricsRecordFile::SetRunMetadata("host", hostName);
+    }
+    const std::vector<std::string> systemKeys = { "channelCount", "deviceId", "executorMode", "executorThreadNum" };
+    std::string value;
+    for (auto &key : systemKeys) {
+        if (configParser_.GetStringValue("SystemConfig." + key, value) == APP_ERR_OK) {
+            MetricsRecordFile::SetRunMetadata(key, value);
+        }
+    }
+}
+
 void ModuleManager::StopModule(std::shared_ptr<ModuleBase> module)
 {
     LogDebug << module->GetModuleName() << "[" << module->GetInstanceId() << "] stop begin";
@@ -309,9 +939,10 @@ APP_ERROR ModuleManager::DeInitPipelineModule()
         for (auto iter = modulesInfoMap.begin(); iter != modulesInfoMap.end(); iter++) {
             ModulesInfo modulesInfo = iter->second;
             std::vector<std::thread> threadVec;
-
-            for (auto &moduleInstance : modulesInfo.moduleVec) {
-                threadVec.emplace_back(ModuleManager::StopModule, moduleInstance);
+            uint32_t instanceNum = (modulesInfo.activeCount == nullptr) ? modulesInfo.moduleVec.size() :
+                modulesInfo.activeCount->load();
+            for (uint32_t i = 0; i < instanceNum; i++) {
+                threadVec.emplace_back(ModuleManager::StopModule, modulesInfo.moduleVec[i]);
             }
 
             for (auto &t : threadVec) {
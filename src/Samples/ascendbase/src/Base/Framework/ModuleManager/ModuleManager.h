@@ -18,9 +18,11 @@
 #define INC_MODULE_MANAGER_H
 
 #include <unistd.h>
+#include <condition_variable>
 #include "acl/acl.h"
 #include "Log/Log.h"
 #include "ModuleManager/ModuleBase.h"
+#include "ModuleManager/ModuleExecutor.h"
 #include "ModuleManager/ModuleFactory.h"
 
 namespace ascendBaseModule {
@@ -31,16 +33,54 @@ struct ModuleDesc {
     int moduleCount; // -1 using the defaultCount
 };
 
+// implementation of the input queues created for one connection
+enum ModuleQueueType {
+    MODULE_QUEUE_BLOCKING = 0, // BlockingQueue, std::list guarded by a mutex
+    MODULE_QUEUE_SPSC,         // lock-free ring, each receiver instance must be fed by only one sending thread
+    MODULE_QUEUE_MPMC          // lock-free ring, any number of sending threads
+};
+
 struct ModuleConnectDesc {
     std::string moduleSend;
     std::string moduleRecv;
     ModuleConnectType connectType;
+    ModuleQueueType queueType;           // MODULE_QUEUE_BLOCKING when omitted
+    ModuleOverloadPolicy overloadPolicy; // MODULE_OVERLOAD_BLOCK when omitted
+    uint32_t queueCapacity;              // capacity of every input queue, 0 or omitted means MODULE_QUEUE_SIZE
+    // how the receivers wait on an empty input queue, spinning cuts the hand-off latency at the cost of a cpu,
+    // QUEUE_WAIT_DEFAULT when omitted; the executor never waits on a queue and ignores it
+    QueueWaitStrategy waitStrategy;
+    // the senders call Process of the receivers in their own thread instead of pushing to their input queues,
+    // <moduleRecv>.fused in the config file overrides it; only for a MODULE_CONNECT_CHANNEL or MODULE_CONNECT_PAIR
+    // connection with as many receivers as senders, MODULE_OVERLOAD_BLOCK, no scaling and no other input connection;
+    // every sender then calls the receiver with its own instance id, whatever the channel of the message
+    bool isFused;
 };
 
 // information for one type of module
 struct ModulesInformation {
     std::vector<std::shared_ptr<ModuleBase>> moduleVec;
-    std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> inputQueueVec;
+    std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> inputQueueVec;
+    // set when the module type is scaled at runtime, moduleVec holds maxInstances and the first activeCount run
+    std::shared_ptr<std::atomic<uint32_t>> activeCount = nullptr;
+};
+
+// a module type scaled at runtime, set by <moduleName>.maxInstances in the config file,
+// the Init of such a module must accept to be called again after DeInit; its input connections must spread the
+// messages over the instances, RegisterModuleConnects refuses MODULE_CONNECT_CHANNEL and MODULE_CONNECT_PAIR
+struct ModuleScaleInfo {
+    std::string pipelineName;
+    std::string moduleName;
+    uint32_t minInstances;        // <moduleName>.minInstances, 1 by default
+    uint32_t maxInstances;        // <moduleName>.maxInstances
+    uint32_t scaleUpQueueDepth;   // <moduleName>.scaleUpQueueDepth, add an instance above this mean queue size
+    uint32_t scaleDownQueueDepth; // <moduleName>.scaleDownQueueDepth, retire one at or below this mean queue size
+    uint32_t scaleUpLatencyMs;    // <moduleName>.scaleUpLatencyMs, add an instance above this mean Process time
+    uint32_t scaleDownLatencyMs;  // <moduleName>.scaleDownLatencyMs, retire one only below this mean Process time
+    std::shared_ptr<std::atomic<uint32_t>> activeCount;
+    uint64_t lastProcessCount;
+    uint64_t lastProcessTimeUs;
+    uint32_t lowRounds;           // consecutive rounds at or below the low watermarks
 };
 
 using ModulesInfo = ModulesInformation;
@@ -56,9 +96,13 @@ public:
     APP_ERROR RegisterModuleConnects(std::string pipelineName, ModuleConnectDesc *connnectDesc, int moduleConnectCount);
 
     APP_ERROR RegisterInputVec(std::string pipelineName, std::string moduleName,
-        std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> inputQueVec);
+        std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> inputQueVec);
     APP_ERROR RegisterOutputModule(std::string pipelineName, std::string moduleSend, std::string moduleRecv,
-        ModuleConnectType connectType, std::vector<std::shared_ptr<BlockingQueue<std::shared_ptr<void>>>> outputQueVec);
+        ModuleConnectType connectType, std::vector<std::shared_ptr<QueueBase<std::shared_ptr<void>>>> outputQueVec,
+        ModuleOverloadPolicy overloadPolicy = MODULE_OVERLOAD_BLOCK, bool isFused = false);
+    // messages dropped on the connection by its overload policy, one count per instance of moduleRecv
+    APP_ERROR GetDropCounts(std::string pipelineName, std::string moduleSend, std::string moduleRecv,
+        std::vector<uint64_t> &dropCounts);
 
     APP_ERROR RunPipeline();
 
@@ -68,8 +112,21 @@ private:
 #endif
     APP_ERROR InitModuleInstance(std::shared_ptr<ModuleBase> moduleInstance, int instanceId, std::string pipelineName,
         std::string moduleName);
+    std::shared_ptr<QueueBase<std::shared_ptr<void>>> CreateQueue(ModuleQueueType queueType, uint32_t capacity);
+    bool IsFusable(const ModuleConnectDesc &connectDesc, const ModulesInfo &moduleInfoSend,
+        const ModulesInfo &moduleInfoRecv, ModuleConnectDesc *connnectDesc, int moduleConnectCount);
     APP_ERROR InitPipelineModule();
     APP_ERROR DeInitPipelineModule();
+    APP_ERROR StartLogWriters();
+    void StopServices();
+    void SetLogOptions();
+    void SetRunMetadata(const std::string &configPath);
+    int InitScaleInfo(std::string pipelineName, std::string moduleName, int &moduleCount, ModulesInfo &modulesInfo);
+    void AutoScaleThread();
+    void AutoScaleModule(ModuleScaleInfo &scaleInfo);
+    APP_ERROR ScaleUp(ModuleScaleInfo &scaleInfo, ModulesInfo &modulesInfo);
+    APP_ERROR ScaleDown(ModuleScaleInfo &scaleInfo, ModulesInfo &modulesInfo);
+    void MoveLeftovers(ModulesInfo &modulesInfo, uint32_t instanceId);
     static void StopModule(std::shared_ptr<ModuleBase> moduleInstance);
 
 private:
@@ -83,6 +140,20 @@ private:
     int moduleTypeCount_ = 0;
     int moduleConnectCount_ = 0;
     ModuleConnectDesc *connnectDesc_ = nullptr;
+    // SystemConfig.executorMode, the module instances run on a shared pool instead of one thread each,
+    // declared after pipelineMap_ so that it is destroyed before the instances
+    std::unique_ptr<ModuleExecutor> executor_ = nullptr;
+    std::vector<ModuleScaleInfo> scaleInfoVec_ = {};
+    uint32_t scaleIntervalMs_ = 0; // SystemConfig.autoScaleIntervalMs
+    std::thread scaleThread_ = {};
+    std::mutex scaleMutex_ = {};
+    std::condition_variable scaleCond_ = {};
+    bool isScaleStop_ = false;
+    std::string traceFile_ = ""; // SystemConfig.traceFile, empty when tracing is off
+    bool isMetricsExported_ = false;
+    bool isConfigWatched_ = false; // SystemConfig.configReload, the watcher is stopped by DeInit
+    bool isLogAsync_ = false; // SystemConfig.logAsync, the async log is stopped by DeInit
+    bool isLogBinary_ = false; // SystemConfig.logBinary, the binary log is stopped by DeInit
 };
 }
 
@@ -0,0 +1,57 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ModuleManager/ReorderBuffer.h"
+
+namespace ascendBaseModule {
+uint64_t ReorderBuffer::NextSequence(int channelId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return channels_[channelId].nextSequence++;
+}
+
+bool ReorderBuffer::Complete(int channelId, uint64_t sequence, std::vector<HeldMessage> &messages)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ChannelState &channel = channels_[channelId];
+    channel.completed[sequence] = std::move(messages);
+    if (channel.isReleasing) {
+        return false;
+    }
+    channel.isReleasing = true;
+    return true;
+}
+
+bool ReorderBuffer::TakeReady(int channelId, std::vector<HeldMessage> &readyMessages)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    ChannelState &channel = channels_[channelId];
+    auto iter = channel.completed.begin();
+    while (iter != channel.completed.end() && iter->first == channel.nextRelease) {
+        for (auto &message : iter->second) {
+            readyMessages.push_back(std::move(message));
+        }
+        iter = channel.completed.erase(iter);
+        channel.nextRelease++;
+    }
+    // the caller keeps the channel while it has messages to send, the next ones may complete meanwhile
+    if (readyMessages.empty()) {
+        channel.isReleasing = false;
+        return false;
+    }
+    return true;
+}
+}
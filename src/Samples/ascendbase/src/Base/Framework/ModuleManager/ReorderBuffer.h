@@ -0,0 +1,65 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_REORDER_BUFFER_H
+#define INC_REORDER_BUFFER_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ModuleManager/ModuleBase.h"
+
+namespace ascendBaseModule {
+// what travels through the queues of a MODULE_CONNECT_LEAST_LOADED_ORDERED connection
+struct SequencedMessage {
+    int channelId;
+    uint64_t sequence;
+    std::shared_ptr<void> data;
+};
+
+// a message sent by a receiver instance while it processed a sequenced message, sent later in sequence order
+struct HeldMessage {
+    PortId portId;
+    std::shared_ptr<void> data;
+    int channelId;
+};
+
+// Shared by the senders and the receiver instances of one ordered connection. The senders number the messages
+// of every channel, the receivers process them on any instance and hand back what they sent for each number;
+// the messages are then sent on in the order of the numbers, by one thread at a time for every channel.
+class ReorderBuffer {
+public:
+    uint64_t NextSequence(int channelId);
+    // store the messages held for sequence, return true if the caller has to send the ready ones by TakeReady
+    bool Complete(int channelId, uint64_t sequence, std::vector<HeldMessage> &messages);
+    // move the next messages in order to readyMessages, return false and give up the channel if there is none
+    bool TakeReady(int channelId, std::vector<HeldMessage> &readyMessages);
+
+private:
+    struct ChannelState {
+        uint64_t nextSequence = 0;
+        uint64_t nextRelease = 0;
+        bool isReleasing = false;
+        std::map<uint64_t, std::vector<HeldMessage>> completed = {};
+    };
+
+    std::mutex mutex_ = {};
+    std::map<int, ChannelState> channels_ = {};
+};
+}
+
+#endif
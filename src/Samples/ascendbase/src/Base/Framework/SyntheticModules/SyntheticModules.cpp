@@ -0,0 +1,177 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SyntheticModules.h"
+#include <thread>
+#include "Log/Log.h"
+#include "Metrics/Metrics.h"
+
+using namespace ascendBaseModule;
+
+namespace {
+const uint64_t NS_PER_SECOND = 1000000000;
+
+APP_ERROR GetNextModule(ConfigParser &configParser, const std::string &moduleName, std::string &nextModule)
+{
+    APP_ERROR ret = configParser.GetStringValue(moduleName + ".next", nextModule);
+    if (ret != APP_ERR_OK) {
+        LogError << "Failed to get " << moduleName << ".next, ret = " << ret;
+    }
+    return ret;
+}
+
+MetricLabels GetSyntheticLabels(const std::string &pipelineName, const std::string &moduleName)
+{
+    return MetricLabels {{"pipeline", pipelineName}, {"module", moduleName}};
+}
+
+std::shared_ptr<MetricHistogram> GetHopLatency(const std::string &pipelineName, const std::string &moduleName)
+{
+    return MetricsRegistry::GetInstance()->GetHistogram("ascend_synthetic_hop_latency_ns",
+        "Time from the send of a synthetic message to its Process in the receiver",
+        GetSyntheticLabels(pipelineName, moduleName));
+}
+
+// burn the cpu like a stage doing real work
+void BusyWork(uint32_t workUs)
+{
+    auto endTime = std::chrono::steady_clock::now() + std::chrono::microseconds(workUs);
+    while (std::chrono::steady_clock::now() < endTime) {
+    }
+}
+}
+
+APP_ERROR SyntheticSource::Init(ConfigParser &configParser, ModuleInitArgs &initArgs)
+{
+    AssignInitArgs(initArgs);
+    withoutInputQueue_ = true;
+    APP_ERROR ret = GetNextModule(configParser, moduleName_, nextModule_);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    // optional, the defaults send empty messages as fast as possible until Stop
+    configParser.GetUnsignedIntValue(moduleName_ + ".rate", rate_);
+    configParser.GetUnsignedIntValue(moduleName_ + ".payloadSize", payloadSize_);
+    configParser.GetUnsignedIntValue(moduleName_ + ".messageCount", messageCount_);
+    return APP_ERR_OK;
+}
+
+APP_ERROR SyntheticSource::DeInit(void)
+{
+    return APP_ERR_OK;
+}
+
+void SyntheticSource::BindOutputPorts()
+{
+    nextPort_ = GetOutputPort(nextModule_);
+}
+
+APP_ERROR SyntheticSource::Process(std::shared_ptr<void> inputData)
+{
+    if (nextPort_ == INVALID_PORT_ID) {
+        LogError << moduleName_ << " is not connected to " << nextModule_;
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    auto startTime = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; (messageCount_ == 0 || i < messageCount_) && !isStop_; i++) {
+        if (rate_ > 0) {
+            std::this_thread::sleep_until(startTime + std::chrono::nanoseconds(i * NS_PER_SECOND / rate_));
+        }
+        std::shared_ptr<SyntheticMessage> message = std::make_shared<SyntheticMessage>();
+        message->channelId = instanceId_;
+        message->sequence = i;
+        message->payload.resize(payloadSize_);
+        message->createTimeNs = GetSyntheticTimeNs();
+        message->sendTimeNs = message->createTimeNs;
+        SendToPort(nextPort_, std::move(message), instanceId_);
+    }
+    return APP_ERR_OK;
+}
+
+APP_ERROR SyntheticStage::Init(ConfigParser &configParser, ModuleInitArgs &initArgs)
+{
+    AssignInitArgs(initArgs);
+    APP_ERROR ret = GetNextModule(configParser, moduleName_, nextModule_);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    configParser.GetUnsignedIntValue(moduleName_ + ".workUs", workUs_);
+    hopLatency_ = GetHopLatency(pipelineName_, moduleName_);
+    return APP_ERR_OK;
+}
+
+APP_ERROR SyntheticStage::DeInit(void)
+{
+    return APP_ERR_OK;
+}
+
+void SyntheticStage::BindOutputPorts()
+{
+    nextPort_ = GetOutputPort(nextModule_);
+}
+
+APP_ERROR SyntheticStage::Process(std::shared_ptr<void> inputData)
+{
+    std::shared_ptr<SyntheticMessage> message = std::static_pointer_cast<SyntheticMessage>(inputData);
+    hopLatency_->Record(GetSyntheticTimeNs() - message->sendTimeNs);
+    BusyWork(workUs_);
+    uint32_t channelId = message->channelId;
+    message->sendTimeNs = GetSyntheticTimeNs();
+    SendToPort(nextPort_, std::move(inputData), channelId);
+    return APP_ERR_OK;
+}
+
+APP_ERROR NullSink::Init(ConfigParser &configParser, ModuleInitArgs &initArgs)
+{
+    AssignInitArgs(initArgs);
+    received_ = MetricsRegistry::GetInstance()->GetCounter("ascend_synthetic_received_total",
+        "Synthetic messages received by the sinks", GetSyntheticLabels(pipelineName_, moduleName_));
+    return APP_ERR_OK;
+}
+
+APP_ERROR NullSink::DeInit(void)
+{
+    return APP_ERR_OK;
+}
+
+APP_ERROR NullSink::Process(std::shared_ptr<void> inputData)
+{
+    received_->Add();
+    return APP_ERR_OK;
+}
+
+APP_ERROR LatencySink::Init(ConfigParser &configParser, ModuleInitArgs &initArgs)
+{
+    APP_ERROR ret = NullSink::Init(configParser, initArgs);
+    if (ret != APP_ERR_OK) {
+        return ret;
+    }
+    hopLatency_ = GetHopLatency(pipelineName_, moduleName_);
+    latency_ = MetricsRegistry::GetInstance()->GetHistogram("ascend_synthetic_latency_ns",
+        "Time from the creation of a synthetic message by SyntheticSource to its Process in the sink",
+        GetSyntheticLabels(pipelineName_, moduleName_));
+    return APP_ERR_OK;
+}
+
+APP_ERROR LatencySink::Process(std::shared_ptr<void> inputData)
+{
+    std::shared_ptr<SyntheticMessage> message = std::static_pointer_cast<SyntheticMessage>(inputData);
+    uint64_t now = GetSyntheticTimeNs();
+    hopLatency_->Record(now - message->sendTimeNs);
+    latency_->Record(now - message->createTimeNs);
+    received_->Add();
+    return APP_ERR_OK;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef INC_SYNTHETIC_MODULES_H
+#define INC_SYNTHETIC_MODULES_H
+
+#include <chrono>
+#include <vector>
+#include "ModuleManager/ModuleManager.h"
+
+class MetricCounter;
+class MetricHistogram;
+
+// modules measuring the cost of the framework itself: SyntheticSource sends messages, any number of SyntheticStage
+// forward them and NullSink or LatencySink drop them; every one sends to <moduleName>.next
+struct SyntheticMessage {
+    uint32_t channelId = 0;
+    uint64_t sequence = 0;
+    uint64_t createTimeNs = 0; // set by SyntheticSource
+    uint64_t sendTimeNs = 0;   // set by the last sender
+    std::vector<uint8_t> payload = {};
+};
+
+inline uint64_t GetSyntheticTimeNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// one instance per channel, sends <moduleName>.messageCount messages (0: until Stop) of <moduleName>.payloadSize
+// bytes at <moduleName>.rate messages per second (0: as fast as the pipeline accepts them)
+class SyntheticSource : public ascendBaseModule::ModuleBase {
+public:
+    APP_ERROR Init(ConfigParser &configParser, ascendBaseModule::ModuleInitArgs &initArgs);
+    APP_ERROR DeInit(void);
+
+protected:
+    APP_ERROR Process(std::shared_ptr<void> inputData);
+    void BindOutputPorts();
+
+private:
+    std::string nextModule_ = "";
+    ascendBaseModule::PortId nextPort_ = ascendBaseModule::INVALID_PORT_ID;
+    uint32_t rate_ = 0;
+    uint32_t payloadSize_ = 0;
+    uint32_t messageCount_ = 0;
+};
+
+// forwards every message after <moduleName>.workUs of cpu, 0 by default, and records the latency of the hop
+class SyntheticStage : public ascendBaseModule::ModuleBase {
+public:
+    APP_ERROR Init(ConfigParser &configParser, ascendBaseModule::ModuleInitArgs &initArgs);
+    APP_ERROR DeInit(void);
+
+protected:
+    APP_ERROR Process(std::shared_ptr<void> inputData);
+    void BindOutputPorts();
+
+private:
+    std::string nextModule_ = "";
+    ascendBaseModule::PortId nextPort_ = ascendBaseModule::INVALID_PORT_ID;
+    uint32_t workUs_ = 0;
+    std::shared_ptr<MetricHistogram> hopLatency_ = nullptr;
+};
+
+// counts the messages in ascend_synthetic_received_total, labeled with the pipeline and the module name
+class NullSink : public ascendBaseModule::ModuleBase {
+public:
+    APP_ERROR Init(ConfigParser &configParser, ascendBaseModule::ModuleInitArgs &initArgs);
+    APP_ERROR DeInit(void);
+
+protected:
+    APP_ERROR Process(std::shared_ptr<void> inputData);
+
+protected:
+    std::shared_ptr<MetricCounter> received_ = nullptr;
+};
+
+// NullSink recording as well the latency of the last hop and the one from SyntheticSource, in nanoseconds
+class LatencySink : public NullSink {
+public:
+    APP_ERROR Init(ConfigParser &configParser, ascendBaseModule::ModuleInitArgs &initArgs);
+
+protected:
+    APP_ERROR Process(std::shared_ptr<void> inputData);
+
+private:
+    std::shared_ptr<MetricHistogram> hopLatency_ = nullptr;
+    std::shared_ptr<MetricHistogram> latency_ = nullptr;
+};
+
+MODULE_REGIST(SyntheticSource)
+MODULE_REGIST(SyntheticStage)
+MODULE_REGIST(NullSink)
+MODULE_REGIST(LatencySink)
+
+#endif
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BinaryLog.h"
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <ctime>
+#include "FileManager/FileManager.h"
+
+namespace AtlasAscendLog {
+namespace {
+const uint32_t BINARY_WRITE_INTERVAL_MS = 20; // the rings are moved to the file this often
+const uint32_t BINARY_SYNC_INTERVAL_MS = 1000;
+const uint32_t BINARY_CALIBRATION_MS = 10;    // time over which the tsc ticks per second are measured
+const uint32_t BINARY_RING_MIN_SIZE = 4 * BINARY_RECORD_MAX_SIZE;
+const int DAY_SIZE = 16;
+const uint64_t NS_PER_SECOND = 1000000000;
+
+struct BinarySite {
+    uint32_t level;
+    std::string file;
+    std::string function;
+    int line;
+    std::string format;
+};
+
+// bytes of the records of one thread, written by it and read by the writer thread
+struct BinaryRing {
+    explicit BinaryRing(uint32_t size) : data(size), mask(size - 1) {}
+
+    std::vector<char> data;
+    uint64_t mask;
+    std::atomic<uint64_t> head = {}; // end of the records written
+    std::atomic<uint64_t> tail = {}; // end of the records read
+    std::atomic<bool> isWriting = {}; // set while the thread writes a record, Stop waits for it
+    std::atomic<uint64_t> droppedNum = {};
+    uint32_t generation = 0;          // the ring is replaced when BinaryLog is started again
+};
+
+std::mutex g_siteMutex;
+std::deque<BinarySite> g_sites; // indexed by site id, never shrinks so that the strings stay valid
+
+std::mutex g_ringMutex;
+std::vector<std::shared_ptr<BinaryRing>> g_rings;
+thread_local std::shared_ptr<BinaryRing> t_ring = nullptr;
+
+std::mutex g_startMutex; // serializes Start and Stop
+std::atomic<bool> g_isStarted(false);
+std::atomic<uint32_t> g_generation(0);
+uint32_t g_ringSize = BINARY_LOG_BUFFER_SIZE;
+LogOverflowPolicy g_overflowPolicy = LOG_OVERFLOW_BLOCK;
+
+uint64_t GetRealtimeNs()
+{
+    struct timespec time = {};
+    clock_gettime(CLOCK_REALTIME, &time);
+    return static_cast<uint64_t>(time.tv_sec) * NS_PER_SECOND + time.tv_nsec;
+}
+
+uint32_t RoundUpToPowerOfTwo(uint32_t size)
+{
+    uint32_t power = BINARY_RING_MIN_SIZE;
+    while (power < size) {
+        power <<= 1;
+    }
+    return power;
+}
+
+// moves the rings of all the threads to the daily file every BINARY_WRITE_INTERVAL_MS
+class BinaryWriter {
+public:
+    explicit BinaryWriter(const std::string &logFile) : logFile_(logFile)
+    {
+        // the tsc ticks against the realtime clock, refined by the sync blocks when the file is decoded
+        uint64_t startTsc = ReadTsc();
+        auto startTime = std::chrono::steady_clock::now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(BINARY_CALIBRATION_MS));
+        uint64_t endTsc = ReadTsc();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        ticksPerSecond_ = (endTsc - startTsc) / seconds;
+        writeThread_ = std::thread(&BinaryWriter::WriteThread, this);
+    }
+
+    ~BinaryWriter()
+    {
+        {
+            std::lock_guard<std::mutex> locker(stopMutex_);
+            isStop_ = true;
+        }
+        stopCond_.notify_all();
+        writeThread_.join();
+    }
+
+private:
+    void WriteThread()
+    {
+        std::unique_lock<std::mutex> locker(stopMutex_);
+        while (!stopCond_.wait_for(locker, std::chrono::milliseconds(BINARY_WRITE_INTERVAL_MS),
+            [this]() { return isStop_; })) {
+            WriteRings();
+        }
+        WriteRings();
+    }
+
+    void WriteRings()
+    {
+        uint64_t realtimeNs = GetRealtimeNs();
+        std::string day = GetDay(realtimeNs);
+        if (day != day_) {
+            OpenFile(day);
+            lastSyncNs_ = 0;
+        }
+        if (realtimeNs - lastSyncNs_ >= BINARY_SYNC_INTERVAL_MS * (NS_PER_SECOND / 1000)) {
+            WriteSync(realtimeNs);
+        }
+
+        // the records are read before the sites, so that every site they use is written before them
+        std::vector<std::shared_ptr<BinaryRing>> rings;
+        std::vector<bool> isOrphans;
+        {
+            std::lock_guard<std::mutex> locker(g_ringMutex);
+            for (auto &ring : g_rings) {
+                isOrphans.push_back(ring.use_count() == 1); // its thread is gone or uses a newer ring
+            }
+            rings = g_rings;
+        }
+        std::vector<std::string> records(rings.size());
+        uint64_t droppedNum = 0;
+        for (size_t i = 0; i < rings.size(); i++) {
+            ReadRing(*rings[i], records[i]);
+            droppedNum += rings[i]->droppedNum.exchange(0);
+        }
+        WriteSites();
+        for (auto &record : records) {
+            if (!record.empty()) {
+                WriteBlock(BINARY_BLOCK_RECORDS, record.data(), record.size());
+            }
+        }
+        if (droppedNum > 0) {
+            WriteBlock(BINARY_BLOCK_DROPPED, reinterpret_cast<const char *>(&droppedNum), sizeof(droppedNum));
+        }
+        file_.flush();
+
+        std::lock_guard<std::mutex> locker(g_ringMutex);
+        for (size_t i = 0; i < rings.size(); i++) {
+            if (isOrphans[i]) {
+                g_rings.erase(std::find(g_rings.begin(), g_rings.end(), rings[i]));
+            }
+        }
+    }
+
+    void ReadRing(BinaryRing &ring, std::string &records)
+    {
+        uint64_t head = ring.head.load(std::memory_order_acquire);
+        uint64_t tail = ring.tail.load(std::memory_order_relaxed);
+        uint64_t start = tail & ring.mask;
+        uint64_t size = head - tail;
+        uint64_t firstSize = std::min(size, ring.data.size() - start);
+        records.assign(ring.data.data() + start, firstSize);
+        records.append(ring.data.data(), size - firstSize);
+        ring.tail.store(head, std::memory_order_release);
+    }
+
+    void WriteSites()
+    {
+        std::lock_guard<std::mutex> locker(g_siteMutex);
+        for (; writtenSiteNum_ < g_sites.size(); writtenSiteNum_++) {
+            const BinarySite &site = g_sites[writtenSiteNum_];
+            std::string data;
+            uint32_t siteId = writtenSiteNum_;
+            uint8_t level = site.level;
+            uint32_t line = site.line;
+            data.append(reinterpret_cast<const char *>(&siteId), sizeof(siteId));
+            data.append(reinterpret_cast<const char *>(&level), sizeof(level));
+            data.append(reinterpret_cast<const char *>(&line), sizeof(line));
+            AppendString(data, site.file);
+            AppendString(data, site.function);
+            AppendString(data, site.format);
+            WriteBlock(BINARY_BLOCK_SITE, data.data(), data.size());
+        }
+    }
+
+    void WriteSync(uint64_t realtimeNs)
+    {
+        uint64_t tsc = ReadTsc();
+        char data[sizeof(tsc) + sizeof(realtimeNs)];
+        memcpy(data, &tsc, sizeof(tsc));
+        memcpy(data + sizeof(tsc), &realtimeNs, sizeof(realtimeNs));
+        WriteBlock(BINARY_BLOCK_SYNC, data, sizeof(data));
+        lastSyncNs_ = realtimeNs;
+    }
+
+    // the file of a new day starts over: header, start block and every site again
+    void OpenFile(const std::string &day)
+    {
+        day_ = day;
+        file_.close();
+        file_.clear();
+        CreateDirRecursivelyByFile(logFile_);
+        size_t posDot = logFile_.rfind(".");
+        std::string file = logFile_.substr(0, posDot) + "_" + day + ".blog";
+        bool isNew = (access(file.c_str(), F_OK) != 0);
+        file_.open(file, std::ios::app | std::ios::binary);
+        if (!file_) {
+            std::cout << "open file " << file << " fail" << std::endl;
+            return;
+        }
+        if (isNew) {
+            file_.write(BINARY_LOG_MAGIC, strlen(BINARY_LOG_MAGIC));
+            file_.put(static_cast<char>(BINARY_LOG_VERSION));
+        }
+        int32_t utcOffset = Log::GetUtcOffset();
+        char data[sizeof(ticksPerSecond_) + sizeof(utcOffset)];
+        memcpy(data, &ticksPerSecond_, sizeof(ticksPerSecond_));
+        memcpy(data + sizeof(ticksPerSecond_), &utcOffset, sizeof(utcOffset));
+        WriteBlock(BINARY_BLOCK_START, data, sizeof(data));
+        writtenSiteNum_ = 0;
+    }
+
+    void WriteBlock(BinaryBlockType type, const char *data, uint32_t size)
+    {
+        file_.put(static_cast<char>(type));
+        file_.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        file_.write(data, size);
+    }
+
+    static void AppendString(std::string &data, const std::string &value)
+    {
+        uint16_t length = static_cast<uint16_t>(std::min(value.size(), static_cast<size_t>(BINARY_SITE_MAX_SIZE)));
+        data.append(reinterpret_cast<const char *>(&length), sizeof(length));
+        data.append(value, 0, length);
+    }
+
+    static std::string GetDay(uint64_t realtimeNs)
+    {
+        time_t seconds = realtimeNs / NS_PER_SECOND + Log::GetUtcOffset();
+        struct tm tmBuf = {};
+        char day[DAY_SIZE] = {0};
+        strftime(day, DAY_SIZE, "%F", gmtime_r(&seconds, &tmBuf));
+        return day;
+    }
+
+    std::string logFile_;
+    double ticksPerSecond_ = 0;
+    std::string day_ = "";
+    std::ofstream file_ = {};
+    uint64_t lastSyncNs_ = 0;
+    size_t writtenSiteNum_ = 0;
+    bool isStop_ = false;
+    std::mutex stopMutex_ = {};
+    std::condition_variable stopCond_ = {};
+    std::thread writeThread_ = {};
+};
+
+std::unique_ptr<BinaryWriter> g_writer = nullptr; // its destructor writes the rings a last time at exit
+
+// the ring of the calling thread, a new one on its first record after Start
+BinaryRing &GetRing()
+{
+    uint32_t generation = g_generation.load(std::memory_order_acquire);
+    if (t_ring == nullptr || t_ring->generation != generation) {
+        t_ring = std::make_shared<BinaryRing>(g_ringSize);
+        t_ring->generation = generation;
+        std::lock_guard<std::mutex> locker(g_ringMutex);
+        g_rings.push_back(t_ring);
+    }
+    return *t_ring;
+}
+
+void WriteRing(BinaryRing &ring, const char *record, uint32_t size)
+{
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    while (ring.data.size() - (head - ring.tail.load(std::memory_order_acquire)) < size) {
+        if (g_overflowPolicy == LOG_OVERFLOW_DROP) {
+            ring.droppedNum.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        std::this_thread::yield();
+    }
+    uint64_t start = head & ring.mask;
+    uint64_t firstSize = std::min(static_cast<uint64_t>(size), ring.data.size() - start);
+    memcpy(ring.data.data() + start, record, firstSize);
+    memcpy(ring.data.data(), record + firstSize, size - firstSize);
+    ring.head.store(head + size, std::memory_order_release);
+}
+
+void WriteText(uint32_t siteId, const char *record, uint32_t size)
+{
+    const BinarySite *site = nullptr;
+    {
+        std::lock_guard<std::mutex> locker(g_siteMutex);
+        site = &g_sites[siteId];
+    }
+    uint8_t argNum = 0;
+    const uint32_t headSize = sizeof(siteId) + sizeof(uint64_t);
+    memcpy(&argNum, record + headSize, sizeof(argNum));
+    Log(site->file.c_str(), site->function.c_str(), site->line, site->level).Stream()
+        << FormatBinaryRecord(site->format, record + headSize + sizeof(argNum), argNum);
+}
+}
+
+APP_ERROR BinaryLog::Start(uint32_t bufferSize, LogOverflowPolicy overflowPolicy)
+{
+    std::lock_guard<std::mutex> locker(g_startMutex);
+    if (g_writer != nullptr) {
+        return APP_ERR_OK;
+    }
+    g_ringSize = RoundUpToPowerOfTwo(bufferSize);
+    g_overflowPolicy = overflowPolicy;
+    g_generation++;
+    g_writer.reset(new BinaryWriter(Log::logFile));
+    g_isStarted = true;
+    return APP_ERR_OK;
+}
+
+void BinaryLog::Stop()
+{
+    std::lock_guard<std::mutex> locker(g_startMutex);
+    if (g_writer == nullptr) {
+        return;
+    }
+    // the records written from now on go to the text log, wait for the ones being written to the rings
+    g_isStarted = false;
+    std::vector<std::shared_ptr<BinaryRing>> rings;
+    {
+        std::lock_guard<std::mutex> ringLocker(g_ringMutex);
+        rings = g_rings;
+    }
+    for (auto &ring : rings) {
+        while (ring->isWriting) {
+            std::this_thread::yield();
+        }
+    }
+    g_writer.reset();
+    std::lock_guard<std::mutex> ringLocker(g_ringMutex);
+    g_rings.clear();
+}
+
+uint32_t BinaryLog::RegisterSite(uint32_t level, const char *file, const char *function, int line,
+    const char *format)
+{
+    const char *fileName = strrchr(file, '/'); // for linux
+    fileName = (fileName == nullptr) ? file : fileName + 1;
+    std::lock_guard<std::mutex> locker(g_siteMutex);
+    g_sites.push_back({ level, fileName, function, line, format });
+    return g_sites.size() - 1;
+}
+
+void BinaryLog::Commit(uint32_t siteId, const char *record, uint32_t size)
+{
+    if (g_isStarted) {
+        BinaryRing &ring = GetRing();
+        ring.isWriting = true;
+        if (g_isStarted) {
+            WriteRing(ring, record, size);
+            ring.isWriting.store(false, std::memory_order_release);
+            return;
+        }
+        ring.isWriting = false;
+    }
+    WriteText(siteId, record, size);
+}
+} // namespace AtlasAscendLog
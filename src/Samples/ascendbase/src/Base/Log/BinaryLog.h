@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2020.Huawei Technologies Co., Ltd. All rights reserved.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef BINARY_LOG_H
+#define BINARY_LOG_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include "Log/Log.h"
+
+namespace AtlasAscendLog {
+// binary log file, decoded to the text of Log by logdecode:
+// "ABLG" and a BINARY_LOG_VERSION byte, then blocks made of a BinaryBlockType byte and a uint32_t size of the data
+// following it; every number is little endian as on the cpus the file is written on
+const char BINARY_LOG_MAGIC[] = "ABLG";
+const uint8_t BINARY_LOG_VERSION = 1;
+const uint32_t BINARY_LOG_BUFFER_SIZE = 1 << 20; // bytes of the ring of every logging thread
+const uint32_t BINARY_RECORD_MAX_SIZE = 1024;    // longer strings are cut to fit
+const uint16_t BINARY_SITE_MAX_SIZE = 65535;     // longest file, function or format of a site
+
+enum BinaryBlockType : uint8_t {
+    BINARY_BLOCK_START = 0, // the writer started: double ticks per second, int32_t utc offset in seconds
+    BINARY_BLOCK_SYNC,      // uint64_t tsc and uint64_t realtime in ns read together, once per second
+    BINARY_BLOCK_SITE,      // uint32_t site id, uint8_t level, uint32_t line, then file, function and format
+    BINARY_BLOCK_RECORDS,   // records of one thread in the order it wrote them
+    BINARY_BLOCK_DROPPED    // uint64_t number of records dropped because a ring was full
+};
+
+// one record: uint32_t site id, uint64_t tsc, uint8_t argument number, then every argument as a BinaryArgType byte
+// and its value, a string being a uint16_t length and its bytes
+enum BinaryArgType : uint8_t {
+    BINARY_ARG_INT = 0, // int64_t
+    BINARY_ARG_UINT,    // uint64_t
+    BINARY_ARG_DOUBLE,
+    BINARY_ARG_BOOL,    // uint8_t
+    BINARY_ARG_CHAR,
+    BINARY_ARG_STRING,
+    BINARY_ARG_POINTER  // uint64_t
+};
+
+// cycle counter of the cpu, a few ns to read; the ticks are converted to time with the sync blocks of the file
+inline uint64_t ReadTsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t low = 0;
+    uint32_t high = 0;
+    __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+    return (static_cast<uint64_t>(high) << 32) | low;
+#elif defined(__aarch64__)
+    uint64_t ticks = 0;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// the arguments of a statement written into a record, one overload per BinaryArgType
+class BinaryRecordWriter {
+public:
+    BinaryRecordWriter(char *buffer, uint32_t size) : pos_(buffer), end_(buffer + size) {}
+
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value &&
+        !std::is_same<T, char>::value>::type Put(T value)
+    {
+        PutValue(BINARY_ARG_INT, static_cast<int64_t>(value));
+    }
+    template<typename T>
+    typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value &&
+        !std::is_same<T, bool>::value && !std::is_same<T, char>::value>::type Put(T value)
+    {
+        PutValue(BINARY_ARG_UINT, static_cast<uint64_t>(value));
+    }
+    template<typename T> typename std::enable_if<std::is_enum<T>::value>::type Put(T value)
+    {
+        PutValue(BINARY_ARG_INT, static_cast<int64_t>(value));
+    }
+    template<typename T> typename std::enable_if<std::is_floating_point<T>::value>::type Put(T value)
+    {
+        PutValue(BINARY_ARG_DOUBLE, static_cast<double>(value));
+    }
+    void Put(bool value)
+    {
+        PutValue(BINARY_ARG_BOOL, static_cast<uint8_t>(value));
+    }
+    void Put(char value)
+    {
+        PutValue(BINARY_ARG_CHAR, value);
+    }
+    void Put(const char *value)
+    {
+        PutString(value, (value == nullptr) ? 0 : strlen(value));
+    }
+    void Put(const std::string &value)
+    {
+        PutString(value.c_str(), value.size());
+    }
+    void Put(const void *value)
+    {
+        PutValue(BINARY_ARG_POINTER, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+    }
+
+    void PutAll() {}
+    template<typename T, typename... Args> void PutAll(const T &value, const Args &...args)
+    {
+        Put(value);
+        PutAll(args...);
+    }
+
+    // the arguments after the first one which did not fit are left out
+    uint8_t GetArgNum() const
+    {
+        return argNum_;
+    }
+    char *GetPos() const
+    {
+        return pos_;
+    }
+
+private:
+    template<typename T> void PutValue(BinaryArgType type, T value)
+    {
+        if (isFull_ || static_cast<size_t>(end_ - pos_) < sizeof(uint8_t) + sizeof(T)) {
+            isFull_ = true;
+            return;
+        }
+        *pos_++ = static_cast<char>(type);
+        memcpy(pos_, &value, sizeof(T));
+        pos_ += sizeof(T);
+        argNum_++;
+    }
+    void PutString(const char *value, size_t length)
+    {
+        size_t room = end_ - pos_;
+        if (isFull_ || room < sizeof(uint8_t) + sizeof(uint16_t)) {
+            isFull_ = true;
+            return;
+        }
+        uint16_t size = static_cast<uint16_t>(std::min(length, room - sizeof(uint8_t) - sizeof(uint16_t)));
+        *pos_++ = static_cast<char>(BINARY_ARG_STRING);
+        memcpy(pos_, &size, sizeof(size));
+        pos_ += sizeof(size);
+        memcpy(pos_, value, size);
+        pos_ += size;
+        argNum_++;
+    }
+
+    char *pos_;
+    char *end_;
+    uint8_t argNum_ = 0;
+    bool isFull_ = false;
+};
+
+// the statements register their site once and then only copy the raw arguments and the tsc to a ring of their
+// thread, a writer thread moves the rings to the file; without Start they are written as text by Log
+class BinaryLog {
+public:
+    // every thread gets a ring of bufferSize bytes on its first statement, what it does when the ring is full
+    // follows overflowPolicy; the file is the one of Log with the extension .blog, does nothing when already started
+    static APP_ERROR Start(uint32_t bufferSize = BINARY_LOG_BUFFER_SIZE,
+        LogOverflowPolicy overflowPolicy = LOG_OVERFLOW_BLOCK);
+    // the rings are written to the file a last time, at exit as well
+    static void Stop();
+    static uint32_t RegisterSite(uint32_t level, const char *file, const char *function, int line,
+        const char *format);
+
+    template<typename... Args> static void Write(uint32_t siteId, const Args &...args)
+    {
+        char record[BINARY_RECORD_MAX_SIZE];
+        uint64_t tsc = ReadTsc();
+        const uint32_t headSize = sizeof(siteId) + sizeof(tsc) + sizeof(uint8_t);
+        BinaryRecordWriter writer(record + headSize, sizeof(record) - headSize);
+        writer.PutAll(args...);
+        uint8_t argNum = writer.GetArgNum();
+        memcpy(record, &siteId, sizeof(siteId));
+        memcpy(record + sizeof(siteId), &tsc, sizeof(tsc));
+        memcpy(record + sizeof(siteId) + sizeof(tsc), &argNum, sizeof(argNum));
+        Commit(siteId, record, writer.GetPos() - record);
+    }
+
+private:
+    static void Commit(uint32_t siteId, const char *record, uint32_t size);
+};
+
+// decoding of the records, shared with logdecode
+
+// size of the argument starting at data, type byte included
+inline uint32_t GetBinaryArgSize(const char *data)
+{
+    switch (static_cast<uint8_t>(data[0])) {
+        case BINARY_ARG_BOOL:
+            return sizeof(uint8_t) + sizeof(uint8_t);
+        case BINARY_ARG_CHAR:
+            return sizeof(uint8_t) + sizeof(char);
+        case BINARY_ARG_STRING: {
+            uint16_t length = 0;
+            memcpy(&length, data + sizeof(uint8_t), sizeof(length));
+            return sizeof(uint8_t) + sizeof(length) + length;
+        }
+        default:
+            return sizeof(uint8_t) + sizeof(uint64_t);
+    }
+}
+
+// print the argument as << prints its type
+inline void FormatBinaryArg(std::ostringstream &ss, const char *data)
+{
+    const char *value = data + sizeof(uint8_t);
+    switch (static_cast<uint8_t>(data[0])) {
+        case BINARY_ARG_INT: {
+            int64_t number = 0;
+            memcpy(&number, value, sizeof(number));
+            ss << number;
+            break;
+        }
+        case BINARY_ARG_UINT: {
+            uint64_t number = 0;
+            memcpy(&number, value, sizeof(number));
+            ss << number;
+            break;
+        }
+        case BINARY_ARG_DOUBLE: {
+            double number = 0;
+            memcpy(&number, value, sizeof(number));
+            ss << number;
+            break;
+        }
+        case BINARY_ARG_BOOL:
+            ss << static_cast<int>(value[0]);
+            break;
+        case BINARY_ARG_CHAR:
+            ss << value[0];
+            break;
+        case BINARY_ARG_STRING: {
+            uint16_t length = 0;
+            memcpy(&length, value, sizeof(length));
+            ss << std::string(value + sizeof(length), length);
+            break;
+        }
+        case BINARY_ARG_POINTER: {
+            uint64_t pointer = 0;
+            memcpy(&pointer, value, sizeof(pointer));
+            ss << "0x" << std::hex << pointer << std::dec;
+            break;
+        }
+        default:
+            ss << "<unknown argument>";
+            break;
+    }
+}
+
+// "{}" in the format is replaced by the next argument, the arguments left are appended separated by spaces
+inline std::string FormatBinaryRecord(const std::string &format, const char *args, uint8_t argNum)
+{
+    std::ostringstream ss;
+    size_t pos = 0;
+    for (uint8_t i = 0; i < argNum; i++) {
+        size_t next = format.find("{}", pos);
+        if (next == std::string::npos) {
+            ss << format.substr(pos) << " ";
+            pos = format.size();
+        } else {
+            ss << format.substr(pos, next - pos);
+            pos = next + strlen("{}");
+        }
+        FormatBinaryArg(ss, args);
+        args += GetBinaryArgSize(args);
+    }
+    ss << format.substr(pos);
+    return ss.str();
+}
+} // namespace AtlasAscendLog
+
+// the site of a statement is registered the first time it runs, a disabled statement costs what LogDebug costs
+#define ASCEND_LOG_BINARY(level, format, ...)                                                              \
+    do {                                                                                                     \
+        if (static_cast<int>(level) >= ASCEND_LOG_MIN_LEVEL && AtlasAscendLog::Log::IsEnabled(level)) {      \
+            static const uint32_t ascendLogSiteId =                                                          \
+                AtlasAscendLog::BinaryLog::RegisterSite(level, __FILE__, __FUNCTION__, __LINE__, format);    \
+            AtlasAscendLog::BinaryLog::Write(ascendLogSiteId, ##__VA_ARGS__);                                \
+        }                                                                                                    \
+    } while (0)
+
+#define LogBinDebug(format, ...) ASCEND_LOG_BINARY(AtlasAscendLog::LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#define LogBinInfo(format, ...) ASCEND_LOG_BINARY(AtlasAscendLog::LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#define LogBinWarn(format, ...) ASCEND_LOG_BINARY(AtlasAscendLog::LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#define LogBinError(format, ...) ASCEND_LOG_BINARY(AtlasAscendLog::LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+
+#endif
@@ -13,26 +13,317 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
 #include <fstream>
-#include <iomanip>
+#include <future>
 #include <iostream>
+#include <thread>
 #include <sys/stat.h>
 #include <sys/time.h>
 #include <unistd.h>
 #include <FileManager/FileManager.h>
 
+#include "RingQueue/RingQueue.h"
 #include "Log.h"
 
 namespace AtlasAscendLog {
 const int TIME_SIZE = 32;
-const int TIME_DIFF = 28800; // 8 hour
 const int BYTES6 = 6;
-uint32_t Log::logLevel = LOG_LEVEL_INFO;
+const int DECIMAL = 10;
+std::atomic<uint32_t> Log::logLevel(LOG_LEVEL_INFO);
+std::atomic<uint32_t> Log::rateLimit[LOG_LEVEL_NONE];
+std::atomic<uint32_t> Log::rateBurst[LOG_LEVEL_NONE];
 std::vector<std::string> Log::levelString({ "[Debug]", "[Info ]", "[Warn ]", "[Error]", "[Fatal]" });
 std::mutex Log::mutex;
 std::string Log::logFile = "./logs/log.log"; // default log file, for linux
 
-Log::Log(std::string file, std::string function, int line, uint32_t level)
+namespace {
+const uint32_t LOG_BATCH_SIZE = 256; // lines written at once by the async writer
+
+struct LogLine {
+    std::string text = "";
+    std::string day = "";
+    std::shared_ptr<std::promise<void>> written = nullptr; // set once the line is written, Flush and fatal lines
+};
+
+const int UTC_OFFSET_UNSET = INT_MIN;
+std::atomic<int> g_utcOffset(UTC_OFFSET_UNSET); // seconds, the offset of the local time zone until SetUtcOffset
+
+// the text of the current second and the daily file of every thread, rebuilt when the second or the day changes;
+// plain arrays so that the lines logged at exit, after the thread_local objects are destroyed, can still use it
+struct LogTimeCache {
+    time_t second;
+    int utcOffset;
+    char prefix[TIME_SIZE]; // [<date> <time>:
+    size_t prefixLength;
+    char day[TIME_SIZE];
+    char fileDay[TIME_SIZE];
+    char file[PATH_MAX];
+};
+
+thread_local LogTimeCache t_timeCache = { -1, 0, {0}, 0, {0}, {0}, {0} };
+
+// [<date> <time>:<microseconds>], day is set to the <date> part
+void FormatTime(std::ostringstream &ss, std::string &day)
+{
+    struct timeval time = { 0, 0 };
+    gettimeofday(&time, nullptr);
+    LogTimeCache &cache = t_timeCache;
+    int utcOffset = Log::GetUtcOffset();
+    if (time.tv_sec != cache.second || utcOffset != cache.utcOffset) {
+        time_t timep = time.tv_sec + utcOffset;
+        struct tm tmBuf = {};
+        cache.prefixLength = strftime(cache.prefix, TIME_SIZE, "[%F %X:", gmtime_r(&timep, &tmBuf));
+        const char *space = strchr(cache.prefix, ' ');
+        size_t dayLength = (space == nullptr) ? 0 : space - cache.prefix - 1;
+        memcpy(cache.day, cache.prefix + 1, dayLength);
+        cache.day[dayLength] = '\0';
+        cache.second = time.tv_sec;
+        cache.utcOffset = utcOffset;
+    }
+    char microseconds[BYTES6 + 1] = {0};
+    long value = time.tv_usec;
+    for (int i = BYTES6 - 1; i >= 0; i--) {
+        microseconds[i] = static_cast<char>('0' + value % DECIMAL);
+        value /= DECIMAL;
+    }
+    microseconds[BYTES6] = ']';
+    ss.write(cache.prefix, cache.prefixLength).write(microseconds, sizeof(microseconds));
+    day = cache.day;
+}
+
+// <logFile without extension>_<day>.<extension>
+std::string GetDailyFile(const std::string &logFile, const std::string &day)
+{
+    size_t posDot = logFile.rfind(".");
+    return logFile.substr(0, posDot) + "_" + day + logFile.substr(posDot);
+}
+
+// the daily file of the lines written by this thread, its directory is created once a day
+const char *GetThreadDailyFile(const std::string &logFile, const std::string &day, std::string &longFile)
+{
+    LogTimeCache &cache = t_timeCache;
+    if (day == cache.fileDay) {
+        return cache.file;
+    }
+    CreateDirRecursivelyByFile(logFile);
+    longFile = GetDailyFile(logFile, day);
+    if (longFile.size() >= sizeof(cache.file) || day.size() >= sizeof(cache.fileDay)) {
+        return longFile.c_str();
+    }
+    memcpy(cache.file, longFile.c_str(), longFile.size() + 1);
+    memcpy(cache.fileDay, day.c_str(), day.size() + 1);
+    return cache.file;
+}
+
+// set in the thread of LogWriter, what it logs itself (CreateDirRecursivelyByFile failing in OpenFile) is not
+// queued: with LOG_OVERFLOW_BLOCK and a full queue it would wait for itself
+thread_local bool t_isLogWriter = false;
+
+// one thread writing the lines queued by all the others, the daily file stays open until the day changes
+class LogWriter {
+public:
+    LogWriter(const std::string &logFile, uint32_t bufferSize, LogOverflowPolicy overflowPolicy)
+        : logFile_(logFile), overflowPolicy_(overflowPolicy), queue_(bufferSize)
+    {
+        writeThread_ = std::thread(&LogWriter::WriteThread, this);
+    }
+
+    ~LogWriter()
+    {
+        queue_.Stop();
+        writeThread_.join();
+    }
+
+    // wait for the line to be written when isFlush is true, return false if the queue is stopped
+    bool Push(LogLine &line, bool isFlush)
+    {
+        std::future<void> written;
+        if (isFlush) {
+            line.written = std::make_shared<std::promise<void>>();
+            written = line.written->get_future();
+        }
+        bool isWait = isFlush || overflowPolicy_ == LOG_OVERFLOW_BLOCK;
+        APP_ERROR ret = queue_.Push(std::move(line), isWait);
+        if (ret == APP_ERROR_QUEUE_FULL) {
+            droppedNum_++;
+            return true;
+        }
+        if (ret != APP_ERR_OK) {
+            return false;
+        }
+        if (isFlush) {
+            written.wait();
+        }
+        return true;
+    }
+
+private:
+    void WriteThread()
+    {
+        t_isLogWriter = true;
+        std::vector<LogLine> lines;
+        while (queue_.PopBatch(lines, LOG_BATCH_SIZE, 0) == APP_ERR_OK) {
+            WriteLines(lines);
+        }
+        // the queue is stopped, write what is left
+        std::list<LogLine> remains = queue_.GetRemainItems();
+        lines.assign(std::make_move_iterator(remains.begin()), std::make_move_iterator(remains.end()));
+        WriteLines(lines);
+    }
+
+    void WriteLines(std::vector<LogLine> &lines)
+    {
+        std::string screen;
+        for (auto &line : lines) {
+            if (line.text.empty()) {
+                continue;
+            }
+            screen += line.text + "\n";
+            if (line.day != day_) {
+                OpenFile(line.day);
+            }
+            if (file_) {
+                file_ << line.text << "\n";
+            }
+        }
+        uint64_t droppedNum = droppedNum_.exchange(0);
+        if (droppedNum > 0) {
+            std::ostringstream notice;
+            std::string date;
+            notice << "[Warn ]";
+            FormatTime(notice, date);
+            notice << " " << droppedNum << " log lines dropped, the log buffer is full";
+            screen += notice.str() + "\n";
+            if (file_) {
+                file_ << notice.str() << "\n";
+            }
+        }
+        if (file_) {
+            file_.flush();
+        }
+        std::cout << screen << std::flush;
+        for (auto &line : lines) {
+            if (line.written != nullptr) {
+                line.written->set_value();
+            }
+        }
+    }
+
+    void OpenFile(const std::string &day)
+    {
+        day_ = day;
+        file_.close();
+        file_.clear();
+        CreateDirRecursivelyByFile(logFile_);
+        std::string file = GetDailyFile(logFile_, day);
+        file_.open(file, std::ios::app);
+        if (!file_) {
+            std::cout << "open file " << file << " fail" << std::endl;
+        }
+    }
+
+    std::string logFile_;
+    LogOverflowPolicy overflowPolicy_;
+    RingQueue<LogLine> queue_;
+    std::atomic<uint64_t> droppedNum_ = {};
+    std::string day_ = "";
+    std::ofstream file_ = {};
+    std::thread writeThread_ = {};
+};
+
+std::mutex g_asyncMutex; // serializes StartAsync and StopAsync
+std::unique_ptr<LogWriter> g_writer = nullptr;
+std::atomic<bool> g_isAsync(false);
+// threads between their check of g_isAsync and the end of their push, StopAsync waits for them
+std::atomic<int> g_pushingNum(0);
+
+// return false if the line must be written by the logging thread
+bool PushAsync(LogLine &line, bool isFlush)
+{
+    if (t_isLogWriter) {
+        // the file of the writer may be the one failing, the line goes to stderr only, also once StopAsync is called
+        std::cerr << line.text << std::endl;
+        return true;
+    }
+    if (!g_isAsync) {
+        return false;
+    }
+    g_pushingNum++;
+    bool isPushed = g_isAsync && g_writer->Push(line, isFlush);
+    g_pushingNum--;
+    return isPushed;
+}
+
+void StopAsyncAtExit()
+{
+    Log::StopAsync();
+}
+
+const int64_t NS_PER_SECOND = 1000000000;
+
+std::mutex g_siteMutex;
+std::vector<LogSite *> g_suppressingSites; // the statements which were over their rate once, for WriteSuppressed
+
+int64_t GetSteadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const uint32_t SUPPRESSED_CHECK_MS = 1000;
+
+// writes the summaries which are due of the statements over their rate, whether they run again or not; started
+// with the async log by StartAsync, stopped by StopAsync before the writer
+class SuppressedReporter {
+public:
+    SuppressedReporter()
+    {
+        reportThread_ = std::thread(&SuppressedReporter::ReportThread, this);
+    }
+
+    ~SuppressedReporter()
+    {
+        {
+            std::lock_guard<std::mutex> locker(mutex_);
+            isStop_ = true;
+        }
+        stopCond_.notify_all();
+        reportThread_.join();
+    }
+
+private:
+    void ReportThread()
+    {
+        std::unique_lock<std::mutex> locker(mutex_);
+        while (!stopCond_.wait_for(locker, std::chrono::milliseconds(SUPPRESSED_CHECK_MS),
+            [this]() { return isStop_; })) {
+            locker.unlock();
+            int64_t now = GetSteadyNs();
+            std::lock_guard<std::mutex> siteLocker(g_siteMutex);
+            for (auto site : g_suppressingSites) {
+                site->WriteSuppressedIfDue(now);
+            }
+            locker.lock();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable stopCond_;
+    bool isStop_ = false;
+    std::thread reportThread_ = {};
+};
+
+std::unique_ptr<SuppressedReporter> g_reporter = nullptr; // under g_asyncMutex
+}
+
+Log::Log(const char *file, const char *function, int line, uint32_t level)
     : myLevel_(level), file_(file), function_(function), line_(line)
 {
 }
@@ -40,15 +331,24 @@ Log::Log(std::string file, std::string function, int line, uint32_t level)
 Log::~Log()
 {
     if (myLevel_ >= logLevel) {
+        LogLine line;
+        line.text = ss_.str();
+        line.day = day_;
+        if (PushAsync(line, myLevel_ == LOG_LEVEL_FATAL)) {
+            return;
+        }
         std::lock_guard<std::mutex> locker(mutex);
         // cout to screen
         std::cout << ss_.str() << std::endl;
         // log to the file
-        CreateDirRecursivelyByFile(logFile);
-        size_t posDot = logFile.rfind(".");
-        std::string dataString = date_.substr(date_.find('[') + 1, date_.find(' ') - date_.find('[') - 1);
-        std::string file = logFile.substr(0, posDot) + "_" + dataString + logFile.substr(posDot);
+        std::string longFile;
+        const char *file = GetThreadDailyFile(logFile, day_, longFile);
         std::ofstream fs(file, std::ios::app);
+        if (!fs) {
+            // the directory was removed since it was created for the day
+            CreateDirRecursivelyByFile(logFile);
+            fs.open(file, std::ios::app);
+        }
         if (!fs) {
             std::cout << "open file " << file << " fail" << std::endl;
             return;
@@ -61,18 +361,10 @@ Log::~Log()
 std::ostringstream &Log::Stream()
 {
     if (myLevel_ >= logLevel) {
-        struct timeval time = { 0, 0 };
-        gettimeofday(&time, nullptr);
-        time_t timep = time.tv_sec + TIME_DIFF;
-        struct tm *ptm = gmtime(&timep);
-        char timeString[TIME_SIZE] = {0};
-        strftime(timeString, TIME_SIZE, "[%F %X:", ptm);
-        date_ = timeString;
-
-        ss_.fill('0');
-        ss_ << levelString[myLevel_] << timeString << std::setw(BYTES6) << time.tv_usec << "]";
-
-        std::string fileName = file_.substr(file_.rfind('/') + 1); // for linux
+        ss_ << levelString[myLevel_];
+        FormatTime(ss_, day_);
+        const char *fileName = strrchr(file_, '/'); // for linux
+        fileName = (fileName == nullptr) ? file_ : fileName + 1;
         ss_ << "[" << fileName << " " << function_ << ":" << line_ << "] ";
     }
     return ss_;
@@ -114,6 +406,160 @@ void Log::LogAllOff()
     return;
 }
 
+APP_ERROR Log::StartAsync(uint32_t bufferSize, LogOverflowPolicy overflowPolicy)
+{
+    std::lock_guard<std::mutex> locker(g_asyncMutex);
+    if (g_writer != nullptr) {
+        return APP_ERR_OK;
+    }
+    static bool isAtExitSet = false;
+    if (!isAtExitSet && std::atexit(StopAsyncAtExit) != 0) {
+        return APP_ERR_COMM_FAILURE;
+    }
+    isAtExitSet = true;
+    g_writer.reset(new LogWriter(logFile, bufferSize, overflowPolicy));
+    g_isAsync = true;
+    g_reporter.reset(new SuppressedReporter);
+    return APP_ERR_OK;
+}
+
+void Log::StopAsync()
+{
+    std::lock_guard<std::mutex> locker(g_asyncMutex);
+    // the reporter is joined first, the summaries left are then queued to the writer still running
+    g_reporter.reset();
+    WriteSuppressed();
+    if (g_writer == nullptr) {
+        return;
+    }
+    // the lines logged from now on are written by their thread, the writer writes the queued ones and exits
+    g_isAsync = false;
+    while (g_pushingNum > 0) {
+        std::this_thread::yield();
+    }
+    g_writer.reset();
+}
+
+int Log::GetUtcOffset()
+{
+    int utcOffset = g_utcOffset.load(std::memory_order_relaxed);
+    if (utcOffset != UTC_OFFSET_UNSET) {
+        return utcOffset;
+    }
+    // the offset of the local time zone, read once
+    time_t now = time(nullptr);
+    struct tm tmBuf = {};
+    utcOffset = (localtime_r(&now, &tmBuf) == nullptr) ? 0 : static_cast<int>(tmBuf.tm_gmtoff);
+    int unset = UTC_OFFSET_UNSET;
+    g_utcOffset.compare_exchange_strong(unset, utcOffset, std::memory_order_relaxed);
+    return g_utcOffset.load(std::memory_order_relaxed);
+}
+
+void Log::SetUtcOffset(int seconds)
+{
+    g_utcOffset = seconds;
+}
+
+void Log::SetDefaultRateLimit(uint32_t linesPerSecond, uint32_t burst)
+{
+    for (uint32_t level = LOG_LEVEL_DEBUG; level < LOG_LEVEL_FATAL; level++) {
+        SetLevelRateLimit(level, linesPerSecond, burst);
+    }
+}
+
+void Log::SetLevelRateLimit(uint32_t level, uint32_t linesPerSecond, uint32_t burst)
+{
+    if (level >= LOG_LEVEL_NONE) {
+        return;
+    }
+    rateBurst[level] = (burst == 0) ? linesPerSecond : burst;
+    rateLimit[level] = linesPerSecond;
+}
+
+void Log::WriteSuppressed()
+{
+    std::lock_guard<std::mutex> locker(g_siteMutex);
+    for (auto site : g_suppressingSites) {
+        site->WriteSuppressed();
+    }
+}
+
+LogSite::LogSite(const char *file, const char *function, int line, uint32_t level, uint32_t linesPerSecond)
+    : file_(file), function_(function), line_(line), level_(level), linesPerSecond_(linesPerSecond), fullNs_(0),
+      suppressedNum_(0), summaryNs_(0), isListed_(false)
+{
+}
+
+// the bucket is kept as the time it is full again: a line takes one interval of tokens and is let through when
+// the bucket still holds them, with a single compare and swap whatever the number of threads logging
+bool LogSite::Allow()
+{
+    uint32_t linesPerSecond = linesPerSecond_;
+    uint32_t burst = linesPerSecond_;
+    if (linesPerSecond == 0) {
+        linesPerSecond = Log::rateLimit[level_].load(std::memory_order_relaxed);
+        burst = Log::rateBurst[level_].load(std::memory_order_relaxed);
+    }
+    if (linesPerSecond == 0) {
+        return true;
+    }
+    int64_t interval = NS_PER_SECOND / linesPerSecond;
+    int64_t capacity = interval * std::max(burst, 1u);
+    int64_t now = GetSteadyNs();
+    int64_t fullNs = fullNs_.load(std::memory_order_relaxed);
+    bool isAllowed = false;
+    while (true) {
+        int64_t nextFullNs = std::max(fullNs, now) + interval;
+        isAllowed = (nextFullNs - now <= capacity);
+        if (!isAllowed || fullNs_.compare_exchange_weak(fullNs, nextFullNs, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    if (!isAllowed && suppressedNum_.fetch_add(1, std::memory_order_relaxed) == 0) {
+        // first line of a run of suppressed ones, their number is written in LOG_SUPPRESSED_INTERVAL_SEC seconds
+        summaryNs_.store(now + LOG_SUPPRESSED_INTERVAL_SEC * NS_PER_SECOND, std::memory_order_relaxed);
+        if (!isListed_.exchange(true)) {
+            std::lock_guard<std::mutex> locker(g_siteMutex);
+            g_suppressingSites.push_back(this);
+        }
+        return false;
+    }
+    // the summary is written by the first statement run once it is due, before the line let through if any
+    WriteSuppressedIfDue(now);
+    return isAllowed;
+}
+
+void LogSite::WriteSuppressedIfDue(int64_t nowNs)
+{
+    int64_t summaryNs = summaryNs_.load(std::memory_order_relaxed);
+    if (nowNs >= summaryNs && suppressedNum_.load(std::memory_order_relaxed) != 0 &&
+        summaryNs_.compare_exchange_strong(summaryNs, nowNs + LOG_SUPPRESSED_INTERVAL_SEC * NS_PER_SECOND,
+        std::memory_order_relaxed)) {
+        WriteSuppressed();
+    }
+}
+
+void LogSite::WriteSuppressed()
+{
+    WriteSuppressed(suppressedNum_.exchange(0, std::memory_order_relaxed));
+}
+
+void LogSite::WriteSuppressed(uint64_t suppressedNum)
+{
+    if (suppressedNum == 0) {
+        return;
+    }
+    uint32_t linesPerSecond = (linesPerSecond_ != 0) ? linesPerSecond_ : Log::rateLimit[level_].load();
+    Log(file_, function_, line_, level_).Stream() << suppressedNum << " lines of this statement suppressed, over "
+                                                  << linesPerSecond << " lines per second";
+}
+
+void Log::Flush()
+{
+    LogLine line;
+    PushAsync(line, true);
+}
+
 #define LOG_DEBUG Log(__FILE__, __FUNCTION__, __LINE__, AtlasAscendLog::LOG_LEVEL_DEBUG)
 #define LOG_INFO Log(__FILE__, __FUNCTION__, __LINE__, AtlasAscendLog::LOG_LEVEL_INFO)
 #define LOG_WARN Log(__FILE__, __FUNCTION__, __LINE__, AtlasAscendLog::LOG_LEVEL_WARN)
@@ -16,10 +16,12 @@
 #ifndef LOG_H
 #define LOG_H
 
+#include <atomic>
 #include <mutex>
 #include <sstream>
 #include <string>
 #include <vector>
+#include "ErrorCode/ErrorCode.h"
 
 namespace AtlasAscendLog {
 // log level
@@ -32,11 +34,30 @@ enum LogLevels {
     LOG_LEVEL_NONE
 };
 
+// the statements below this level are compiled out, -DASCEND_LOG_MIN_LEVEL=1 drops LogDebug from a release build
+#ifndef ASCEND_LOG_MIN_LEVEL
+#define ASCEND_LOG_MIN_LEVEL 0
+#endif
+
+// what a thread does when the buffer of the async writer is full
+enum LogOverflowPolicy {
+    LOG_OVERFLOW_BLOCK = 0, // wait for room
+    LOG_OVERFLOW_DROP       // drop the line, the writer logs how many lines were dropped; never a fatal line
+};
+
+const uint32_t LOG_BUFFER_SIZE = 8192; // lines queued to the async writer
+const uint32_t LOG_FRAME_RATE_LIMIT = 10; // lines per second of a statement run for every frame, see LogErrorLimited
+const uint32_t LOG_SUPPRESSED_INTERVAL_SEC = 5; // a statement over its rate writes how many lines it suppressed
+
 class Log {
 public:
-    Log(std::string file, std::string function, int line, uint32_t level);
+    Log(const char *file, const char *function, int line, uint32_t level);
     ~Log();
     std::ostringstream &Stream();
+    static bool IsEnabled(uint32_t level)
+    {
+        return level >= logLevel.load(std::memory_order_relaxed);
+    }
     // log switch, turn on and off both screen and file log of special level.
     static void LogDebugOn();
     static void LogInfoOn();
@@ -45,27 +66,115 @@ public:
     static void LogFatalOn();
     static void LogAllOn();
     static void LogAllOff();
+    // queue the lines to a writer thread keeping the log file open instead of writing them in the logging thread,
+    // a fatal line is written before LogFatal returns and the queued lines are written at exit or by StopAsync;
+    // a reporter thread writes the summaries which are due of the statements over their rate until StopAsync;
+    // does nothing when already started
+    static APP_ERROR StartAsync(uint32_t bufferSize = LOG_BUFFER_SIZE,
+        LogOverflowPolicy overflowPolicy = LOG_OVERFLOW_BLOCK);
+    static void StopAsync();
+    // return once the lines logged so far by this thread are written
+    static void Flush();
+    // seconds added to UTC in the time of the lines and the name of the daily files, the offset of the local time
+    // zone read at the first line unless SetUtcOffset is called
+    static int GetUtcOffset();
+    static void SetUtcOffset(int seconds);
+    // every statement of the levels below LOG_LEVEL_FATAL writes at most linesPerSecond lines per second, burst of
+    // them at once (linesPerSecond when 0), and counts the others; 0 lines per second turns the limit off
+    static void SetDefaultRateLimit(uint32_t linesPerSecond, uint32_t burst = 0);
+    // the same for the statements of one level, LOG_LEVEL_FATAL included
+    static void SetLevelRateLimit(uint32_t level, uint32_t linesPerSecond, uint32_t burst = 0);
+    static bool IsRateLimited(uint32_t level)
+    {
+        return level < LOG_LEVEL_NONE && rateLimit[level].load(std::memory_order_relaxed) != 0;
+    }
+    // write the count of the lines suppressed since the last summary of every statement, by StopAsync as well
+    static void WriteSuppressed();
 
 private:
+    friend class BinaryLog;
+    friend class LogSite;
+
     std::ostringstream ss_;
     uint32_t myLevel_;
-    std::string date_;
-    std::string file_;
-    std::string function_;
+    std::string day_;
+    const char *file_;
+    const char *function_;
     int line_;
 
-    static uint32_t logLevel;
+    static std::atomic<uint32_t> logLevel;
+    static std::atomic<uint32_t> rateLimit[LOG_LEVEL_NONE]; // lines per second of every statement, 0 unlimited
+    static std::atomic<uint32_t> rateBurst[LOG_LEVEL_NONE];
     static std::vector<std::string> levelString;
     static std::mutex mutex;
     static std::string logFile;
 };
+
+// token bucket of one statement, kept in a static of the statement by the macros below; the lines over the rate
+// are counted and their number is written once LOG_SUPPRESSED_INTERVAL_SEC seconds have passed, by the statement
+// or by a thread checking the statements over their rate every second when the statement does not run again
+class LogSite {
+public:
+    // a linesPerSecond of 0 follows the rate limit of the level
+    LogSite(const char *file, const char *function, int line, uint32_t level, uint32_t linesPerSecond);
+    // false when the line is over the rate, it is counted then
+    bool Allow();
+    void WriteSuppressed();
+    // write the summary if it is due at nowNs, steady clock
+    void WriteSuppressedIfDue(int64_t nowNs);
+
+private:
+    void WriteSuppressed(uint64_t suppressedNum);
+
+    const char *file_;
+    const char *function_;
+    int line_;
+    uint32_t level_;
+    uint32_t linesPerSecond_;
+    // time the bucket is full again, the bucket is empty at fullNs_ - burst * interval
+    std::atomic<int64_t> fullNs_;
+    std::atomic<uint64_t> suppressedNum_;
+    std::atomic<int64_t> summaryNs_; // time of the next summary of a run of suppressed lines
+    std::atomic<bool> isListed_;      // in the list of WriteSuppressed
+};
+
+// turns the stream of an enabled statement into void, & binds looser than << and tighter than ?:
+struct LogVoidify {
+    void operator&(std::ostream &) {}
+};
 } // namespace AtlasAscendLog
 
-#define LogDebug AtlasAscendLog::Log(__FILE__, __FUNCTION__, __LINE__, AtlasAscendLog::LOG_LEVEL_DEBUG).Stream()
-#define LogInfo AtlasAscendLog::Log(__FILE__, __FUNCTION__, __LINE__, AtlasAscendLog::LOG_LEVEL_INFO).Stream()
-#define LogWarn AtlasAscendLog::Log(__FILE__, __FUNCTION__, __LINE__, AtlasAscendLog::LOG_LEVEL_WARN).Stream()
-#define LogError AtlasAscendLog::Log(__FILE__, __FUNCTION__, __LINE__, AtlasAscendLog::LOG_LEVEL_ERROR).Stream()
-#define LogFatal AtlasAscendLog::Log(__FILE__, __FUNCTION__, __LINE__, AtlasAscendLog::LOG_LEVEL_FATAL).Stream()
+// the LogSite of the statement, built the first time a rate limit applies to it; linesPerSecond is a constant
+#define ASCEND_LOG_SITE(level, linesPerSecond)                                                              \
+    [](const char *function, uint32_t siteLevel) -> AtlasAscendLog::LogSite & {                            \
+        static AtlasAscendLog::LogSite site(__FILE__, function, __LINE__, siteLevel, linesPerSecond);      \
+        return site;                                                                                        \
+    }(__FUNCTION__, level)
+
+// a disabled statement neither constructs a Log nor evaluates its << operands, and the ones below
+// ASCEND_LOG_MIN_LEVEL are dropped by the compiler; the rate limit of the level is checked by the enabled ones only
+#define ASCEND_LOG(level)                                                                                   \
+    (static_cast<int>(level) < ASCEND_LOG_MIN_LEVEL || !AtlasAscendLog::Log::IsEnabled(level) ||            \
+        (AtlasAscendLog::Log::IsRateLimited(level) && !ASCEND_LOG_SITE(level, 0).Allow())) ? (void)0 :      \
+        AtlasAscendLog::LogVoidify() & AtlasAscendLog::Log(__FILE__, __FUNCTION__, __LINE__, level).Stream()
+
+// at most linesPerSecond lines per second from this statement whatever the limit of its level, for the statements
+// which may run for every frame
+#define ASCEND_LOG_LIMITED(level, linesPerSecond)                                                           \
+    (static_cast<int>(level) < ASCEND_LOG_MIN_LEVEL || !AtlasAscendLog::Log::IsEnabled(level) ||            \
+        !ASCEND_LOG_SITE(level, linesPerSecond).Allow()) ? (void)0 :                                        \
+        AtlasAscendLog::LogVoidify() & AtlasAscendLog::Log(__FILE__, __FUNCTION__, __LINE__, level).Stream()
+
+#define LogDebug ASCEND_LOG(AtlasAscendLog::LOG_LEVEL_DEBUG)
+#define LogInfo ASCEND_LOG(AtlasAscendLog::LOG_LEVEL_INFO)
+#define LogWarn ASCEND_LOG(AtlasAscendLog::LOG_LEVEL_WARN)
+#define LogError ASCEND_LOG(AtlasAscendLog::LOG_LEVEL_ERROR)
+#define LogFatal ASCEND_LOG(AtlasAscendLog::LOG_LEVEL_FATAL)
+#define LogDebugLimited(linesPerSecond) ASCEND_LOG_LIMITED(AtlasAscendLog::LOG_LEVEL_DEBUG, linesPerSecond)
+#define LogInfoLimited(linesPerSecond) ASCEND_LOG_LIMITED(AtlasAscendLog::LOG_LEVEL_INFO, linesPerSecond)
+#define LogWarnLimited(linesPerSecond) ASCEND_LOG_LIMITED(AtlasAscendLog::LOG_LEVEL_WARN, linesPerSecond)
+#define LogErrorLimited(linesPerSecond) ASCEND_LOG_LIMITED(AtlasAscendLog::LOG_LEVEL_ERROR, linesPerSecond)
+#define LogFatalLimited(linesPerSecond) ASCEND_LOG_LIMITED(AtlasAscendLog::LOG_LEVEL_FATAL, linesPerSecond)
 #define LOG(security) AtlasAscendLog::LOG_##security.Stream()
 
 #endif
\ No newline at end of file
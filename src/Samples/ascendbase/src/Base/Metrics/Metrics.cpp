@@ -0,0 +1,517 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Metrics/Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Log/Log.h"
+
+namespace {
+const uint32_t SUB_BUCKET_BITS = 4;
+const uint32_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+const uint32_t BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT; // enough for any uint64_t
+const std::vector<double> EXPORT_QUANTILES = { 0.5, 0.9, 0.99, 0.999 };
+const int HTTP_BACKLOG = 4;
+const int HTTP_POLL_MS = 200;
+const size_t HTTP_REQUEST_SIZE = 1024;
+const int RECORD_PRECISION = 10;
+const std::vector<std::string> RECORD_COLUMNS = { "value", "rate_per_s", "count", "sum", "p50", "p90", "p99", "p999" };
+
+std::mutex g_runMetadataMutex;
+std::map<std::string, std::string> g_runMetadata;
+
+std::string FormatJsonString(const std::string &value)
+{
+    std::ostringstream text;
+    text << "\"";
+    for (unsigned char c : value) {
+        if (c == '"' || c == '\\') {
+            text << '\\' << c;
+        } else if (c < ' ') {
+            text << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        } else {
+            text << c;
+        }
+    }
+    text << "\"";
+    return text.str();
+}
+
+// quoted when it holds a comma, a quote or a line break, the quotes doubled
+std::string FormatCsvField(const std::string &value)
+{
+    if (value.find_first_of(",\"\r\n") == std::string::npos) {
+        return value;
+    }
+    std::string text = "\"";
+    for (char c : value) {
+        text += (c == '"') ? "\"\"" : std::string(1, c);
+    }
+    return text + "\"";
+}
+
+std::string FormatLabels(const MetricLabels &labels)
+{
+    std::string text;
+    for (auto &label : labels) {
+        text += (text.empty() ? "" : ",") + label.first + "=\"";
+        for (char c : label.second) {
+            if (c == '\n') {
+                text += "\\n";
+                continue;
+            }
+            if (c == '"' || c == '\\') {
+                text.push_back('\\');
+            }
+            text.push_back(c);
+        }
+        text += "\"";
+    }
+    return text;
+}
+
+// name{labels} or name{labels,extra}, without braces when both are empty
+std::string FormatSample(const std::string &name, const std::string &labels, const std::string &extra = "")
+{
+    std::string allLabels = labels + ((labels.empty() || extra.empty()) ? "" : ",") + extra;
+    return allLabels.empty() ? name : name + "{" + allLabels + "}";
+}
+}
+
+MetricHistogram::MetricHistogram() : buckets_(BUCKET_COUNT) {}
+
+// values below 2 * SUB_BUCKET_COUNT get a bucket each, above the bucket width doubles every SUB_BUCKET_COUNT buckets
+uint32_t MetricHistogram::GetBucketIndex(uint64_t value)
+{
+    if (value < 2 * SUB_BUCKET_COUNT) {
+        return value;
+    }
+    uint32_t shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+    return (shift + 1) * SUB_BUCKET_COUNT + (value >> shift) - SUB_BUCKET_COUNT;
+}
+
+uint64_t MetricHistogram::GetBucketUpperBound(uint32_t index)
+{
+    if (index < 2 * SUB_BUCKET_COUNT) {
+        return index;
+    }
+    uint32_t shift = index / SUB_BUCKET_COUNT - 1;
+    uint64_t lowerBound = static_cast<uint64_t>(SUB_BUCKET_COUNT + index % SUB_BUCKET_COUNT) << shift;
+    return lowerBound + ((1ULL << shift) - 1);
+}
+
+void MetricHistogram::Record(uint64_t value)
+{
+    buckets_[GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(value, std::memory_order_relaxed);
+    uint64_t maxValue = max_.load(std::memory_order_relaxed);
+    while (value > maxValue && !max_.compare_exchange_weak(maxValue, value, std::memory_order_relaxed)) {
+    }
+}
+
+void MetricHistogram::Add(const MetricHistogram &other)
+{
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        uint64_t bucketCount = other.buckets_[i].load(std::memory_order_relaxed);
+        if (bucketCount != 0) {
+            buckets_[i].fetch_add(bucketCount, std::memory_order_relaxed);
+        }
+    }
+    count_.fetch_add(other.GetCount(), std::memory_order_relaxed);
+    sum_.fetch_add(other.GetSum(), std::memory_order_relaxed);
+    uint64_t value = other.GetMax();
+    uint64_t maxValue = max_.load(std::memory_order_relaxed);
+    while (value > maxValue && !max_.compare_exchange_weak(maxValue, value, std::memory_order_relaxed)) {
+    }
+}
+
+void MetricHistogram::AddBuckets(std::vector<uint64_t> &buckets) const
+{
+    buckets.resize(BUCKET_COUNT);
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        buckets[i] += buckets_[i].load(std::memory_order_relaxed);
+    }
+}
+
+uint32_t MetricHistogram::GetBucketCount()
+{
+    return BUCKET_COUNT;
+}
+
+uint64_t MetricHistogram::GetQuantile(double quantile) const
+{
+    uint64_t count = GetCount();
+    if (count == 0) {
+        return 0;
+    }
+    // the buckets are read one by one while Record goes on, so the rank is capped by what is actually read
+    uint64_t rank = static_cast<uint64_t>(quantile * count);
+    rank = (rank == 0) ? 1 : rank;
+    uint64_t seen = 0;
+    uint32_t index = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        uint64_t bucketCount = buckets_[i].load(std::memory_order_relaxed);
+        if (bucketCount == 0) {
+            continue;
+        }
+        seen += bucketCount;
+        index = i;
+        if (seen >= rank) {
+            break;
+        }
+    }
+    return std::min(GetBucketUpperBound(index), GetMax());
+}
+
+MetricsRecordFile::MetricsRecordFile(const std::string &fileName, const std::vector<std::string> &columns)
+    : fileName_(fileName), columns_(columns)
+{
+    const std::string jsonExtension = ".jsonl";
+    isJson_ = fileName_.size() >= jsonExtension.size() &&
+        fileName_.compare(fileName_.size() - jsonExtension.size(), jsonExtension.size(), jsonExtension) == 0;
+}
+
+void MetricsRecordFile::SetRunMetadata(const std::string &key, const std::string &value)
+{
+    std::lock_guard<std::mutex> lock(g_runMetadataMutex);
+    g_runMetadata[key] = value;
+}
+
+std::string MetricsRecordFile::FormatRecord(const MetricsRecord &record, double time) const
+{
+    std::ostringstream text;
+    text << std::setprecision(RECORD_PRECISION);
+    if (isJson_) {
+        text << "{\"time\":" << std::fixed << std::setprecision(3) << time << std::defaultfloat
+             << std::setprecision(RECORD_PRECISION) << ",\"type\":" << FormatJsonString(record.type) << ",\"name\":"
+             << FormatJsonString(record.name) << ",\"labels\":" << FormatJsonString(record.labels);
+        for (size_t i = 0; i < columns_.size() && i < record.values.size(); i++) {
+            if (!std::isnan(record.values[i])) {
+                text << "," << FormatJsonString(columns_[i]) << ":" << record.values[i];
+            }
+        }
+        text << "}\n";
+        return text.str();
+    }
+    text << std::fixed << std::setprecision(3) << time << std::defaultfloat << std::setprecision(RECORD_PRECISION)
+         << "," << FormatCsvField(record.type) << "," << FormatCsvField(record.name) << ","
+         << FormatCsvField(record.labels);
+    for (size_t i = 0; i < columns_.size(); i++) {
+        text << ",";
+        if (i < record.values.size() && !std::isnan(record.values[i])) {
+            text << record.values[i];
+        }
+    }
+    text << "\n";
+    return text.str();
+}
+
+APP_ERROR MetricsRecordFile::Write(const std::vector<MetricsRecord> &records)
+{
+    double time = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::ofstream file(fileName_, isStarted_ ? std::ios::app : std::ios::trunc);
+    if (!file.is_open()) {
+        LogError << "MetricsRecordFile: fail to open " << fileName_ << ".";
+        return APP_ERR_COMM_OPEN_FAIL;
+    }
+    if (!isStarted_) {
+        std::map<std::string, std::string> metadata;
+        {
+            std::lock_guard<std::mutex> metadataLock(g_runMetadataMutex);
+            metadata = g_runMetadata;
+        }
+        if (isJson_) {
+            file << "{\"type\":\"run\"";
+            for (auto &item : metadata) {
+                file << "," << FormatJsonString(item.first) << ":" << FormatJsonString(item.second);
+            }
+            file << "}\n";
+        } else {
+            for (auto &item : metadata) {
+                file << "# " << item.first << "=" << item.second << "\n";
+            }
+            file << "time,type,name,labels";
+            for (auto &column : columns_) {
+                file << "," << FormatCsvField(column);
+            }
+            file << "\n";
+        }
+        isStarted_ = true;
+    }
+    for (auto &record : records) {
+        file << FormatRecord(record, time);
+    }
+    if (!file.good()) {
+        LogError << "MetricsRecordFile: fail to write " << fileName_ << ".";
+        return APP_ERR_COMM_WRITE_FAIL;
+    }
+    return APP_ERR_OK;
+}
+
+MetricsRegistry::~MetricsRegistry()
+{
+    StopExport();
+}
+
+std::shared_ptr<MetricsRegistry> MetricsRegistry::GetInstance()
+{
+    static std::shared_ptr<MetricsRegistry> instance(new MetricsRegistry());
+    return instance;
+}
+
+std::shared_ptr<void> MetricsRegistry::GetMetric(const std::string &name, const std::string &help,
+    const MetricLabels &labels, MetricType type)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto iter = families_.find(name);
+    if (iter == families_.end()) {
+        MetricFamily family = { type, help, {} };
+        iter = families_.insert(std::make_pair(name, family)).first;
+    } else if (iter->second.type != type) {
+        LogError << "MetricsRegistry: " << name << " is already registered with another type.";
+        return nullptr;
+    }
+    std::shared_ptr<void> &metric = iter->second.metrics[FormatLabels(labels)];
+    if (metric == nullptr) {
+        if (type == METRIC_COUNTER) {
+            metric = std::make_shared<MetricCounter>();
+        } else if (type == METRIC_GAUGE) {
+            metric = std::make_shared<MetricGauge>();
+        } else {
+            metric = std::make_shared<MetricHistogram>();
+        }
+    }
+    return metric;
+}
+
+std::shared_ptr<MetricCounter> MetricsRegistry::GetCounter(const std::string &name, const std::string &help,
+    const MetricLabels &labels)
+{
+    return std::static_pointer_cast<MetricCounter>(GetMetric(name, help, labels, METRIC_COUNTER));
+}
+
+std::shared_ptr<MetricGauge> MetricsRegistry::GetGauge(const std::string &name, const std::string &help,
+    const MetricLabels &labels)
+{
+    return std::static_pointer_cast<MetricGauge>(GetMetric(name, help, labels, METRIC_GAUGE));
+}
+
+std::shared_ptr<MetricHistogram> MetricsRegistry::GetHistogram(const std::string &name, const std::string &help,
+    const MetricLabels &labels)
+{
+    return std::static_pointer_cast<MetricHistogram>(GetMetric(name, help, labels, METRIC_HISTOGRAM));
+}
+
+std::string MetricsRegistry::ExportText()
+{
+    std::ostringstream text;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &familyIter : families_) {
+        const std::string &name = familyIter.first;
+        MetricFamily &family = familyIter.second;
+        const char *typeName = (family.type == METRIC_COUNTER) ? "counter" :
+            ((family.type == METRIC_GAUGE) ? "gauge" : "summary");
+        text << "# HELP " << name << " " << family.help << "\n# TYPE " << name << " " << typeName << "\n";
+        for (auto &metricIter : family.metrics) {
+            const std::string &labels = metricIter.first;
+            if (family.type == METRIC_COUNTER) {
+                text << FormatSample(name, labels) << " " <<
+                    std::static_pointer_cast<MetricCounter>(metricIter.second)->Get() << "\n";
+                continue;
+            }
+            if (family.type == METRIC_GAUGE) {
+                text << FormatSample(name, labels) << " " <<
+                    std::static_pointer_cast<MetricGauge>(metricIter.second)->Get() << "\n";
+                continue;
+            }
+            std::shared_ptr<MetricHistogram> histogram = std::static_pointer_cast<MetricHistogram>(metricIter.second);
+            for (double quantile : EXPORT_QUANTILES) {
+                std::ostringstream quantileLabel;
+                quantileLabel << "quantile=\"" << quantile << "\"";
+                text << FormatSample(name, labels, quantileLabel.str()) << " " << histogram->GetQuantile(quantile) <<
+                    "\n";
+            }
+            text << FormatSample(name + "_sum", labels) << " " << histogram->GetSum() << "\n";
+            text << FormatSample(name + "_count", labels) << " " << histogram->GetCount() << "\n";
+        }
+    }
+    return text.str();
+}
+
+std::vector<MetricsRecord> MetricsRegistry::ExportRecords()
+{
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - exportStart_).count();
+    std::vector<MetricsRecord> records;
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto &familyIter : families_) {
+        MetricFamily &family = familyIter.second;
+        for (auto &metricIter : family.metrics) {
+            MetricsRecord record = { "metric", familyIter.first, metricIter.first,
+                std::vector<double>(RECORD_COLUMNS.size(), NAN) };
+            if (family.type == METRIC_HISTOGRAM) {
+                std::shared_ptr<MetricHistogram> histogram =
+                    std::static_pointer_cast<MetricHistogram>(metricIter.second);
+                record.values[2] = histogram->GetCount(); // count, sum, then the quantiles
+                record.values[3] = histogram->GetSum();
+                for (size_t i = 0; i < EXPORT_QUANTILES.size(); i++) {
+                    record.values[4 + i] = histogram->GetQuantile(EXPORT_QUANTILES[i]);
+                }
+            } else {
+                double value = (family.type == METRIC_COUNTER) ?
+                    std::static_pointer_cast<MetricCounter>(metricIter.second)->Get() :
+                    std::static_pointer_cast<MetricGauge>(metricIter.second)->Get();
+                record.values[0] = value;
+                if (family.type == METRIC_COUNTER && seconds > 0) {
+                    record.values[1] = value / seconds;
+                }
+            }
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+// written to a temporary file renamed over the old one, so that a scraper never reads half a file
+APP_ERROR MetricsRegistry::WriteFile(const std::string &fileName)
+{
+    std::string text = ExportText();
+    std::string tmpFileName = fileName + ".tmp";
+    FILE *file = fopen(tmpFileName.c_str(), "w");
+    if (file == nullptr) {
+        LogError << "MetricsRegistry: fail to open " << tmpFileName << ".";
+        return APP_ERR_COMM_OPEN_FAIL;
+    }
+    size_t writeSize = fwrite(text.data(), 1, text.size(), file);
+    fclose(file);
+    if (writeSize != text.size() || rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        LogError << "MetricsRegistry: fail to write " << fileName << ".";
+        return APP_ERR_COMM_WRITE_FAIL;
+    }
+    return APP_ERR_OK;
+}
+
+APP_ERROR MetricsRegistry::StartExport(const std::string &fileName, uint32_t intervalMs, uint32_t httpPort,
+    const std::string &recordFileName)
+{
+    StopExport();
+    if (httpPort != 0) {
+        int serverFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (serverFd < 0) {
+            LogError << "MetricsRegistry: fail to create the socket.";
+            return APP_ERR_COMM_FAILURE;
+        }
+        int reuse = 1;
+        setsockopt(serverFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        struct sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(httpPort);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // never exposed outside the host
+        if (bind(serverFd, reinterpret_cast<struct sockaddr *>(&address), sizeof(address)) != 0 ||
+            listen(serverFd, HTTP_BACKLOG) != 0) {
+            LogError << "MetricsRegistry: fail to listen on 127.0.0.1:" << httpPort << ".";
+            close(serverFd);
+            return APP_ERR_COMM_FAILURE;
+        }
+        isHttpStop_ = false;
+        httpThread_ = std::thread(&MetricsRegistry::HttpThread, this, serverFd);
+        LogInfo << "MetricsRegistry: serving http://127.0.0.1:" << httpPort << "/metrics.";
+    }
+    if (!fileName.empty() || !recordFileName.empty()) {
+        fileName_ = fileName;
+        recordFile_ = recordFileName.empty() ? nullptr :
+            std::make_shared<MetricsRecordFile>(recordFileName, RECORD_COLUMNS);
+        exportStart_ = std::chrono::steady_clock::now();
+        intervalMs_ = (intervalMs == 0) ? METRICS_INTERVAL_MS : intervalMs;
+        isStop_ = false;
+        exportThread_ = std::thread(&MetricsRegistry::ExportThread, this);
+    }
+    return APP_ERR_OK;
+}
+
+void MetricsRegistry::StopExport()
+{
+    if (exportThread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(stopMutex_);
+            isStop_ = true;
+        }
+        stopCond_.notify_all();
+        exportThread_.join();
+    }
+    if (httpThread_.joinable()) {
+        isHttpStop_ = true;
+        httpThread_.join();
+    }
+}
+
+void MetricsRegistry::ExportThread()
+{
+    std::unique_lock<std::mutex> lock(stopMutex_);
+    while (!isStop_) {
+        stopCond_.wait_for(lock, std::chrono::milliseconds(intervalMs_));
+        if (!fileName_.empty()) {
+            WriteFile(fileName_);
+        }
+        if (recordFile_ != nullptr) {
+            recordFile_->Write(ExportRecords());
+        }
+    }
+}
+
+// answers every request with the metrics, whatever its path
+void MetricsRegistry::HttpThread(int serverFd)
+{
+    struct pollfd pollFd = { serverFd, POLLIN, 0 };
+    while (!isHttpStop_) {
+        if (poll(&pollFd, 1, HTTP_POLL_MS) <= 0) {
+            continue;
+        }
+        int clientFd = accept(serverFd, nullptr, nullptr);
+        if (clientFd < 0) {
+            continue;
+        }
+        char request[HTTP_REQUEST_SIZE];
+        struct pollfd clientPollFd = { clientFd, POLLIN, 0 };
+        if (poll(&clientPollFd, 1, HTTP_POLL_MS) > 0) {
+            (void)recv(clientFd, request, sizeof(request), 0);
+        }
+        std::string body = ExportText();
+        std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+            std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < response.size()) {
+            ssize_t ret = send(clientFd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+            if (ret <= 0) {
+                break;
+            }
+            sent += ret;
+        }
+        close(clientFd);
+    }
+    close(serverFd);
+}
@@ -0,0 +1,197 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ErrorCode/ErrorCode.h"
+
+const uint32_t METRICS_INTERVAL_MS = 1000; // period of the metrics file when none is given
+
+using MetricLabels = std::map<std::string, std::string>;
+
+class MetricCounter {
+public:
+    void Add(uint64_t value = 1)
+    {
+        value_.fetch_add(value, std::memory_order_relaxed);
+    }
+    uint64_t Get() const
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_ = {};
+};
+
+class MetricGauge {
+public:
+    void Set(int64_t value)
+    {
+        value_.store(value, std::memory_order_relaxed);
+    }
+    void Add(int64_t value)
+    {
+        value_.fetch_add(value, std::memory_order_relaxed);
+    }
+    int64_t Get() const
+    {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int64_t> value_ = {};
+};
+
+// log-linear buckets in the way of HdrHistogram: 16 buckets per power of two, so a quantile is off by 1/16 at most,
+// Record is a few relaxed atomic adds and never allocates
+class MetricHistogram {
+public:
+    MetricHistogram();
+    void Record(uint64_t value);
+    // add the records of another histogram, to merge the histograms of several threads
+    void Add(const MetricHistogram &other);
+    // add the records of every bucket to buckets, resized to GetBucketCount, to aggregate histograms over time
+    void AddBuckets(std::vector<uint64_t> &buckets) const;
+    static uint32_t GetBucketCount();
+    // largest value recorded in the bucket
+    static uint64_t GetBucketUpperBound(uint32_t index);
+    // smallest value at or above the given fraction of the records, 0 when nothing is recorded
+    uint64_t GetQuantile(double quantile) const;
+    uint64_t GetCount() const
+    {
+        return count_.load(std::memory_order_relaxed);
+    }
+    uint64_t GetSum() const
+    {
+        return sum_.load(std::memory_order_relaxed);
+    }
+    uint64_t GetMax() const
+    {
+        return max_.load(std::memory_order_relaxed);
+    }
+
+private:
+    static uint32_t GetBucketIndex(uint64_t value);
+
+    std::vector<std::atomic<uint64_t>> buckets_;
+    std::atomic<uint64_t> count_ = {};
+    std::atomic<uint64_t> sum_ = {};
+    std::atomic<uint64_t> max_ = {};
+};
+
+// a row of measurements for the tools of a CI, statcompare matches the rows of two runs by type, name and labels
+struct MetricsRecord {
+    std::string type;
+    std::string name;
+    std::string labels;
+    std::vector<double> values; // one per column of the file, NAN when the row has no such value
+};
+
+// rows written as JSON Lines when the file name ends in .jsonl and as CSV otherwise: the first Write replaces the
+// file with the run metadata, one JSON object of type "run" or one "# key=value" line per item, and the CSV header;
+// every row then gets the unix time in seconds, then its type, name, labels and values
+class MetricsRecordFile {
+public:
+    MetricsRecordFile(const std::string &fileName, const std::vector<std::string> &columns);
+    APP_ERROR Write(const std::vector<MetricsRecord> &records);
+    // the git hash, config or channel count of the run, for the files started after the call
+    static void SetRunMetadata(const std::string &key, const std::string &value);
+
+private:
+    std::string FormatRecord(const MetricsRecord &record, double time) const;
+
+    std::mutex mutex_ = {};
+    std::string fileName_;
+    std::vector<std::string> columns_;
+    bool isJson_;
+    bool isStarted_ = false;
+};
+
+// metrics of the process, exported in the Prometheus text format to a file rewritten periodically and,
+// optionally, on http://127.0.0.1:<port>/metrics; the Get functions create the metric on first use and always
+// return the same one for the same name and labels, keep the pointer instead of calling them for every update
+class MetricsRegistry {
+public:
+    ~MetricsRegistry();
+    static std::shared_ptr<MetricsRegistry> GetInstance();
+
+    std::shared_ptr<MetricCounter> GetCounter(const std::string &name, const std::string &help,
+        const MetricLabels &labels = {});
+    std::shared_ptr<MetricGauge> GetGauge(const std::string &name, const std::string &help,
+        const MetricLabels &labels = {});
+    // exported as a summary with the quantiles 0.5, 0.9, 0.99 and 0.999
+    std::shared_ptr<MetricHistogram> GetHistogram(const std::string &name, const std::string &help,
+        const MetricLabels &labels = {});
+
+    std::string ExportText();
+    APP_ERROR WriteFile(const std::string &fileName);
+    // a row per metric: the value of a counter or gauge, the rate per second since the start of the export of a
+    // counter, the count, sum and quantiles of a histogram
+    std::vector<MetricsRecord> ExportRecords();
+    // fileName, recordFileName empty or httpPort 0 turns the matching export off; every intervalMs the file is
+    // rewritten and the rows of ExportRecords are appended to the record file, see MetricsRecordFile
+    APP_ERROR StartExport(const std::string &fileName, uint32_t intervalMs = METRICS_INTERVAL_MS,
+        uint32_t httpPort = 0, const std::string &recordFileName = "");
+    // the files are written a last time
+    void StopExport();
+
+protected:
+    MetricsRegistry() {};
+
+private:
+    enum MetricType {
+        METRIC_COUNTER = 0,
+        METRIC_GAUGE,
+        METRIC_HISTOGRAM
+    };
+    struct MetricFamily {
+        MetricType type;
+        std::string help;
+        std::map<std::string, std::shared_ptr<void>> metrics; // formatted labels to the metric
+    };
+
+    std::shared_ptr<void> GetMetric(const std::string &name, const std::string &help, const MetricLabels &labels,
+        MetricType type);
+    void ExportThread();
+    void HttpThread(int serverFd);
+
+    std::mutex mutex_ = {};
+    std::map<std::string, MetricFamily> families_ = {};
+    std::string fileName_ = "";
+    std::shared_ptr<MetricsRecordFile> recordFile_ = nullptr;
+    std::chrono::steady_clock::time_point exportStart_ = {};
+    uint32_t intervalMs_ = METRICS_INTERVAL_MS;
+    bool isStop_ = false;
+    std::mutex stopMutex_ = {};
+    std::condition_variable stopCond_ = {};
+    std::thread exportThread_ = {};
+    std::thread httpThread_ = {};
+    std::atomic_bool isHttpStop_ = {};
+};
+
+#endif
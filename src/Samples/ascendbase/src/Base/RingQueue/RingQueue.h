@@ -0,0 +1,397 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <stdint.h>
+#include "BlockingQueue/BlockingQueue.h"
+#include "BlockingQueue/QueueBase.h"
+
+static const int CACHE_LINE_SIZE = 64;
+// with a single cell the sequence number of a free cell and of a full one are the same
+static const uint32_t MPMC_MIN_CAPACITY = 2;
+
+enum RingQueueMode {
+    RING_QUEUE_SPSC = 0, // one producer thread and one consumer thread
+    RING_QUEUE_MPMC      // any number of producer and consumer threads
+};
+
+// Parking place for the threads that find the ring empty (or full). The lock-free fast path only reads
+// waiters_ after publishing an item, so the mutex is touched only when somebody is really sleeping.
+// The threads first spin as set by SetStrategy, a short pause spin then some yields by default.
+class RingWaiter {
+public:
+    RingWaiter() : waiters_(0), spinner_(QUEUE_WAIT_SPIN_YIELD, 0) {}
+
+    void SetStrategy(QueueWaitStrategy strategy, uint32_t spinUs)
+    {
+        spinner_.SetStrategy(strategy, spinUs);
+    }
+
+    // return false if the deadline is reached before ready() becomes true
+    template<typename Pred> bool Wait(Pred ready, const std::chrono::steady_clock::time_point *deadline)
+    {
+        if (deadline != nullptr && std::chrono::steady_clock::now() >= *deadline) {
+            return ready();
+        }
+        if (spinner_.Spin(ready)) {
+            return true;
+        }
+
+        bool isReady = true;
+        waiters_.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            while (!ready()) {
+                if (deadline == nullptr) {
+                    cond_.wait(lock);
+                } else if (cond_.wait_until(lock, *deadline) == std::cv_status::timeout) {
+                    isReady = ready();
+                    break;
+                }
+            }
+        }
+        waiters_.fetch_sub(1);
+        return isReady;
+    }
+
+    void Notify(bool isAll = false)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        if (isAll) {
+            cond_.notify_all();
+        } else {
+            cond_.notify_one();
+        }
+    }
+
+    void NotifyAll()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+        }
+        cond_.notify_all();
+    }
+
+private:
+    std::atomic<int> waiters_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    QueueSpinner spinner_;
+};
+
+// Preallocated bounded ring used as a drop-in replacement of BlockingQueue between modules.
+// Push and Pop are lock-free while the ring is neither empty nor full; a thread only parks when it has to wait.
+// The MPMC variant is the bounded queue of D. Vyukov (one sequence number per cell), the SPSC variant only
+// keeps a head and a tail index and caches the index of the other side to avoid cache line ping-pong.
+template<typename T, RingQueueMode MODE = RING_QUEUE_MPMC> class RingQueue : public QueueBase<T> {
+public:
+    RingQueue(uint32_t maxSize = DEFAULT_MAX_QUEUE_SIZE)
+        : enqueuePos_(0), headCache_(0), dequeuePos_(0), tailCache_(0),
+          capacity_(std::max(maxSize, MODE == RING_QUEUE_MPMC ? MPMC_MIN_CAPACITY : 1u)), cells_(new Cell[capacity_]),
+          is_stoped_(false)
+    {
+        for (uint64_t i = 0; i < capacity_; i++) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~RingQueue() {}
+
+    APP_ERROR Pop(T &item)
+    {
+        return PopUntil(item, nullptr);
+    }
+
+    APP_ERROR Pop(T &item, unsigned int timeOutMs)
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeOutMs);
+        return PopUntil(item, &deadline);
+    }
+
+    APP_ERROR Push(const T &item, bool isWait = false)
+    {
+        return PushItem(item, isWait);
+    }
+
+    APP_ERROR Push(T &&item, bool isWait = false)
+    {
+        return PushItem(std::move(item), isWait);
+    }
+
+    // the cells are constructed once, so the item is built from args then moved into its cell
+    template<typename... Args> APP_ERROR Emplace(bool isWait, Args &&...args)
+    {
+        return PushItem(T(std::forward<Args>(args)...), isWait);
+    }
+
+    APP_ERROR PopBatch(std::vector<T> &items, uint32_t maxCount, unsigned int timeOutMs)
+    {
+        items.clear();
+        T item;
+        APP_ERROR ret = PopUntil(item, nullptr);
+        if (ret != APP_ERR_OK) {
+            return ret;
+        }
+        items.push_back(std::move(item));
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeOutMs);
+        while (items.size() < maxCount) {
+            if (TryPop(item)) {
+                items.push_back(std::move(item));
+                continue;
+            }
+            if (timeOutMs == 0 || is_stoped_.load(std::memory_order_acquire)) {
+                break;
+            }
+            // let the blocked senders refill the ring while the batch is not full
+            notFull_.Notify(true);
+            bool isReady = notEmpty_.Wait(
+                [this]() { return is_stoped_.load(std::memory_order_acquire) || GetSize() > 0; }, &deadline);
+            if (!isReady) {
+                break;
+            }
+        }
+        notFull_.Notify(true);
+        return APP_ERR_OK;
+    }
+
+    APP_ERROR PushBatch(const std::vector<T> &items, bool isWait = false)
+    {
+        for (auto &item : items) {
+            APP_ERROR ret = Push(item, isWait);
+            if (ret != APP_ERR_OK) {
+                return ret;
+            }
+        }
+        return APP_ERR_OK;
+    }
+
+    void Stop()
+    {
+        is_stoped_.store(true, std::memory_order_release);
+        notFull_.NotifyAll();
+        notEmpty_.NotifyAll();
+    }
+
+    void Restart()
+    {
+        is_stoped_.store(false, std::memory_order_release);
+    }
+
+    // if the queue is stoped, need call this function to take out the unprocessed items
+    std::list<T> GetRemainItems()
+    {
+        std::list<T> items;
+        if (!is_stoped_.load(std::memory_order_acquire)) {
+            return items;
+        }
+        T item;
+        while (TryPop(item)) {
+            items.push_back(std::move(item));
+        }
+        return items;
+    }
+
+    APP_ERROR IsFull()
+    {
+        return IsFullFast();
+    }
+
+    int GetSize()
+    {
+        uint64_t head = dequeuePos_.load(std::memory_order_acquire);
+        uint64_t tail = enqueuePos_.load(std::memory_order_acquire);
+        return (tail > head) ? static_cast<int>(tail - head) : 0;
+    }
+
+    // the consumers only, the producers waiting for room keep the default
+    void SetWaitStrategy(QueueWaitStrategy strategy, uint32_t spinUs = QUEUE_SPIN_US)
+    {
+        notEmpty_.SetStrategy(strategy, spinUs);
+    }
+
+    APP_ERROR IsEmpty()
+    {
+        return GetSize() == 0;
+    }
+
+    void Clear()
+    {
+        T item;
+        while (TryPop(item)) {
+        }
+        notFull_.NotifyAll();
+    }
+
+private:
+    struct Cell {
+        std::atomic<uint64_t> sequence;
+        T data;
+    };
+
+    APP_ERROR PopUntil(T &item, const std::chrono::steady_clock::time_point *deadline)
+    {
+        while (true) {
+            if (is_stoped_.load(std::memory_order_acquire)) {
+                return APP_ERR_QUEUE_STOPED;
+            }
+            if (TryPop(item)) {
+                notFull_.Notify();
+                return APP_ERR_OK;
+            }
+            bool isReady = notEmpty_.Wait(
+                [this]() { return is_stoped_.load(std::memory_order_acquire) || GetSize() > 0; }, deadline);
+            if (!isReady) {
+                return APP_ERR_QUEUE_EMPTY;
+            }
+        }
+    }
+
+    template<typename U> APP_ERROR PushItem(U &&item, bool isWait)
+    {
+        while (true) {
+            if (is_stoped_.load(std::memory_order_acquire)) {
+                return APP_ERR_QUEUE_STOPED;
+            }
+            // TryPush only forwards the item once a cell is claimed
+            if (TryPush(std::forward<U>(item))) {
+                notEmpty_.Notify();
+                return APP_ERR_OK;
+            }
+            if (!isWait) {
+                return APP_ERROR_QUEUE_FULL;
+            }
+            notFull_.Wait([this]() { return is_stoped_.load(std::memory_order_acquire) || !IsFullFast(); }, nullptr);
+        }
+    }
+
+    bool IsFullFast()
+    {
+        uint64_t head = dequeuePos_.load(std::memory_order_acquire);
+        uint64_t tail = enqueuePos_.load(std::memory_order_acquire);
+        return tail - head >= capacity_;
+    }
+
+    template<typename U> bool TryPush(U &&item)
+    {
+        if (MODE == RING_QUEUE_SPSC) {
+            uint64_t tail = enqueuePos_.load(std::memory_order_relaxed);
+            if (tail - headCache_ >= capacity_) {
+                headCache_ = dequeuePos_.load(std::memory_order_acquire);
+                if (tail - headCache_ >= capacity_) {
+                    return false;
+                }
+            }
+            cells_[tail % capacity_].data = std::forward<U>(item);
+            enqueuePos_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        Cell *cell = nullptr;
+        uint64_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos % capacity_];
+            uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+            if (diff == 0) {
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::forward<U>(item);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T &item)
+    {
+        if (MODE == RING_QUEUE_SPSC) {
+            uint64_t head = dequeuePos_.load(std::memory_order_relaxed);
+            if (head >= tailCache_) {
+                tailCache_ = enqueuePos_.load(std::memory_order_acquire);
+                if (head >= tailCache_) {
+                    return false;
+                }
+            }
+            Cell &cell = cells_[head % capacity_];
+            item = std::move(cell.data);
+            cell.data = T();
+            dequeuePos_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        Cell *cell = nullptr;
+        uint64_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos % capacity_];
+            uint64_t seq = cell->sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        item = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(pos + capacity_, std::memory_order_release);
+        return true;
+    }
+
+private:
+    // producer and consumer indexes live on their own cache lines
+    char padding0_[CACHE_LINE_SIZE];
+    std::atomic<uint64_t> enqueuePos_;
+    uint64_t headCache_; // SPSC only, producer side copy of dequeuePos_
+    char padding1_[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)];
+    std::atomic<uint64_t> dequeuePos_;
+    uint64_t tailCache_; // SPSC only, consumer side copy of enqueuePos_
+    char padding2_[CACHE_LINE_SIZE - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)];
+
+    const uint64_t capacity_;
+    std::unique_ptr<Cell[]> cells_;
+    std::atomic<bool> is_stoped_;
+    RingWaiter notEmpty_;
+    RingWaiter notFull_;
+};
+#endif
@@ -19,232 +19,765 @@
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#include <map>
+#include <random>
+#include <thread>
 #include <FileManager/FileManager.h>
 
 #include "Statistic.h"
 #include "Log/Log.h"
 
-bool Statistic::statisticEnable = false;
-std::mutex Statistic::mutex_;
-uint32_t Statistic::globalTimeCount = 0;
-bool Statistic::globalTimeIsOver = false;
-bool Statistic::globalTimeIsInit = false;
-timeval Statistic::globalTimeStart = { 0, 0 };
-timeval Statistic::globalTimeStop = { 0, 0 };
-std::string Statistic::globalTimeModeName;
-std::string Statistic::globalTimeFileToSave = DEFAUTL_SAVE_FILE;
+std::atomic<bool> Statistic::statisticEnable(false);
+ThreadPolicy Statistic::threadPolicy_;
+std::atomic<bool> ProbeClock::isCalibrated_(false);
+bool ProbeClock::isTsc_ = false;
+double ProbeClock::nsPerTick_ = 1.0;
 
-
-const int SPLIT_LENGTH = 120;
 const int INTERVAL_LENGTH_NAME = 40;
-const int INTERVAL_LENGTH_DEFAULT = 15;
-const double TIME_TRANS = 1000.0;
-const int RUN_TIME_STATISTIC_PERIOD = 1000;
-const int GLOBAL_TIME_STATISTIC_PERIOD = 2000;
-const int DEFATL_RECORD_SIZE = 10000;
+const int INTERVAL_LENGTH_DEFAULT = 12;
+const int RESULT_COLUMN_COUNT = 9;
+const int SPLIT_LENGTH = INTERVAL_LENGTH_NAME + RESULT_COLUMN_COUNT * INTERVAL_LENGTH_DEFAULT;
+const double NS_PER_MS = 1000000.0;
+const double MS_PER_SECOND = 1000.0;
+const double NS_PER_SECOND = 1000000000.0;
+const int TIME_PRECISION = 4;
+const uint32_t PROBE_CALIBRATION_MS = 2; // time over which the tsc ticks are counted against steady_clock
 
-void Statistic::SetStatisticEnable(bool flag)
+namespace {
+std::mutex g_probeMutex;
+std::atomic<uint32_t> g_nextShard(0);
+std::atomic<uint32_t> g_reservoirSize(STATISTIC_RESERVOIR_SIZE);
+std::atomic<uint32_t> g_windowSec(STATISTIC_WINDOW_SEC);
+std::atomic<uint32_t> g_decaySec(STATISTIC_DECAY_SEC);
+std::mutex g_recordMutex;
+std::shared_ptr<MetricsRecordFile> g_recordFile = nullptr;
+const std::vector<std::string> RECORD_COLUMNS = { "count", "tps", "average_ms", "p50_ms", "p90_ms", "p99_ms",
+    "p999_ms", "max_ms" };
+
+// GlobalTimeStatisticStart/Stop, the wall time from the start to the last stop
+std::mutex g_globalMutex;
+std::string g_globalName = "";
+std::atomic<bool> g_globalIsInit(false);
+std::atomic<int64_t> g_globalStartNs(0);
+std::atomic<int64_t> g_globalStopNs(0);
+std::atomic<uint64_t> g_globalCount(0);
+
+int64_t GetSteadyNs()
 {
-    statisticEnable = flag;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
 }
 
-void Statistic::RunTimeStatisticStart(std::string modelName, uint32_t id, bool autoShowResult, std::string fileToSave)
+// built on first use, so that the probes may be looked up by the static objects of other files
+std::map<std::string, std::shared_ptr<StatisticProbe>> &GetProbeMap()
+{
+    static std::map<std::string, std::shared_ptr<StatisticProbe>> probes;
+    return probes;
+}
+
+// the tsc ticks at the same rate whatever the frequency and the sleep states of the cpu
+bool HasInvariantTsc()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    const unsigned int powerLeaf = 0x80000007;
+    const unsigned int invariantTscBit = 1U << 8;
+    unsigned int eax = 0;
+    unsigned int ebx = 0;
+    unsigned int ecx = 0;
+    unsigned int edx = 0;
+    return __get_cpuid(powerLeaf, &eax, &ebx, &ecx, &edx) != 0 && (edx & invariantTscBit) != 0;
+#elif defined(__aarch64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+// the shard of the calling thread, the threads are given the shards in turn
+uint32_t GetShardIndex()
+{
+    thread_local uint32_t shardIndex = g_nextShard.fetch_add(1, std::memory_order_relaxed) % STATISTIC_SHARD_COUNT;
+    return shardIndex;
+}
+
+// xorshift64* scaled to [0, bound) by a multiplication instead of a division, the reservoir of a shard draws a
+// number for every call once it is full
+uint64_t NextRandom(uint64_t bound)
+{
+    thread_local uint64_t state = static_cast<uint64_t>(GetSteadyNs()) ^
+        reinterpret_cast<uintptr_t>(&state) ^ 0x9E3779B97F4A7C15ULL;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(state * 0x2545F4914F6CDD1DULL) * bound) >> 64);
+}
+
+double ToMs(uint64_t ns)
+{
+    return ns / NS_PER_MS;
+}
+
+std::vector<std::shared_ptr<StatisticProbe>> GetAllProbes()
+{
+    std::vector<std::shared_ptr<StatisticProbe>> probes;
+    std::lock_guard<std::mutex> locker(g_probeMutex);
+    for (auto &probe : GetProbeMap()) {
+        probes.push_back(probe.second);
+    }
+    return probes;
+}
+
+// a row of the report: count is the items of the probe so far, the others cover the part of the calls given by
+// the title of the table; the average and tps are per item, the quantiles and max per call
+struct ReportRow {
+    std::string name;
+    uint64_t itemCount;
+    double tps;
+    double averageMs;
+    uint64_t p50Ns;
+    uint64_t p90Ns;
+    uint64_t p99Ns;
+    uint64_t p999Ns;
+    uint64_t maxNs;
+};
+
+std::string FormatHeader(const std::string &title)
+{
+    std::ostringstream ss;
+    ss.setf(std::ios::left);
+    ss << title << std::endl;
+    ss << std::setw(INTERVAL_LENGTH_NAME) << "model name" << std::setw(INTERVAL_LENGTH_DEFAULT) << "count"
+       << std::setw(INTERVAL_LENGTH_DEFAULT) << "tps" << std::setw(INTERVAL_LENGTH_DEFAULT) << "average(ms)"
+       << std::setw(INTERVAL_LENGTH_DEFAULT) << "p50(ms)" << std::setw(INTERVAL_LENGTH_DEFAULT) << "p90(ms)"
+       << std::setw(INTERVAL_LENGTH_DEFAULT) << "p99(ms)" << std::setw(INTERVAL_LENGTH_DEFAULT) << "p99.9(ms)"
+       << "max(ms)" << std::endl;
+    return ss.str();
+}
+
+std::string FormatRow(const ReportRow &row)
+{
+    std::ostringstream ss;
+    ss.setf(std::ios::left);
+    ss << std::fixed << std::setprecision(TIME_PRECISION);
+    ss << std::setw(INTERVAL_LENGTH_NAME) << row.name << std::setw(INTERVAL_LENGTH_DEFAULT) << row.itemCount
+       << std::setw(INTERVAL_LENGTH_DEFAULT) << row.tps << std::setw(INTERVAL_LENGTH_DEFAULT) << row.averageMs
+       << std::setw(INTERVAL_LENGTH_DEFAULT) << ToMs(row.p50Ns) << std::setw(INTERVAL_LENGTH_DEFAULT)
+       << ToMs(row.p90Ns) << std::setw(INTERVAL_LENGTH_DEFAULT) << ToMs(row.p99Ns)
+       << std::setw(INTERVAL_LENGTH_DEFAULT) << ToMs(row.p999Ns) << ToMs(row.maxNs) << std::endl;
+    return ss.str();
+}
+
+// all the calls so far, tps per second spent in the calls
+ReportRow GetTotalRow(const StatisticResult &result)
+{
+    double totalMs = ToMs(result.totalNs);
+    ReportRow row = {result.name, result.itemCount, 0, 0, result.p50Ns, result.p90Ns, result.p99Ns, result.p999Ns,
+        result.maxNs};
+    row.tps = (result.totalNs == 0) ? 0 : result.itemCount / totalMs * MS_PER_SECOND;
+    row.averageMs = (result.itemCount == 0) ? 0 : totalMs / result.itemCount;
+    return row;
+}
+
+MetricsRecord GetRecord(const std::string &type, const ReportRow &row)
+{
+    return { type, row.name, "", { static_cast<double>(row.itemCount), row.tps, row.averageMs, ToMs(row.p50Ns),
+        ToMs(row.p90Ns), ToMs(row.p99Ns), ToMs(row.p999Ns), ToMs(row.maxNs) } };
+}
+
+void WriteRecords(const std::vector<MetricsRecord> &records)
+{
+    std::shared_ptr<MetricsRecordFile> recordFile;
+    {
+        std::lock_guard<std::mutex> locker(g_recordMutex);
+        recordFile = g_recordFile;
+    }
+    if (recordFile != nullptr && !records.empty()) {
+        recordFile->Write(records);
+    }
+}
+
+// the global time row, its time is the wall time from GlobalTimeStatisticStart to the last stop
+std::string FormatGlobalResult()
+{
+    std::string name;
+    {
+        std::lock_guard<std::mutex> locker(g_globalMutex);
+        name = g_globalName;
+    }
+    uint64_t count = g_globalCount.load();
+    double totalMs = ToMs(std::max<int64_t>(g_globalStopNs.load() - g_globalStartNs.load(), 0));
+    std::ostringstream ss;
+    ss.setf(std::ios::left);
+    ss << std::fixed << std::setprecision(TIME_PRECISION);
+    ss << std::setw(INTERVAL_LENGTH_NAME) << "global time" << std::setw(INTERVAL_LENGTH_DEFAULT) << "count"
+       << std::setw(INTERVAL_LENGTH_DEFAULT) << "time(ms)" << std::setw(INTERVAL_LENGTH_DEFAULT) << "average(ms)"
+       << "tps" << std::endl;
+    ss << std::setw(INTERVAL_LENGTH_NAME) << name << std::setw(INTERVAL_LENGTH_DEFAULT) << count
+       << std::setw(INTERVAL_LENGTH_DEFAULT) << totalMs << std::setw(INTERVAL_LENGTH_DEFAULT)
+       << ((count == 0) ? 0 : totalMs / count) << ((totalMs == 0) ? 0 : count / totalMs * MS_PER_SECOND)
+       << std::endl;
+    return ss.str();
+}
+
+void WriteReport(const std::string &report, const std::string &fileToSave)
 {
-    if (Statistic::statisticEnable) {
-        if (!runTimeIsInit_) {
-            runTimeModelName_ = modelName;
-            runTimeId_ = id;
-            runTimeTotal_ = 0.0;
-            runTimeCount_ = 0;
-            runTimeIsOver_ = false;
-            if (!fileToSave.empty()) {
-                runTimeFileToSave_ = fileToSave;
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> locker(mutex);
+    std::cout << report;
+    CreateDirRecursively(fileToSave.substr(0, fileToSave.rfind('/')));
+    SaveFileAppend(fileToSave, report.c_str(), report.length());
+}
+
+// the calls of a probe between two reports
+struct WindowSlot {
+    uint64_t callCount;
+    uint64_t itemCount;
+    uint64_t totalNs;
+    uint64_t maxNs;
+    double seconds;
+};
+
+// what the reporter keeps of a probe, its size does not depend on the number of calls: the histogram of the last
+// report to subtract from the next one, the calls of the reports in the window and the decayed histogram
+class ProbeWindow {
+public:
+    ProbeWindow(uint32_t slotCount, double decaySec) : slots_(slotCount), decaySec_(decaySec) {}
+
+    // add the calls since the last update, false when there were none
+    bool Update(const StatisticResult &result, const std::vector<uint64_t> &buckets, double seconds)
+    {
+        buckets_.resize(buckets.size());
+        decayedBuckets_.resize(buckets.size());
+        double decay = (decaySec_ <= 0) ? 0 : exp(-seconds / decaySec_);
+        WindowSlot slot = {0, result.itemCount - itemCount_, result.totalNs - totalNs_, 0, seconds};
+        for (size_t i = 0; i < buckets.size(); i++) {
+            uint64_t callCount = buckets[i] - buckets_[i];
+            decayedBuckets_[i] = decayedBuckets_[i] * decay + callCount;
+            if (callCount != 0) {
+                slot.callCount += callCount;
+                slot.maxNs = std::min(MetricHistogram::GetBucketUpperBound(i), result.maxNs);
+            }
+        }
+        buckets_ = buckets;
+        itemCount_ = result.itemCount;
+        totalNs_ = result.totalNs;
+        slots_[slotIndex_] = slot;
+        slotIndex_ = (slotIndex_ + 1) % slots_.size();
+        return slot.callCount != 0;
+    }
+
+    // a new period of the reports changes the number of them in the window, which restarts
+    void SetSlotCount(uint32_t slotCount)
+    {
+        if (slotCount != slots_.size()) {
+            slots_.assign(slotCount, WindowSlot());
+            slotIndex_ = 0;
+        }
+    }
+
+    // tps per second of wall time over the window, max within 1/16 as the quantiles
+    ReportRow GetRow(const StatisticResult &result) const
+    {
+        WindowSlot window = {0, 0, 0, 0, 0};
+        for (auto &slot : slots_) {
+            window.callCount += slot.callCount;
+            window.itemCount += slot.itemCount;
+            window.totalNs += slot.totalNs;
+            window.maxNs = std::max(window.maxNs, slot.maxNs);
+            window.seconds += slot.seconds;
+        }
+        ReportRow row = {result.name, result.itemCount, 0, 0, GetDecayedQuantile(0.5, result.maxNs),
+            GetDecayedQuantile(0.9, result.maxNs), GetDecayedQuantile(0.99, result.maxNs),
+            GetDecayedQuantile(0.999, result.maxNs), window.maxNs};
+        row.tps = (window.seconds <= 0) ? 0 : window.itemCount / window.seconds;
+        row.averageMs = (window.itemCount == 0) ? 0 : ToMs(window.totalNs) / window.itemCount;
+        return row;
+    }
+
+private:
+    uint64_t GetDecayedQuantile(double quantile, uint64_t maxNs) const
+    {
+        double count = 0;
+        for (double bucketCount : decayedBuckets_) {
+            count += bucketCount;
+        }
+        if (count <= 0) {
+            return 0;
+        }
+        double rank = quantile * count;
+        double seen = 0;
+        size_t index = 0;
+        for (size_t i = 0; i < decayedBuckets_.size(); i++) {
+            if (decayedBuckets_[i] <= 0) {
+                continue;
             }
-            if (autoShowResult) {
-                std::thread t(Statistic::ShowRunTimeStatistic, this);
-                t.detach();
+            seen += decayedBuckets_[i];
+            index = i;
+            if (seen >= rank) {
+                break;
             }
-            runTimeIsInit_ = true;
-            runTimeRecord_.clear();
-            runTimeRecord_.reserve(DEFATL_RECORD_SIZE);
         }
-        gettimeofday(&runTimeStart_, nullptr);
+        return std::min(MetricHistogram::GetBucketUpperBound(index), maxNs);
     }
-}
 
-void Statistic::RunTimeStatisticStop(uint32_t dynamicRunTimeCount)
-{
-    if (Statistic::statisticEnable) {
-        gettimeofday(&runTimeStop_, nullptr);
-        double tt = (runTimeStop_.tv_sec - runTimeStart_.tv_sec) * TIME_TRANS +
-            (runTimeStop_.tv_usec - runTimeStart_.tv_usec) / TIME_TRANS;
-        runTimeRecord_.push_back(std::make_pair(tt, std::max(dynamicRunTimeCount, 1U)));
-        runTimeTotal_ += tt;
-        while (runTimeIsOver_) {
-            runTimeIsOver_ = false;
+    std::vector<uint64_t> buckets_ = {};
+    uint64_t itemCount_ = 0;
+    uint64_t totalNs_ = 0;
+    std::vector<WindowSlot> slots_;
+    size_t slotIndex_ = 0;
+    std::vector<double> decayedBuckets_ = {};
+    double decaySec_;
+};
+
+// one thread reporting the probes recorded since its last report, stopped by StopReport or at exit
+class StatisticReporter {
+public:
+    ~StatisticReporter()
+    {
+        Stop();
+    }
+
+    void Start(uint32_t periodMs, const std::string &fileToSave, const ThreadPolicy &policy)
+    {
+        std::lock_guard<std::mutex> locker(mutex_);
+        periodMs = (periodMs == 0) ? periodMs_ : std::max(periodMs, 1U);
+        if (thread_.joinable()) {
+            // the running reporter takes them from its next report
+            if (periodMs != periodMs_ || fileToSave != fileToSave_) {
+                LogInfo << "Statistic: the report is now written to " << fileToSave << " every " << periodMs << " ms.";
+                periodMs_ = periodMs;
+                fileToSave_ = fileToSave;
+            }
+            return;
+        }
+        periodMs_ = periodMs;
+        fileToSave_ = fileToSave;
+        isStop_ = false;
+        windowSec_ = g_windowSec.load();
+        decaySec_ = g_decaySec.load();
+        windows_.clear();
+        lastReportNs_ = GetSteadyNs();
+        thread_ = std::thread([this, policy]() {
+            ApplyThreadPolicy(policy, "Statistic reporter");
+            ReportThread();
+        });
+    }
+
+    void Stop()
+    {
+        std::string fileToSave;
+        {
+            std::lock_guard<std::mutex> locker(mutex_);
+            if (!thread_.joinable()) {
+                return;
+            }
+            isStop_ = true;
+            fileToSave = fileToSave_;
+        }
+        cond_.notify_all();
+        thread_.join();
+        size_t extensionPos = fileToSave.rfind('.');
+        if (extensionPos == std::string::npos || extensionPos < fileToSave.rfind('/') + 1) {
+            extensionPos = fileToSave.size();
+        }
+        Statistic::DumpSamples(fileToSave.substr(0, extensionPos) + "_samples" + fileToSave.substr(extensionPos));
+    }
+
+private:
+    void ReportThread()
+    {
+        std::unique_lock<std::mutex> locker(mutex_);
+        while (!isStop_) {
+            cond_.wait_for(locker, std::chrono::milliseconds(periodMs_));
+            bool isLast = isStop_;
+            std::string fileToSave = fileToSave_;
+            uint32_t periodMs = periodMs_;
+            locker.unlock();
+            Report(isLast, fileToSave, periodMs);
+            locker.lock();
+        }
+    }
+
+    // the probes recorded since the last report, all of them the last time
+    void Report(bool isLast, const std::string &fileToSave, uint32_t periodMs)
+    {
+        int64_t now = GetSteadyNs();
+        double seconds = (now - lastReportNs_) / NS_PER_SECOND;
+        lastReportNs_ = now;
+        uint32_t slotCount = std::max<uint32_t>(windowSec_ * MS_PER_SECOND / periodMs, 1);
+        std::string rows;
+        std::vector<MetricsRecord> records;
+        std::vector<uint64_t> buckets;
+        for (auto &probe : GetAllProbes()) {
+            StatisticResult result = probe->GetResult();
+            buckets.assign(buckets.size(), 0);
+            probe->GetBuckets(buckets);
+            auto iter = windows_.find(result.name);
+            if (iter == windows_.end()) {
+                iter = windows_.insert(std::make_pair(result.name, ProbeWindow(slotCount, decaySec_))).first;
+            }
+            iter->second.SetSlotCount(slotCount);
+            bool hasNewCall = iter->second.Update(result, buckets, seconds);
+            if (result.callCount == 0 || (!hasNewCall && !isLast)) {
+                continue;
+            }
+            ReportRow row = iter->second.GetRow(result);
+            rows += FormatRow(row);
+            records.push_back(GetRecord("statistic_window", row));
+            if (isLast) {
+                records.push_back(GetRecord("statistic_total", GetTotalRow(result)));
+            }
+        }
+        WriteRecords(records);
+        uint64_t globalCount = g_globalCount.load();
+        bool hasGlobal = g_globalIsInit && globalCount != 0 && (globalCount != reportedGlobalCount_ || isLast);
+        reportedGlobalCount_ = globalCount;
+        if (rows.empty() && !hasGlobal) {
+            return;
+        }
+        std::string split(SPLIT_LENGTH, '-');
+        std::string report = "\n" + split + "\n";
+        if (!rows.empty()) {
+            report += FormatHeader("calls of the last " + std::to_string(windowSec_) +
+                " s, quantiles decayed over " + std::to_string(decaySec_) + " s") + rows;
         }
-        runTimeCount_ += std::max(dynamicRunTimeCount, 1U);
+        if (hasGlobal) {
+            report += (rows.empty() ? "" : "\n") + FormatGlobalResult();
+        }
+        report += split + "\n\n";
+        WriteReport(report, fileToSave);
     }
+
+    std::mutex mutex_ = {};
+    std::condition_variable cond_ = {};
+    std::thread thread_ = {};
+    bool isStop_ = false;
+    uint32_t periodMs_ = STATISTIC_REPORT_PERIOD_MS;
+    std::string fileToSave_ = DEFAUTL_SAVE_FILE;
+    uint32_t windowSec_ = STATISTIC_WINDOW_SEC;
+    uint32_t decaySec_ = STATISTIC_DECAY_SEC;
+    int64_t lastReportNs_ = 0;
+    std::map<std::string, ProbeWindow> windows_ = {};
+    uint64_t reportedGlobalCount_ = 0;
+};
+
+StatisticReporter &GetReporter()
+{
+    static StatisticReporter reporter;
+    return reporter;
+}
 }
 
+StatisticProbe::StatisticProbe(const std::string &name, uint32_t reservoirSize)
+    : name_(name), reservoirSize_(reservoirSize), shards_(STATISTIC_SHARD_COUNT)
+{
+    for (auto &shard : shards_) {
+        shard.samples = std::vector<std::atomic<uint64_t>>(reservoirSize_);
+    }
+}
 
-void Statistic::ShowRunTimeStatistic(Statistic *statistic)
+void StatisticProbe::Record(uint64_t durationNs, uint32_t itemCount)
 {
-    if (statistic == nullptr) {
-        LogError << "input statistic is null";
+    Shard &shard = shards_[GetShardIndex()];
+    shard.histogram.Record(durationNs);
+    shard.itemCount.fetch_add(itemCount, std::memory_order_relaxed);
+    if (reservoirSize_ == 0) {
         return;
     }
-    while (!statistic->runTimeIsOver_) {
-        statistic->runTimeIsOver_ = true;
-        std::this_thread::sleep_for(std::chrono::milliseconds(RUN_TIME_STATISTIC_PERIOD));
+    // the n-th call replaces a random sample with a probability of reservoirSize / n
+    uint64_t callIndex = shard.sampledCount.fetch_add(1, std::memory_order_relaxed);
+    uint64_t sampleIndex = (callIndex < reservoirSize_) ? callIndex : NextRandom(callIndex + 1);
+    if (sampleIndex < reservoirSize_) {
+        shard.samples[sampleIndex].store(durationNs, std::memory_order_relaxed);
     }
-    if (statistic->runTimeCount_ == 0) {
-        LogDebug << "the statistic is not start within a measurement period";
-        return;
+}
+
+void StatisticProbe::GetBuckets(std::vector<uint64_t> &buckets) const
+{
+    for (auto &shard : shards_) {
+        shard.histogram.AddBuckets(buckets);
+    }
+}
+
+// every reservoir is a uniform sample of the calls of its shard, so drawing from the shards as many samples as
+// drawing the calls at random would give keeps the merged sample uniform over all the calls
+std::vector<uint64_t> StatisticProbe::GetSamples() const
+{
+    std::mt19937_64 engine(static_cast<uint64_t>(GetSteadyNs()));
+    std::vector<uint64_t> calledCounts;
+    uint64_t totalCount = 0;
+    for (auto &shard : shards_) {
+        calledCounts.push_back(shard.sampledCount.load(std::memory_order_relaxed));
+        totalCount += calledCounts.back();
+    }
+    uint64_t size = std::min<uint64_t>(totalCount, reservoirSize_);
+    std::vector<uint64_t> drawnCounts(shards_.size(), 0);
+    for (uint64_t i = 0; i < size; i++) {
+        uint64_t call = std::uniform_int_distribution<uint64_t>(0, totalCount - 1)(engine);
+        size_t index = 0;
+        while (call >= calledCounts[index]) {
+            call -= calledCounts[index];
+            index++;
+        }
+        calledCounts[index]--;
+        totalCount--;
+        drawnCounts[index]++;
     }
-    statistic->ShowStatisticResult();
-    statistic->ShowStatisticRecord();
-    while (statistic->runTimeIsInit_) {
-            statistic->runTimeIsInit_ = false;
+    std::vector<uint64_t> samples;
+    for (size_t i = 0; i < shards_.size(); i++) {
+        uint64_t sampleCount = std::min<uint64_t>(shards_[i].sampledCount.load(std::memory_order_relaxed),
+            reservoirSize_);
+        std::vector<uint64_t> shardSamples;
+        for (uint64_t j = 0; j < sampleCount; j++) {
+            shardSamples.push_back(shards_[i].samples[j].load(std::memory_order_relaxed));
         }
-    while (statistic->runTimeIsOver_) {
-        statistic->runTimeIsOver_ = false;
+        std::shuffle(shardSamples.begin(), shardSamples.end(), engine);
+        shardSamples.resize(std::min<uint64_t>(drawnCounts[i], shardSamples.size()));
+        samples.insert(samples.end(), shardSamples.begin(), shardSamples.end());
     }
+    return samples;
 }
 
+StatisticResult StatisticProbe::GetResult() const
+{
+    MetricHistogram histogram;
+    uint64_t itemCount = 0;
+    for (auto &shard : shards_) {
+        histogram.Add(shard.histogram);
+        itemCount += shard.itemCount.load(std::memory_order_relaxed);
+    }
+    StatisticResult result = {};
+    result.name = name_;
+    result.callCount = histogram.GetCount();
+    result.itemCount = itemCount;
+    result.totalNs = histogram.GetSum();
+    result.maxNs = histogram.GetMax();
+    result.p50Ns = histogram.GetQuantile(0.5);
+    result.p90Ns = histogram.GetQuantile(0.9);
+    result.p99Ns = histogram.GetQuantile(0.99);
+    result.p999Ns = histogram.GetQuantile(0.999);
+    return result;
+}
 
-void Statistic::ShowStatisticResult()
+bool ProbeClock::Calibrate()
 {
-    std::string split(SPLIT_LENGTH, '-');
-    std::ostringstream ss;
-    ss << std::endl << split << std::endl;
-    ss.setf(std::ios::left);
-    ss << std::setw(INTERVAL_LENGTH_NAME) << "model name" << std::setw(INTERVAL_LENGTH_DEFAULT) << "id"
-       << std::setw(INTERVAL_LENGTH_DEFAULT) << "time(ms)" << std::setw(INTERVAL_LENGTH_DEFAULT) << "count"
-       << std::setw(INTERVAL_LENGTH_DEFAULT) << "average(ms)"
-       << "tps" << std::endl;
-    ss << std::setw(INTERVAL_LENGTH_NAME) << runTimeModelName_ << std::setw(INTERVAL_LENGTH_DEFAULT) << runTimeId_
-       << std::setw(INTERVAL_LENGTH_DEFAULT) << runTimeTotal_ << std::setw(INTERVAL_LENGTH_DEFAULT) << runTimeCount_
-       << std::setw(INTERVAL_LENGTH_DEFAULT) << (runTimeTotal_ / runTimeCount_) << std::setw(INTERVAL_LENGTH_DEFAULT)
-       << (runTimeCount_ / runTimeTotal_ * TIME_TRANS) << std::endl;
-    ss.setf(std::ios::right);
-    ss << split << std::endl << std::endl;
+    static std::once_flag calibrateFlag;
+    std::call_once(calibrateFlag, []() {
+        isTsc_ = MeasureTsc();
+        isCalibrated_.store(true, std::memory_order_release);
+    });
+    return isTsc_;
+}
 
-    std::lock_guard<std::mutex> locker(mutex_);
-    std::cout << ss.str();
-    CreateDirRecursively(runTimeFileToSave_.substr(0, runTimeFileToSave_.rfind('/')));
-    SaveFileAppend(runTimeFileToSave_, ss.str().c_str(), ss.str().length());
+bool ProbeClock::MeasureTsc()
+{
+    if (!HasInvariantTsc()) {
+        return false;
+    }
+#if defined(__aarch64__)
+    uint64_t frequency = 0;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(frequency));
+    if (frequency == 0) {
+        return false;
+    }
+    nsPerTick_ = NS_PER_SECOND / frequency;
+#else
+    int64_t startNs = GetSteadyNs();
+    uint64_t startTicks = AtlasAscendLog::ReadTsc();
+    std::this_thread::sleep_for(std::chrono::milliseconds(PROBE_CALIBRATION_MS));
+    int64_t endNs = GetSteadyNs();
+    uint64_t endTicks = AtlasAscendLog::ReadTsc();
+    if (endTicks <= startTicks) {
+        return false;
+    }
+    nsPerTick_ = static_cast<double>(endNs - startNs) / (endTicks - startTicks);
+#endif
+    return true;
 }
 
-void Statistic::ShowStatisticRecord()
+void Statistic::SetStatisticEnable(bool flag)
 {
-    std::string split(SPLIT_LENGTH, '-');
-    std::ostringstream ss;
+    if (flag) {
+        // the probes then do not wait for the calibration
+        ProbeClock::Calibrate();
+    }
+    statisticEnable = flag;
+}
 
-    ss << std::endl << split << std::endl;
-    ss.setf(std::ios::left);
-    ss << std::setw(INTERVAL_LENGTH_NAME) << "model name" << std::setw(INTERVAL_LENGTH_DEFAULT) << "No."
-       << std::setw(INTERVAL_LENGTH_DEFAULT) << "id" << std::setw(INTERVAL_LENGTH_DEFAULT) << "time(ms)"
-       << std::setw(INTERVAL_LENGTH_DEFAULT) << "count" << std::endl;
-    for (size_t i = 0; i < runTimeRecord_.size(); ++i) {
-        ss << std::setw(INTERVAL_LENGTH_NAME) << runTimeModelName_ << std::setw(INTERVAL_LENGTH_DEFAULT)
-           << ("No." + std::to_string(i)) << std::setw(INTERVAL_LENGTH_DEFAULT) << runTimeId_
-           << std::setw(INTERVAL_LENGTH_DEFAULT) << runTimeRecord_[i].first << std::setw(INTERVAL_LENGTH_DEFAULT)
-           << runTimeRecord_[i].second << std::endl;
+void Statistic::SetThreadPolicy(const ThreadPolicy &policy)
+{
+    threadPolicy_ = policy;
+}
+
+std::shared_ptr<StatisticProbe> Statistic::GetProbe(const std::string &name)
+{
+    std::lock_guard<std::mutex> locker(g_probeMutex);
+    std::shared_ptr<StatisticProbe> &probe = GetProbeMap()[name];
+    if (probe == nullptr) {
+        probe = std::make_shared<StatisticProbe>(name, g_reservoirSize.load());
+    }
+    return probe;
+}
+
+std::vector<StatisticResult> Statistic::GetResults()
+{
+    std::vector<StatisticResult> results;
+    for (auto &probe : GetAllProbes()) {
+        results.push_back(probe->GetResult());
     }
-    ss.setf(std::ios::right);
-    ss << split << std::endl << std::endl;
-    SaveFileAppend(runTimeFileToSave_, ss.str().c_str(), ss.str().length());
+    return results;
 }
 
+void Statistic::SetReservoirSize(uint32_t size)
+{
+    g_reservoirSize = size;
+}
 
-void Statistic::GlobalTimeStatisticStart(std::string modelName, bool autoShowResult, std::string fileToSave)
+void Statistic::SetWindow(uint32_t windowSec, uint32_t decaySec)
 {
-    if (Statistic::statisticEnable && !Statistic::globalTimeIsInit) {
-        globalTimeIsOver = false;
-        globalTimeCount = 0;
-        Statistic::globalTimeModeName = modelName;
-        Statistic::globalTimeFileToSave = fileToSave;
-        if (autoShowResult) {
-            std::thread t(Statistic::ShowGlobalTimeStatistic);
-            t.detach();
+    g_windowSec = windowSec;
+    g_decaySec = decaySec;
+}
+
+APP_ERROR Statistic::DumpSamples(const std::string &fileToSave)
+{
+    std::ostringstream ss;
+    ss.setf(std::ios::left);
+    ss << std::fixed << std::setprecision(TIME_PRECISION);
+    ss << std::setw(INTERVAL_LENGTH_NAME) << "model name" << std::setw(INTERVAL_LENGTH_DEFAULT) << "No."
+       << "time(ms)" << std::endl;
+    bool hasSample = false;
+    for (auto &probe : GetAllProbes()) {
+        std::vector<uint64_t> samples = probe->GetSamples();
+        for (size_t i = 0; i < samples.size(); i++) {
+            ss << std::setw(INTERVAL_LENGTH_NAME) << probe->GetName() << std::setw(INTERVAL_LENGTH_DEFAULT)
+               << ("No." + std::to_string(i)) << ToMs(samples[i]) << std::endl;
+            hasSample = true;
         }
-        Statistic::globalTimeIsInit = true;
-        gettimeofday(&Statistic::globalTimeStart, nullptr);
     }
+    if (!hasSample) {
+        return APP_ERR_OK;
+    }
+    CreateDirRecursively(fileToSave.substr(0, fileToSave.rfind('/')));
+    std::ofstream file(fileToSave, std::ios::trunc);
+    if (!file.is_open()) {
+        LogError << "Statistic: fail to open " << fileToSave << ".";
+        return APP_ERR_COMM_OPEN_FAIL;
+    }
+    file << ss.str();
+    if (!file.good()) {
+        LogError << "Statistic: fail to write " << fileToSave << ".";
+        return APP_ERR_COMM_WRITE_FAIL;
+    }
+    return APP_ERR_OK;
 }
 
-void Statistic::GlobalTimeStatisticStop()
+void Statistic::SetRecordFile(const std::string &fileName)
 {
-    gettimeofday(&Statistic::globalTimeStop, nullptr);
-    while (globalTimeIsOver) {
-        globalTimeIsOver = false;
-    }
-    ++Statistic::globalTimeCount;
+    std::lock_guard<std::mutex> locker(g_recordMutex);
+    g_recordFile = fileName.empty() ? nullptr : std::make_shared<MetricsRecordFile>(fileName, RECORD_COLUMNS);
+}
+
+void Statistic::StartReport(uint32_t periodMs, const std::string &fileToSave)
+{
+    GetReporter().Start(periodMs, fileToSave, threadPolicy_);
 }
 
+void Statistic::StopReport()
+{
+    GetReporter().Stop();
+}
 
-void Statistic::ShowGlobalTimeStatistic()
+void Statistic::RunTimeStatisticStart(std::string modelName, uint32_t id, bool autoShowResult, std::string fileToSave)
 {
-    while (!Statistic::globalTimeIsOver) {
-        Statistic::globalTimeIsOver = true;
-        std::this_thread::sleep_for(std::chrono::milliseconds(GLOBAL_TIME_STATISTIC_PERIOD));
+    if (!Statistic::statisticEnable) {
+        return;
     }
-    if (Statistic::globalTimeCount == 0) {
-        LogDebug << "the statistic is not start within a measurement period";
-        while (Statistic::globalTimeIsInit) {
-            Statistic::globalTimeIsInit = false;
+    if (runTimeProbe_ == nullptr || runTimeProbe_->GetName() != modelName) {
+        runTimeProbe_ = GetProbe(modelName);
+        if (!fileToSave.empty()) {
+            runTimeFileToSave_ = fileToSave;
         }
+    }
+    if (autoShowResult) {
+        StartReport(0, runTimeFileToSave_);
+    }
+    runTimeStartTicks_ = ProbeClock::Now();
+}
+
+void Statistic::RunTimeStatisticStop(uint32_t dynamicRunTimeCount)
+{
+    if (!Statistic::statisticEnable || runTimeProbe_ == nullptr) {
         return;
     }
-    double tt = (Statistic::globalTimeStop.tv_sec - Statistic::globalTimeStart.tv_sec) * TIME_TRANS +
-        (Statistic::globalTimeStop.tv_usec - Statistic::globalTimeStart.tv_usec) / TIME_TRANS;
+    runTimeProbe_->Record(ProbeClock::ToNs(ProbeClock::Now() - runTimeStartTicks_), std::max(dynamicRunTimeCount, 1U));
+}
 
+void Statistic::ShowStatisticResult()
+{
+    if (runTimeProbe_ == nullptr) {
+        return;
+    }
     std::string split(SPLIT_LENGTH, '-');
-    std::ostringstream ss;
-
-    ss << std::endl << std::endl << split << std::endl;
-    ss.setf(std::ios::left);
-    ss << std::setw(INTERVAL_LENGTH_NAME) << "model name" << std::setw(INTERVAL_LENGTH_DEFAULT) << "time(ms)"
-       << std::setw(INTERVAL_LENGTH_DEFAULT) << "count" << std::setw(INTERVAL_LENGTH_DEFAULT) << "average(ms)"
-       << "tps" << std::endl;
-    ss << std::setw(INTERVAL_LENGTH_NAME) << Statistic::globalTimeModeName << std::setw(INTERVAL_LENGTH_DEFAULT)
-       << tt << std::setw(INTERVAL_LENGTH_DEFAULT) << Statistic::globalTimeCount << std::setw(INTERVAL_LENGTH_DEFAULT)
-       << (tt / Statistic::globalTimeCount) << std::setw(INTERVAL_LENGTH_DEFAULT)
-       << (Statistic::globalTimeCount / tt * TIME_TRANS) << std::endl;
-    ss.setf(std::ios::right);
-    ss << split << std::endl << std::endl << std::endl;
+    ReportRow totalRow = GetTotalRow(runTimeProbe_->GetResult());
+    WriteRecords({ GetRecord("statistic_total", totalRow) });
+    std::string row = FormatRow(totalRow);
+    WriteReport("\n" + split + "\n" + FormatHeader("all the calls") + row + split + "\n\n", runTimeFileToSave_);
+}
 
-    std::lock_guard<std::mutex> locker(mutex_);
-    std::cout << ss.str();
-    CreateDirRecursively(
-        Statistic::globalTimeFileToSave.substr(0, Statistic::globalTimeFileToSave.rfind('/')));
-    SaveFileAppend(Statistic::globalTimeFileToSave, ss.str().c_str(), ss.str().length());
+void Statistic::GlobalTimeStatisticStart(std::string modelName, bool autoShowResult, std::string fileToSave)
+{
+    if (!Statistic::statisticEnable || g_globalIsInit.exchange(true)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> locker(g_globalMutex);
+        g_globalName = modelName;
+    }
+    g_globalCount = 0;
+    g_globalStartNs = GetSteadyNs();
+    g_globalStopNs = g_globalStartNs.load();
+    if (autoShowResult) {
+        StartReport(0, fileToSave);
+    }
+}
 
-    while (Statistic::globalTimeIsOver) {
-        Statistic::globalTimeIsOver = false;
+void Statistic::GlobalTimeStatisticStop()
+{
+    if (!g_globalIsInit) {
+        return;
     }
-    while (Statistic::globalTimeIsInit) {
-        Statistic::globalTimeIsInit = false;
+    int64_t now = GetSteadyNs();
+    int64_t stopNs = g_globalStopNs.load(std::memory_order_relaxed);
+    while (now > stopNs && !g_globalStopNs.compare_exchange_weak(stopNs, now, std::memory_order_relaxed)) {
     }
+    g_globalCount.fetch_add(1, std::memory_order_relaxed);
 }
 
 double Statistic::GetRunTimeAvg(bool avg)
 {
-    double result = runTimeTotal_ / runTimeCount_;
+    if (runTimeProbe_ == nullptr) {
+        return 0;
+    }
+    StatisticResult result = runTimeProbe_->GetResult();
+    double totalMs = ToMs(result.totalNs);
     if (!avg) {
-        result = runTimeTotal_;
+        return totalMs;
     }
-    return result;
+    return (result.itemCount == 0) ? 0 : totalMs / result.itemCount;
 }
 
 double Statistic::GetGlobalTimeAvg(bool avg)
 {
-    double globalTimeTotal = (Statistic::globalTimeStop.tv_sec - Statistic::globalTimeStart.tv_sec) * TIME_TRANS +
-        (Statistic::globalTimeStop.tv_usec - Statistic::globalTimeStart.tv_usec) / TIME_TRANS;
-    double result = globalTimeTotal / globalTimeCount;
+    double globalTimeTotal = ToMs(std::max<int64_t>(g_globalStopNs.load() - g_globalStartNs.load(), 0));
     if (!avg) {
-        result = globalTimeTotal;
+        return globalTimeTotal;
     }
-    return result;
-}
\ No newline at end of file
+    uint64_t count = g_globalCount.load();
+    return (count == 0) ? 0 : globalTimeTotal / count;
+}
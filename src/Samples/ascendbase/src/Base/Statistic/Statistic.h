@@ -17,74 +17,210 @@
 #ifndef STATISTIC_H
 #define STATISTIC_H
 
-#include <sys/time.h>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <string>
 #include <mutex>
 #include <vector>
 #include <memory>
-#include <thread>
+#include "ErrorCode/ErrorCode.h"
+#include "Log/BinaryLog.h"
+#include "Metrics/Metrics.h"
+#include "ThreadPolicy/ThreadPolicy.h"
 
 const std::string DEFAUTL_SAVE_FILE = "./logs/statistic.txt";
+const uint32_t STATISTIC_SHARD_COUNT = 16;          // threads recording the same probe are spread over the shards
+const uint32_t STATISTIC_REPORT_PERIOD_MS = 1000;   // period of the report when none is given
+const uint32_t STATISTIC_WINDOW_SEC = 60;           // the report has the calls of the last window
+const uint32_t STATISTIC_DECAY_SEC = 60;            // time constant of the decayed quantiles of the report
+const uint32_t STATISTIC_RESERVOIR_SIZE = 1024;     // durations kept as a raw sample by every shard of a probe
+const double PROBE_NS_PER_MS = 1000000.0;
+
+// a probe merged at report time, the times are in ns
+struct StatisticResult {
+    std::string name;
+    uint64_t callCount; // Record calls
+    uint64_t itemCount; // items timed by the calls, one call may time a batch
+    uint64_t totalNs;
+    uint64_t maxNs;
+    uint64_t p50Ns;
+    uint64_t p90Ns;
+    uint64_t p99Ns;
+    uint64_t p999Ns;
+};
+
+// a named timing recorded by any number of threads at once: every thread adds to one of the shards with relaxed
+// atomics, so the threads of the module instances timing the same probe do not share a cache line, and
+// GetResult merges the shards; the memory is fixed whatever the number of calls
+class StatisticProbe {
+public:
+    // every shard keeps a reservoir of reservoirSize durations, 0 keeps no raw sample
+    explicit StatisticProbe(const std::string &name, uint32_t reservoirSize = STATISTIC_RESERVOIR_SIZE);
+    void Record(uint64_t durationNs, uint32_t itemCount = 1);
+    StatisticResult GetResult() const;
+    // calls of every bucket of the durations, see MetricHistogram::AddBuckets
+    void GetBuckets(std::vector<uint64_t> &buckets) const;
+    // durations in ns of at most reservoirSize calls drawn uniformly from all the calls so far
+    std::vector<uint64_t> GetSamples() const;
+    const std::string &GetName() const
+    {
+        return name_;
+    }
+
+private:
+    struct Shard {
+        MetricHistogram histogram; // duration of every call, log-linear buckets
+        std::atomic<uint64_t> itemCount = {};
+        std::atomic<uint64_t> sampledCount = {};       // calls offered to the reservoir
+        std::vector<std::atomic<uint64_t>> samples = {}; // the reservoir, algorithm R
+        char padding[64];          // keeps the counters of two shards off the same cache line
+    };
+
+    std::string name_;
+    uint32_t reservoirSize_;
+    std::vector<Shard> shards_;
+};
+
+// RunTimeStatisticStart/Stop time the code between them into the probe of the model name, shared by all the
+// objects and threads using the name; the probes recorded since the last report are printed and appended to the
+// statistic file by a reporter thread, with the count, tps, average and max of the calls of the last window and
+// their p50/p90/p99/p99.9 latencies decayed over time, so that the statistics may stay on for days
 class Statistic {
 public:
-    Statistic()
-        : runTimeCount_(0),
-          runTimeId_(0),
-          runTimeTotal_(0.0),
-          runTimeIsOver_(false),
-          runTimeIsInit_(false),
-          runTimeStart_({ 0, 0 }),
-          runTimeStop_({ 0, 0 }),
-          runTimeModelName_(""),
-          runTimeFileToSave_("") {};
-    explicit Statistic(std::string modelName)
-        : runTimeCount_(0),
-          runTimeId_(0),
-          runTimeTotal_(0.0),
-          runTimeIsOver_(false),
-          runTimeIsInit_(false),
-          runTimeStart_({ 0, 0 }),
-          runTimeStop_({ 0, 0 }),
-          runTimeModelName_(""),
-          runTimeFileToSave_("") {};
+    Statistic() {};
+    explicit Statistic(std::string modelName) {};
     ~Statistic() {};
 
-    void RunTimeStatisticStart(std::string modelName, uint32_t id = 0, bool autoShowResult = true, std::string fileToSave = DEFAUTL_SAVE_FILE);
+    void RunTimeStatisticStart(std::string modelName, uint32_t id = 0, bool autoShowResult = true,
+        std::string fileToSave = DEFAUTL_SAVE_FILE);
+    // dynamicRunTimeCount is the number of items timed, a batch for instance
     void RunTimeStatisticStop(uint32_t dynamicRunTimeCount = 0);
+    // average time of an item of the probe in ms, or the total time when avg is false
     double GetRunTimeAvg(bool avg = true);
-    static void GlobalTimeStatisticStart(std::string modelName, bool autoShowResult = true, std::string fileToSave = DEFAUTL_SAVE_FILE);
+    static void GlobalTimeStatisticStart(std::string modelName, bool autoShowResult = true,
+        std::string fileToSave = DEFAUTL_SAVE_FILE);
     static void GlobalTimeStatisticStop();
     static double GetGlobalTimeAvg(bool avg = true);
+    // print the probe of this object and append it to its statistic file
     void ShowStatisticResult();
-    void ShowStatisticRecord();
-    static void ShowRunTimeStatistic(Statistic *statistic);
-    static void ShowGlobalTimeStatistic();
     static void SetStatisticEnable(bool flag);
+    // applied by the threads reporting the statistics, set it before the statistics start
+    static void SetThreadPolicy(const ThreadPolicy &policy);
+
+    // the probe of the name, created on first use and kept until exit, may be called before main; keep the pointer
+    // instead of calling it for every record, or use PROBE
+    static std::shared_ptr<StatisticProbe> GetProbe(const std::string &name);
+    static std::vector<StatisticResult> GetResults();
+    // size of the reservoir of the probes created after the call, 0 for none
+    static void SetReservoirSize(uint32_t size);
+    // the report covers the calls of the last windowSec seconds and decays the weight of a call for its quantiles
+    // by e every decaySec seconds (0 for the calls since the last report only), set it before the report starts
+    static void SetWindow(uint32_t windowSec, uint32_t decaySec);
+    // the raw sample of every probe, the file is replaced
+    static APP_ERROR DumpSamples(const std::string &fileToSave);
+    // the rows of the reports also written to fileName as JSON Lines or CSV with the run metadata, see
+    // MetricsRecordFile: type statistic_window for every report, statistic_total for all the calls of every probe
+    // at the last report and by ShowStatisticResult; empty turns it off
+    static void SetRecordFile(const std::string &fileName);
+    // every periodMs the probes recorded since the last report are printed and appended to fileToSave, 0 keeps the
+    // period of the last start; when already started both are taken from the next report
+    static void StartReport(uint32_t periodMs = STATISTIC_REPORT_PERIOD_MS,
+        const std::string &fileToSave = DEFAUTL_SAVE_FILE);
+    // all the probes are reported a last time and their raw samples are dumped to fileToSave with _samples
+    // appended to its name
+    static void StopReport();
 
-    static bool statisticEnable;
+    static std::atomic<bool> statisticEnable;
 
 private:
-    uint32_t runTimeCount_;
-    uint32_t runTimeId_;
-    double runTimeTotal_;
-    bool runTimeIsOver_;
-    bool runTimeIsInit_;
-    timeval runTimeStart_;
-    timeval runTimeStop_;
-    std::string runTimeModelName_;
-    std::string runTimeFileToSave_;
-    std::vector<std::pair<double, uint32_t>> runTimeRecord_ = {};
-
-    static std::mutex mutex_;
-
-    static uint32_t globalTimeCount;
-    static bool globalTimeIsOver;
-    static bool globalTimeIsInit;
-    static timeval globalTimeStart;
-    static timeval globalTimeStop;
-    static std::string globalTimeModeName;
-    static std::string globalTimeFileToSave;
+    std::shared_ptr<StatisticProbe> runTimeProbe_ = nullptr;
+    uint64_t runTimeStartTicks_ = 0; // ProbeClock
+    std::string runTimeFileToSave_ = DEFAUTL_SAVE_FILE;
+
+    static ThreadPolicy threadPolicy_;
 };
 
+// the clock of the probes: the ticks of the invariant tsc of the cpu, or of the generic timer on arm, read in a few
+// ns and never moved by ntp, turned into ns with the rate measured once by the first read or when the statistics are
+// enabled; the ns of steady_clock when the cpu has no invariant tsc
+class ProbeClock {
+public:
+    static uint64_t Now()
+    {
+        if (!isCalibrated_.load(std::memory_order_acquire)) {
+            Calibrate();
+        }
+        if (isTsc_) {
+            return AtlasAscendLog::ReadTsc();
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    static uint64_t ToNs(uint64_t ticks)
+    {
+        return static_cast<uint64_t>(ticks * nsPerTick_);
+    }
+    static double ToMs(uint64_t ticks)
+    {
+        return ticks * nsPerTick_ / PROBE_NS_PER_MS;
+    }
+    static bool IsTsc()
+    {
+        return Calibrate();
+    }
+    // switch to the tsc when it is invariant, once; the others calling it wait for the first
+    static bool Calibrate();
+
+private:
+    static bool MeasureTsc();
+
+    static std::atomic<bool> isCalibrated_;
+    static bool isTsc_;
+    static double nsPerTick_;
+};
+
+// times the scope it lives in into a probe: two ProbeClock reads and a Record when the statistics are enabled,
+// a load of Statistic::statisticEnable only otherwise
+class ScopedProbe {
+public:
+    explicit ScopedProbe(StatisticProbe &probe, uint32_t itemCount = 1)
+        : probe_(Statistic::statisticEnable.load(std::memory_order_relaxed) ? &probe : nullptr),
+          itemCount_(itemCount), startTicks_((probe_ == nullptr) ? 0 : ProbeClock::Now())
+    {}
+    ~ScopedProbe()
+    {
+        if (probe_ != nullptr) {
+            probe_->Record(ProbeClock::ToNs(ProbeClock::Now() - startTicks_), itemCount_);
+        }
+    }
+    ScopedProbe(const ScopedProbe &) = delete;
+    ScopedProbe &operator=(const ScopedProbe &) = delete;
+    // the items timed when they are known at the end of the scope only, a batch for instance
+    void SetItemCount(uint32_t itemCount)
+    {
+        itemCount_ = itemCount;
+    }
+
+private:
+    StatisticProbe *probe_;
+    uint32_t itemCount_;
+    uint64_t startTicks_;
+};
+
+#define STATISTIC_CONCAT_IMPL(left, right) left##right
+#define STATISTIC_CONCAT(left, right) STATISTIC_CONCAT_IMPL(left, right)
+
+// the probe of a constant name, looked up by the first run of the statement only and then read from a static
+#define STATISTIC_PROBE(name)                                                                               \
+    ([]() -> StatisticProbe & {                                                                             \
+        static StatisticProbe &probe = *Statistic::GetProbe(name);                                          \
+        return probe;                                                                                       \
+    }())
+
+// PROBE("name") times the rest of the scope into the probe of the name, PROBE_ITEMS for a batch of itemCount items
+#define PROBE(name) ScopedProbe STATISTIC_CONCAT(scopedProbe, __LINE__)(STATISTIC_PROBE(name))
+#define PROBE_ITEMS(name, itemCount) \
+    ScopedProbe STATISTIC_CONCAT(scopedProbe, __LINE__)(STATISTIC_PROBE(name), itemCount)
+
 #endif
@@ -0,0 +1,154 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ThreadPolicy/ThreadPolicy.h"
+#include <fstream>
+#include <sstream>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include "Log/Log.h"
+
+namespace {
+const int MAX_PRIORITY = 99;
+const size_t MAX_CPU_DIGITS = 5;
+const int MEMORY_POLICY_PREFERRED = 1; // MPOL_PREFERRED of numaif.h, which needs libnuma
+const int BITS_PER_ULONG = sizeof(unsigned long) * 8;
+const std::string NUMA_NODE_DIR = "/sys/devices/system/node/node";
+
+APP_ERROR ReadNodeCpuSet(int numaNode, std::vector<int> &cpuSet)
+{
+    std::ifstream file(NUMA_NODE_DIR + std::to_string(numaNode) + "/cpulist");
+    std::string cpuList;
+    if (!std::getline(file, cpuList)) {
+        LogError << "Fail to read the cpus of numa node " << numaNode << ".";
+        return APP_ERR_COMM_NO_EXIST;
+    }
+    return ParseCpuSet(cpuList, cpuSet);
+}
+
+// -1 if the text is not a cpu number
+int ParseCpu(std::string text)
+{
+    text.erase(0, text.find_first_not_of(" \t"));
+    text.erase(text.find_last_not_of(" \t\r\n") + 1);
+    if (text.empty() || text.find_first_not_of("0123456789") != std::string::npos || text.size() > MAX_CPU_DIGITS) {
+        return -1;
+    }
+    int cpu = std::stoi(text);
+    return (cpu < CPU_SETSIZE) ? cpu : -1;
+}
+
+APP_ERROR BindMemory(int numaNode)
+{
+    std::vector<unsigned long> nodeMask(numaNode / BITS_PER_ULONG + 1, 0);
+    nodeMask[numaNode / BITS_PER_ULONG] = 1UL << (numaNode % BITS_PER_ULONG);
+    if (syscall(SYS_set_mempolicy, MEMORY_POLICY_PREFERRED, nodeMask.data(),
+        nodeMask.size() * BITS_PER_ULONG + 1) != 0) {
+        return APP_ERR_COMM_FAILURE;
+    }
+    return APP_ERR_OK;
+}
+}
+
+APP_ERROR ParseCpuSet(const std::string &text, std::vector<int> &cpuSet)
+{
+    cpuSet.clear();
+    std::stringstream items(text);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        if (item.find_first_not_of(" \t\r\n") == std::string::npos) {
+            continue;
+        }
+        size_t dash = item.find('-');
+        int first = ParseCpu(item.substr(0, dash));
+        int last = (dash == std::string::npos) ? first : ParseCpu(item.substr(dash + 1));
+        if (first < 0 || last < first) {
+            LogError << "Invalid cpu set \"" << text << "\".";
+            return APP_ERR_COMM_INVALID_PARAM;
+        }
+        for (int cpu = first; cpu <= last; cpu++) {
+            cpuSet.push_back(cpu);
+        }
+    }
+    return APP_ERR_OK;
+}
+
+APP_ERROR LoadThreadPolicy(ConfigParser &configParser, const std::string &prefix, ThreadPolicy &policy)
+{
+    std::string cpuSet = "";
+    if (configParser.GetStringValue(prefix + ".cpuSet", cpuSet) == APP_ERR_OK) {
+        APP_ERROR ret = ParseCpuSet(cpuSet, policy.cpuSet);
+        if (ret != APP_ERR_OK) {
+            LogError << "Invalid " << prefix << ".cpuSet.";
+            return ret;
+        }
+    }
+    configParser.GetIntValue(prefix + ".numaNode", policy.numaNode);
+    configParser.GetIntValue(prefix + ".threadPriority", policy.priority);
+    if (policy.priority < 0 || policy.priority > MAX_PRIORITY) {
+        LogError << "Invalid " << prefix << ".threadPriority " << policy.priority << ", it must be in [0, " <<
+            MAX_PRIORITY << "].";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    if (policy.numaNode >= 0 && policy.cpuSet.empty()) {
+        return ReadNodeCpuSet(policy.numaNode, policy.cpuSet);
+    }
+    return APP_ERR_OK;
+}
+
+bool IsDefaultThreadPolicy(const ThreadPolicy &policy)
+{
+    return policy.cpuSet.empty() && policy.numaNode < 0 && policy.priority == 0;
+}
+
+APP_ERROR ApplyThreadPolicy(const ThreadPolicy &policy, const std::string &threadName)
+{
+    APP_ERROR result = APP_ERR_OK;
+    if (!policy.cpuSet.empty()) {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (int cpu : policy.cpuSet) {
+            CPU_SET(cpu, &cpuSet);
+        }
+        int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+        if (ret != 0) {
+            LogWarn << "Fail to set the cpu affinity of " << threadName << ", err=" << ret << ".";
+            result = APP_ERR_COMM_FAILURE;
+        }
+    }
+    if (policy.numaNode >= 0 && BindMemory(policy.numaNode) != APP_ERR_OK) {
+        LogWarn << "Fail to bind the memory of " << threadName << " to numa node " << policy.numaNode << ".";
+        result = APP_ERR_COMM_FAILURE;
+    }
+    if (policy.priority > 0) {
+        struct sched_param param = {};
+        param.sched_priority = policy.priority;
+        // needs CAP_SYS_NICE or an RLIMIT_RTPRIO large enough
+        int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (ret != 0) {
+            LogWarn << "Fail to set SCHED_FIFO priority " << policy.priority << " for " << threadName << ", err=" <<
+                ret << ".";
+            result = APP_ERR_COMM_FAILURE;
+        }
+    }
+    if (result == APP_ERR_OK && !IsDefaultThreadPolicy(policy)) {
+        LogDebug << threadName << " runs on " << policy.cpuSet.size() << " cpus, numaNode=" << policy.numaNode <<
+            ", priority=" << policy.priority << ".";
+    }
+    return result;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef THREAD_POLICY_H
+#define THREAD_POLICY_H
+
+#include <string>
+#include <vector>
+#include "ConfigParser/ConfigParser.h"
+#include "ErrorCode/ErrorCode.h"
+
+// placement and priority of a thread, the default one leaves the thread as the system created it
+struct ThreadPolicy {
+    std::vector<int> cpuSet = {}; // cpus the thread may run on, empty means any cpu
+    int numaNode = -1;            // memory preferred on this node, and its cpus when cpuSet is empty, -1 means none
+    int priority = 0;             // SCHED_FIFO priority from 1 to 99, 0 keeps SCHED_OTHER
+};
+
+// "0-7,16-23" into the list of cpus
+APP_ERROR ParseCpuSet(const std::string &text, std::vector<int> &cpuSet);
+// <prefix>.cpuSet, <prefix>.numaNode and <prefix>.threadPriority, a missing key keeps its default
+APP_ERROR LoadThreadPolicy(ConfigParser &configParser, const std::string &prefix, ThreadPolicy &policy);
+bool IsDefaultThreadPolicy(const ThreadPolicy &policy);
+// apply the policy to the calling thread, the thread keeps running where it is on failure
+APP_ERROR ApplyThreadPolicy(const ThreadPolicy &policy, const std::string &threadName);
+
+#endif
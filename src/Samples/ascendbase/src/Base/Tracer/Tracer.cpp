@@ -0,0 +1,240 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Tracer/Tracer.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "Log/Log.h"
+
+namespace {
+const int32_t NO_FRAME = -1;
+const double NS_PER_US = 1000.0;
+
+enum TracePhase {
+    TRACE_PHASE_COMPLETE = 0,
+    TRACE_PHASE_FLOW_START,
+    TRACE_PHASE_FLOW_END
+};
+
+struct TraceEvent {
+    int64_t beginNs;
+    int64_t durationNs;
+    uint64_t flowId;
+    int32_t instanceId;
+    int32_t channelId;
+    int32_t frameId;
+    uint16_t nameId;
+    uint8_t phase;
+};
+
+// written by its thread only, count is published after the event so that Dump reads whole events
+struct TraceBuffer {
+    uint32_t threadId = 0;
+    std::string threadName = "";
+    std::vector<TraceEvent> events = {};
+    std::atomic<uint64_t> count = {};
+};
+
+std::mutex g_traceMutex;
+std::vector<std::shared_ptr<TraceBuffer>> g_traceBuffers;
+std::vector<std::string> g_traceNames;
+uint32_t g_bufferSize = TRACE_BUFFER_SIZE;
+std::atomic<uint32_t> g_generation(0); // a new Start drops the buffers of the previous one
+std::chrono::steady_clock::time_point g_startTime;
+
+thread_local TraceBuffer *g_threadBuffer = nullptr;
+thread_local uint32_t g_threadGeneration = 0;
+thread_local int32_t g_channelId = NO_FRAME;
+thread_local int32_t g_frameId = NO_FRAME;
+
+int64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_startTime)
+        .count();
+}
+
+TraceBuffer *GetThreadBuffer()
+{
+    if (g_threadBuffer != nullptr && g_threadGeneration == g_generation.load(std::memory_order_acquire)) {
+        return g_threadBuffer;
+    }
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    std::shared_ptr<TraceBuffer> buffer = std::make_shared<TraceBuffer>();
+    buffer->threadId = g_traceBuffers.size() + 1;
+    buffer->events.resize(g_bufferSize);
+    g_traceBuffers.push_back(buffer);
+    g_threadBuffer = buffer.get();
+    g_threadGeneration = g_generation.load();
+    return g_threadBuffer;
+}
+
+void Record(const TraceEvent &event)
+{
+    TraceBuffer *buffer = GetThreadBuffer();
+    uint64_t count = buffer->count.load(std::memory_order_relaxed);
+    buffer->events[count % buffer->events.size()] = event;
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+std::string EscapeName(const std::string &name)
+{
+    std::string escaped;
+    for (char c : name) {
+        if (c == '"' || c == '\\') {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(c);
+    }
+    return escaped;
+}
+}
+
+std::atomic<bool> Tracer::isEnabled_(false);
+
+APP_ERROR Tracer::Start(uint32_t bufferSize)
+{
+    if (bufferSize == 0) {
+        LogError << "Tracer: invalid buffer size " << bufferSize << ".";
+        return APP_ERR_COMM_INVALID_PARAM;
+    }
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    g_traceBuffers.clear();
+    g_bufferSize = bufferSize;
+    g_generation++;
+    g_startTime = std::chrono::steady_clock::now();
+    isEnabled_.store(true, std::memory_order_release);
+    LogInfo << "Tracer: started, " << bufferSize << " events per thread.";
+    return APP_ERR_OK;
+}
+
+void Tracer::Stop()
+{
+    isEnabled_.store(false, std::memory_order_release);
+}
+
+uint16_t Tracer::RegisterName(const std::string &name)
+{
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    for (size_t i = 0; i < g_traceNames.size(); i++) {
+        if (g_traceNames[i] == name) {
+            return i;
+        }
+    }
+    g_traceNames.push_back(name);
+    return g_traceNames.size() - 1;
+}
+
+void Tracer::SetThreadName(const std::string &name)
+{
+    if (!IsEnabled()) {
+        return;
+    }
+    TraceBuffer *buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    buffer->threadName = name;
+}
+
+void Tracer::SetFrame(int32_t channelId, int32_t frameId)
+{
+    g_channelId = channelId;
+    g_frameId = frameId;
+}
+
+int64_t Tracer::Begin()
+{
+    g_channelId = NO_FRAME;
+    g_frameId = NO_FRAME;
+    return NowNs();
+}
+
+void Tracer::End(uint16_t nameId, int32_t instanceId, int64_t beginNs)
+{
+    TraceEvent event = {};
+    event.beginNs = beginNs;
+    event.durationNs = NowNs() - beginNs;
+    event.instanceId = instanceId;
+    event.channelId = g_channelId;
+    event.frameId = g_frameId;
+    event.nameId = nameId;
+    event.phase = TRACE_PHASE_COMPLETE;
+    Record(event);
+}
+
+void Tracer::FlowStart(const void *message)
+{
+    TraceEvent event = {};
+    event.beginNs = NowNs();
+    event.flowId = reinterpret_cast<uintptr_t>(message);
+    event.phase = TRACE_PHASE_FLOW_START;
+    Record(event);
+}
+
+void Tracer::FlowEnd(const void *message)
+{
+    TraceEvent event = {};
+    event.beginNs = NowNs();
+    event.flowId = reinterpret_cast<uintptr_t>(message);
+    event.phase = TRACE_PHASE_FLOW_END;
+    Record(event);
+}
+
+APP_ERROR Tracer::Dump(const std::string &fileName)
+{
+    FILE *file = fopen(fileName.c_str(), "w");
+    if (file == nullptr) {
+        LogError << "Tracer: fail to open " << fileName << ".";
+        return APP_ERR_COMM_OPEN_FAIL;
+    }
+    std::lock_guard<std::mutex> lock(g_traceMutex);
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    const char *separator = "";
+    uint64_t eventNum = 0;
+    for (auto &buffer : g_traceBuffers) {
+        std::string threadName = buffer->threadName.empty() ? "thread " + std::to_string(buffer->threadId) :
+            buffer->threadName;
+        fprintf(file, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+            separator, buffer->threadId, EscapeName(threadName).c_str());
+        separator = ",\n";
+
+        uint64_t count = buffer->count.load(std::memory_order_acquire);
+        uint64_t capacity = buffer->events.size();
+        for (uint64_t i = (count > capacity) ? count - capacity : 0; i < count; i++, eventNum++) {
+            const TraceEvent &event = buffer->events[i % capacity];
+            if (event.phase == TRACE_PHASE_COMPLETE) {
+                std::string name = (event.nameId < g_traceNames.size()) ? g_traceNames[event.nameId] : "Process";
+                fprintf(file, "%s{\"ph\":\"X\",\"cat\":\"process\",\"name\":\"%s\",\"pid\":1,\"tid\":%u,"
+                    "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"instanceId\":%d,\"channelId\":%d,\"frameId\":%d}}",
+                    separator, EscapeName(name).c_str(), buffer->threadId, event.beginNs / NS_PER_US,
+                    event.durationNs / NS_PER_US, event.instanceId, event.channelId, event.frameId);
+            } else {
+                // the flow end binds to the Process event beginning right after the pop
+                fprintf(file, "%s{\"ph\":\"%s\",\"cat\":\"queue\",\"name\":\"queue\",\"id\":%" PRIu64 ",\"pid\":1,"
+                    "\"tid\":%u,\"ts\":%.3f}", separator,
+                    (event.phase == TRACE_PHASE_FLOW_START) ? "s" : "f\",\"bp\":\"e", event.flowId,
+                    buffer->threadId, event.beginNs / NS_PER_US);
+            }
+        }
+    }
+    fprintf(file, "\n]}\n");
+    fclose(file);
+    LogInfo << "Tracer: " << eventNum << " events of " << g_traceBuffers.size() << " threads written to " <<
+        fileName << ".";
+    return APP_ERR_OK;
+}
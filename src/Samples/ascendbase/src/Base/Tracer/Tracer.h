@@ -0,0 +1,57 @@
+/*
+ * Copyright(C) 2020. Huawei Technologies Co.,Ltd. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "ErrorCode/ErrorCode.h"
+
+const uint32_t TRACE_BUFFER_SIZE = 16384; // events kept per thread, the oldest ones are overwritten
+
+// Timeline of the module instances in the Chrome trace format (chrome://tracing, ui.perfetto.dev): one complete
+// event per Process call, tagged with the frame set by the module, and one flow from every push to the Process
+// call of the receiver, the gap between them is the time spent in the queue. Every thread appends to its own
+// buffer without any lock; nothing is recorded and the calls return at once until Start is called.
+class Tracer {
+public:
+    // drop the events of the previous run, call it before the threads to trace are started
+    static APP_ERROR Start(uint32_t bufferSize = TRACE_BUFFER_SIZE);
+    static void Stop();
+    // write the events of all the threads, call it once the pipeline is stopped
+    static APP_ERROR Dump(const std::string &fileName);
+    static bool IsEnabled()
+    {
+        return isEnabled_.load(std::memory_order_acquire);
+    }
+
+    static uint16_t RegisterName(const std::string &name);
+    static void SetThreadName(const std::string &name);
+    // called by a module in Process, the frame is attached to the event of this Process call
+    static void SetFrame(int32_t channelId, int32_t frameId);
+    // return the begin timestamp to give to End
+    static int64_t Begin();
+    static void End(uint16_t nameId, int32_t instanceId, int64_t beginNs);
+    static void FlowStart(const void *message);
+    static void FlowEnd(const void *message);
+
+private:
+    static std::atomic<bool> isEnabled_;
+};
+
+#endif
@@ -11,6 +11,9 @@ SampleFolder=(
   DvppCrop
   InferObjectDetection
   InferOfflineVideo
+  FrameworkBench
+  LogDecode
+  StatCompare
 )
 
 #compile the sample